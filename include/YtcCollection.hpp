@@ -2,6 +2,9 @@
 
 #include "YtcMemory.hpp"
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
 namespace Ytc
 {
 
@@ -182,26 +185,65 @@ namespace Ytc
         /// <param name="item">new element</param>
         void Add(const T& item)
         {
-            Insert(count_, item);
+            EmplaceAt(count_, item);
         }
         /// <summary>
-        /// Insert an element into the list at the specified position which is zero-based.
+        /// Add an element to the end of the list, moving it in.
         /// </summary>
-        /// <param name="index">index/position</param>
-        /// <param name="item">new item</param>
-        void Insert(int index, const T& item)
+        /// <param name="item">new element</param>
+        void Add(T&& item)
+        {
+            EmplaceAt(count_, Move(item));
+        }
+        /// <summary>
+        /// Construct an element at the end of the list from the specified arguments.
+        /// </summary>
+        /// <returns>the new element</returns>
+        template<typename... Args>
+        T& Emplace(Args&&... args)
+        {
+            return EmplaceAt(count_, std::forward<Args>(args)...);
+        }
+        /// <summary>
+        /// Construct an element at the specified position from the specified arguments, the arguments may refer to
+        /// elements of the list.
+        /// </summary>
+        /// <param name="index">zero-based index</param>
+        /// <returns>the new element</returns>
+        template<typename... Args>
+        T& EmplaceAt(int index, Args&&... args)
         {
             uint32_t pos = index;
             if (pos > count_)
             {
                 throw Exception(L"Argument <index> is out of range!");
             }
+            if (pos == count_ && count_ < capacity_)
+            {
+                new (buffer_ + pos) T(std::forward<Args>(args)...);
+            }
             else
             {
-                T* ptr = Reserve(pos, 1);
-                new (ptr) T(item);
-                count_++;
+                // built before the elements move, which the arguments may refer to
+                T item(std::forward<Args>(args)...);
+                new (Reserve(pos, 1)) T(Move(item));
             }
+            count_++;
+            return buffer_[pos];
+        }
+        /// <summary>
+        /// Insert an element into the list at the specified position which is zero-based.
+        /// </summary>
+        /// <param name="index">index/position</param>
+        /// <param name="item">new item</param>
+        void Insert(int index, const T& item)
+        {
+            EmplaceAt(index, item);
+        }
+
+        void Insert(int index, T&& item)
+        {
+            EmplaceAt(index, Move(item));
         }
         /// <summary>
         /// Inserts the elements of a collection into the list at the specified index.
@@ -214,11 +256,16 @@ namespace Ytc
             uint32_t count = 0;
             while (enumerator->MoveNext()) ++count;
             uint32_t pos = index;
+            if (pos > count_)
+            {
+                throw Exception(L"Argument <index> is out of range!");
+            }
             T* ptr = Reserve(pos, count);
             for (enumerator->Reset(); enumerator->MoveNext();)
             {
                 new (ptr++) T(enumerator->Current());
             }
+            count_ += count;
         }
         /// <summary>
         /// Swap the internal data with the specified list.
@@ -250,18 +297,36 @@ namespace Ytc
             uint32_t pos = index;
             if (pos < count_)
             {
-                uint32_t newCount = count_ - 1;
-                for (; pos < newCount; ++pos)
-                {
-                    buffer_[pos] = Move(buffer_[pos + 1]);
-                }
-                count_ = newCount;
+                buffer_[pos].~T();
+                MoveElements(pos + 1, count_, pos);
+                --count_;
             }
             else
             {
                 throw Exception(L"Argument <index> is out of range!");
             }
         }
+        /// <summary>
+        /// Remove a range of elements of the list.
+        /// </summary>
+        /// <param name="index">zero-based index of the first element</param>
+        /// <param name="count">count of elements</param>
+        void RemoveRange(int index, int count)
+        {
+            uint32_t pos = index;
+            if (pos > count_)
+            {
+                throw Exception(L"Argument <index> is out of range!");
+            }
+            if (count < 0 || static_cast<uint32_t>(count) > count_ - pos)
+            {
+                throw Exception(L"Argument <count> is out of range!");
+            }
+            const uint32_t end = pos + count;
+            Discard(pos, end);
+            MoveElements(end, count_, pos);
+            count_ -= count;
+        }
 
         /// <summary>
         /// Removes all elements
@@ -319,73 +384,98 @@ namespace Ytc
     private:
         void Realloc(uint32_t size)
         {
-            ReallocImpl(size, std::is_trivially_copy_constructible<T>());
+            ReallocImpl(size, IsTriviallyRelocatable<T>());
             capacity_ = size;
         }
 
+        // make room for count elements at pos, the elements after it are moved up and the room is left uninitialized
         T* Reserve(uint32_t pos, uint32_t count)
         {
             uint32_t newCount = count_ + count;
             if (newCount > capacity_)
             {
                 newCount += newCount >> 1;
-                if (pos < count_)
+                if (pos < count_ && !IsTriviallyRelocatable<T>::value)
                 {
                     T* newBuffer = static_cast<T*>(malloc(sizeof(T) * newCount));
-                    std::uninitialized_copy(buffer_, buffer_ + pos, newBuffer);
-                    std::uninitialized_copy(buffer_ + pos, buffer_ + count_, newBuffer + pos + count);
-                    Discard(0, count_);
+                    Relocate(buffer_, pos, newBuffer);
+                    Relocate(buffer_ + pos, count_ - pos, newBuffer + pos + count);
                     free(buffer_);
                     buffer_ = newBuffer;
-                }
-                else
-                {
-                    Realloc(newCount);
-                }
-                capacity_ = newCount;
-            }
-            else
-            {
-                uint32_t newStartOfTheSecondPart = pos + count;
-                int diff = count_ - newStartOfTheSecondPart;
-                if (diff <= 0) 
-                {
-                    std::uninitialized_copy(buffer_ + pos, buffer_ + count_, buffer_ + newStartOfTheSecondPart);
+                    capacity_ = newCount;
                     return buffer_ + pos;
                 }
-                else
-                {
-                    uint32_t src = count_ - 1;
-                    for (uint32_t dest = src + count; dest > count_ - 1; --src, dest = src + count)
-                    {
-                        new (&buffer_[dest]) T(buffer_[src]);
-                    }
-                    for (; src >= pos; --src)
-                    {
-                        buffer_[src + count] = Move(buffer_[src]);
-                    }
-                }
-                for (uint32_t i = 0; i < count; ++i)
-                {
-                    buffer_[pos + i].~T();
-                }
+                Realloc(newCount);
             }
+            MoveElements(pos, count_, pos + count);
             return buffer_ + pos;
         }
 
         void ReallocImpl(size_t size, std::true_type)
         {
-            buffer_ = static_cast<T*>(realloc(buffer_, size * sizeof(T)));
+            buffer_ = static_cast<T*>(realloc(static_cast<void*>(buffer_), size * sizeof(T)));
         }
 
         void ReallocImpl(size_t size, std::false_type)
         {
             T* newBuffer = static_cast<T*>(malloc(sizeof(T) * size));
-            std::uninitialized_copy(buffer_, buffer_ + count_, newBuffer);
-            Discard(0, count_);
+            Relocate(buffer_, count_, newBuffer);
             free(buffer_);
             buffer_ = newBuffer;
         }
+        // move elements into uninitialized memory, the memory they leave is uninitialized
+        static void Relocate(T* source, uint32_t count, T* dest)
+        {
+            RelocateImpl(source, count, dest, IsTriviallyRelocatable<T>());
+        }
+
+        static void RelocateImpl(T* source, uint32_t count, T* dest, std::true_type)
+        {
+            if (count) memcpy(static_cast<void*>(dest), static_cast<const void*>(source), sizeof(T) * count);
+        }
+
+        static void RelocateImpl(T* source, uint32_t count, T* dest, std::false_type)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                new (&dest[i]) T(Move(source[i]));
+                source[i].~T();
+            }
+        }
+        // move the elements in [first, last) to dest, into room which is uninitialized or left by them
+        void MoveElements(uint32_t first, uint32_t last, uint32_t dest)
+        {
+            MoveElementsImpl(first, last, dest, IsTriviallyRelocatable<T>());
+        }
+
+        void MoveElementsImpl(uint32_t first, uint32_t last, uint32_t dest, std::true_type)
+        {
+            if (first != last && first != dest)
+            {
+                memmove(static_cast<void*>(buffer_ + dest), static_cast<const void*>(buffer_ + first), sizeof(T) * (last - first));
+            }
+        }
+
+        void MoveElementsImpl(uint32_t first, uint32_t last, uint32_t dest, std::false_type)
+        {
+            if (dest > first)
+            {
+                // from the last one, so each element moves into room which is free already
+                for (uint32_t i = last; i > first; --i)
+                {
+                    new (&buffer_[i - 1 - first + dest]) T(Move(buffer_[i - 1]));
+                    buffer_[i - 1].~T();
+                }
+            }
+            else if (dest < first)
+            {
+                for (uint32_t i = first; i < last; ++i)
+                {
+                    new (&buffer_[i - first + dest]) T(Move(buffer_[i]));
+                    buffer_[i].~T();
+                }
+            }
+        }
         
         void Discard(uint32_t start, uint32_t count)
         {
@@ -0,0 +1,438 @@
+#pragma once
+
+#include "YtcString.hpp"
+#include "YtcStringBuilder.hpp"
+
+#include <type_traits>
+#include <utility>
+
+/// <summary>
+/// Turns a string literal into a pattern for Ytc::Format, as a type whose text is known at compile time:
+/// Format(YTC_PATTERN(L"{} of {:>8}"), count, name).
+/// </summary>
+#define YTC_PATTERN(literal) \
+    [] \
+    { \
+        struct YtcPattern \
+        { \
+            using CharType = std::remove_const<std::remove_reference<decltype((literal)[0])>::type>::type; \
+            static constexpr const CharType* Text() { return literal; } \
+        }; \
+        return YtcPattern(); \
+    }()
+
+namespace Ytc
+{
+    /// <summary>
+    /// The literal run of a pattern and the placeholder which follows it, parsed at compile time by FormatScan.
+    /// A placeholder is {} or {:[[fill]align][width][.precision]}, align being '<', '>' or '^'; {{ and }} stand for braces.
+    /// </summary>
+    template<typename C>
+    struct FormatPiece
+    {
+        uint32_t literalOffset;
+        // characters of the pattern, and characters they write once {{ and }} are unescaped
+        uint32_t literalLength;
+        uint32_t outputLength;
+        bool escaped;
+        // false for the literal which ends the pattern
+        bool placeholder;
+        bool valid;
+        C fill;
+        // 0 stands for the default of the argument: right for numbers, left otherwise
+        char align;
+        uint32_t width;
+        // -1 if there is none
+        int precision;
+        uint32_t next;
+
+        constexpr FormatPiece() noexcept
+            : literalOffset(0), literalLength(0), outputLength(0), escaped(false), placeholder(false), valid(true),
+            fill(C(' ')), align(0), width(0), precision(-1), next(0)
+        {
+        }
+    };
+
+    constexpr uint32_t MaxFormatWidth = 1 << 16;
+
+    template<typename C>
+    constexpr bool IsFormatAlign(C c) noexcept
+    {
+        return c == C('<') || c == C('>') || c == C('^');
+    }
+
+    template<typename C>
+    constexpr bool IsFormatDigit(C c) noexcept
+    {
+        return c >= C('0') && c <= C('9');
+    }
+    /// <summary>
+    /// Parse the piece of a pattern starting at offset.
+    /// </summary>
+    template<typename C>
+    constexpr FormatPiece<C> FormatScan(const C* text, uint32_t offset) noexcept
+    {
+        FormatPiece<C> piece;
+        piece.literalOffset = offset;
+        uint32_t i = offset;
+        for (;;)
+        {
+            const C c = text[i];
+            if (c == C(0))
+            {
+                piece.literalLength = i - offset;
+                piece.next = i;
+                return piece;
+            }
+            if ((c == C('{') || c == C('}')) && text[i + 1] == c)
+            {
+                i += 2;
+                ++piece.outputLength;
+                piece.escaped = true;
+                continue;
+            }
+            if (c == C('}'))
+            {
+                piece.valid = false;
+                return piece;
+            }
+            if (c == C('{')) break;
+            ++i;
+            ++piece.outputLength;
+        }
+        piece.literalLength = i - offset;
+        piece.placeholder = true;
+        ++i;
+        if (text[i] == C(':'))
+        {
+            ++i;
+            if (text[i] != C(0) && text[i] != C('{') && text[i] != C('}') && IsFormatAlign(text[i + 1]))
+            {
+                piece.fill = text[i];
+                piece.align = static_cast<char>(text[i + 1]);
+                i += 2;
+            }
+            else if (IsFormatAlign(text[i]))
+            {
+                piece.align = static_cast<char>(text[i]);
+                ++i;
+            }
+            for (; IsFormatDigit(text[i]) && piece.width <= MaxFormatWidth; ++i)
+            {
+                piece.width = piece.width * 10 + static_cast<uint32_t>(text[i] - C('0'));
+            }
+            if (text[i] == C('.'))
+            {
+                ++i;
+                if (!IsFormatDigit(text[i])) piece.valid = false;
+                piece.precision = 0;
+                for (; IsFormatDigit(text[i]) && piece.precision <= static_cast<int>(MaxFormatWidth); ++i)
+                {
+                    piece.precision = piece.precision * 10 + static_cast<int>(text[i] - C('0'));
+                }
+            }
+        }
+        if (text[i] != C('}') || piece.width > MaxFormatWidth || piece.precision > static_cast<int>(MaxFormatWidth)) piece.valid = false;
+        piece.next = i + 1;
+        return piece;
+    }
+    /// <summary>
+    /// Count the placeholders of a pattern.
+    /// </summary>
+    /// <returns>-1 if the pattern is malformed</returns>
+    template<typename C>
+    constexpr int FormatCount(const C* text) noexcept
+    {
+        int count = 0;
+        uint32_t offset = 0;
+        for (;;)
+        {
+            const FormatPiece<C> piece = FormatScan(text, offset);
+            if (!piece.valid) return -1;
+            if (!piece.placeholder) return count;
+            ++count;
+            offset = piece.next;
+        }
+    }
+
+    template<typename C>
+    constexpr FormatPiece<C> FormatPieceAt(const C* text, uint32_t index) noexcept
+    {
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < index; ++i) offset = FormatScan(text, offset).next;
+        return FormatScan(text, offset);
+    }
+
+    template<typename C>
+    constexpr bool FormatPrecisionsFit(const FormatPiece<C>* pieces, const int* maxPrecisions, uint32_t count) noexcept
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (pieces[i].precision > maxPrecisions[i]) return false;
+        }
+        return true;
+    }
+    /// <summary>
+    /// How an argument of Format is measured then written, it is specialized for each supported type.
+    /// MaxPrecision is -1 for arguments which take no precision.
+    /// </summary>
+    template<typename C, typename Arg, typename Enable = void>
+    struct FormatArgument
+    {
+        static_assert(sizeof(Arg) == 0, "The type of this argument cannot be formatted");
+    };
+    /// <summary>
+    /// Characters referred to and not copied, a precision keeps at most that many of them.
+    /// </summary>
+    template<typename C>
+    struct FormatText
+    {
+        static constexpr bool Numeric = false;
+        static constexpr int MaxPrecision = static_cast<int>(MaxFormatWidth);
+
+        FormatText(const C* buffer, uint32_t length, const FormatPiece<C>& piece) noexcept
+            : buffer_(buffer), length_(piece.precision >= 0 && static_cast<uint32_t>(piece.precision) < length ? piece.precision : length)
+        {
+        }
+
+        uint32_t Length() const noexcept
+        {
+            return length_;
+        }
+
+        C* Write(C* dest) const noexcept
+        {
+            std::memcpy(dest, buffer_, length_ * sizeof(C));
+            return dest + length_;
+        }
+
+    private:
+        const C* buffer_;
+        uint32_t length_;
+    };
+
+    template<typename C, typename RefCountPolicy>
+    struct FormatArgument<C, String<C, RefCountPolicy>> : FormatText<C>
+    {
+        FormatArgument(const String<C, RefCountPolicy>& value, const FormatPiece<C>& piece) noexcept
+            : FormatText<C>(value.Buffer(), value.Length(), piece)
+        {
+        }
+    };
+
+    template<typename C>
+    struct FormatArgument<C, StringView<C>> : FormatText<C>
+    {
+        FormatArgument(StringView<C> value, const FormatPiece<C>& piece) noexcept : FormatText<C>(value.Buffer(), value.Length(), piece)
+        {
+        }
+    };
+    // string literals decay to pointers, a null pointer writes nothing
+    template<typename C>
+    struct FormatArgument<C, const C*> : FormatText<C>
+    {
+        FormatArgument(const C* value, const FormatPiece<C>& piece) noexcept
+            : FormatText<C>(value ? value : StringView<C>().Buffer(), value ? String<C>::CountChar(value) : 0, piece)
+        {
+        }
+    };
+
+    template<typename C>
+    struct FormatArgument<C, C*> : FormatArgument<C, const C*>
+    {
+        using FormatArgument<C, const C*>::FormatArgument;
+    };
+
+    template<typename C>
+    struct FormatArgument<C, C>
+    {
+        static constexpr bool Numeric = false;
+        static constexpr int MaxPrecision = -1;
+
+        FormatArgument(C value, const FormatPiece<C>&) noexcept : value_(value)
+        {
+        }
+
+        uint32_t Length() const noexcept
+        {
+            return 1;
+        }
+
+        C* Write(C* dest) const noexcept
+        {
+            *dest = value_;
+            return dest + 1;
+        }
+
+    private:
+        C value_;
+    };
+    /// <summary>
+    /// ASCII text formatted into a small buffer, widened when it is written.
+    /// </summary>
+    template<typename C, uint32_t Capacity>
+    struct FormatDigits
+    {
+        static constexpr bool Numeric = true;
+
+        uint32_t Length() const noexcept
+        {
+            return length_;
+        }
+
+        C* Write(C* dest) const noexcept
+        {
+            for (uint32_t i = 0; i < length_; ++i) dest[i] = C(digits_[i]);
+            return dest + length_;
+        }
+
+    protected:
+        char digits_[Capacity];
+        uint32_t length_;
+    };
+
+    template<typename C>
+    struct FormatArgument<C, bool> : FormatDigits<C, 5>
+    {
+        static constexpr bool Numeric = false;
+        static constexpr int MaxPrecision = -1;
+
+        FormatArgument(bool value, const FormatPiece<C>&) noexcept
+        {
+            this->length_ = value ? 4 : 5;
+            std::memcpy(this->digits_, value ? "true" : "false", this->length_);
+        }
+    };
+
+    template<typename C, typename Integer>
+    struct FormatArgument<C, Integer, typename std::enable_if<std::is_integral<Integer>::value
+        && !std::is_same<Integer, bool>::value && !std::is_same<Integer, C>::value>::type> : FormatDigits<C, Number::MaxIntegerLength>
+    {
+        static constexpr int MaxPrecision = -1;
+
+        FormatArgument(Integer value, const FormatPiece<C>&) noexcept
+        {
+            this->length_ = std::is_signed<Integer>::value ? Number::FormatSigned(static_cast<int64_t>(value), this->digits_)
+                : Number::FormatUnsigned(static_cast<uint64_t>(value), this->digits_);
+        }
+    };
+    // without a precision the digits of String::From which read back as the same value, with one the fixed-point notation
+    template<typename C, typename Real>
+    struct FormatArgument<C, Real, typename std::enable_if<std::is_floating_point<Real>::value>::type>
+        : FormatDigits<C, 320 + StringBuilder<C>::MaxPrecision>
+    {
+        static constexpr int MaxPrecision = static_cast<int>(StringBuilder<C>::MaxPrecision);
+
+        FormatArgument(Real value, const FormatPiece<C>& piece) noexcept
+        {
+            if (piece.precision < 0)
+            {
+                this->length_ = Number::FormatDouble(static_cast<double>(value), this->digits_);
+            }
+            else
+            {
+                this->length_ = Number::FormatFixed(static_cast<double>(value), piece.precision, this->digits_, sizeof(this->digits_));
+            }
+        }
+    };
+    template<typename C>
+    inline C* WriteFormatLiteral(const C* text, const FormatPiece<C>& piece, C* dest) noexcept
+    {
+        const C* p = text + piece.literalOffset;
+        if (!piece.escaped)
+        {
+            std::memcpy(dest, p, piece.literalLength * sizeof(C));
+            return dest + piece.literalLength;
+        }
+        // braces in a valid literal always come in pairs
+        for (const C* end = p + piece.literalLength; p != end; ++p)
+        {
+            *dest++ = *p;
+            if (*p == C('{') || *p == C('}')) ++p;
+        }
+        return dest;
+    }
+
+    /// <summary>
+    /// The prepared arguments of one Format call, kept in place so that strings are not copied and numbers are formatted once.
+    /// </summary>
+    template<typename C, typename... Args>
+    struct FormatArguments
+    {
+        explicit FormatArguments(const FormatPiece<C>*) noexcept
+        {
+        }
+
+        uint64_t Length(const FormatPiece<C>* pieces) const noexcept
+        {
+            return pieces[0].outputLength;
+        }
+
+        C* Write(const C* text, const FormatPiece<C>* pieces, C* dest) const noexcept
+        {
+            return WriteFormatLiteral(text, pieces[0], dest);
+        }
+    };
+
+    template<typename C, typename First, typename... Rest>
+    struct FormatArguments<C, First, Rest...>
+    {
+        FormatArguments(const FormatPiece<C>* pieces, const First& first, const Rest&... rest)
+            : head(first, pieces[0]), tail(pieces + 1, rest...)
+        {
+        }
+
+        uint64_t Length(const FormatPiece<C>* pieces) const noexcept
+        {
+            const uint32_t length = head.Length();
+            return pieces[0].outputLength + (length > pieces[0].width ? length : pieces[0].width) + tail.Length(pieces + 1);
+        }
+
+        C* Write(const C* text, const FormatPiece<C>* pieces, C* dest) const noexcept
+        {
+            const FormatPiece<C>& piece = pieces[0];
+            dest = WriteFormatLiteral(text, piece, dest);
+            const uint32_t length = head.Length();
+            const uint32_t padding = piece.width > length ? piece.width - length : 0;
+            const char align = piece.align ? piece.align : FormatArgument<C, First>::Numeric ? '>' : '<';
+            const uint32_t before = align == '>' ? padding : align == '^' ? padding / 2 : 0;
+            for (uint32_t i = 0; i < before; ++i) *dest++ = piece.fill;
+            dest = head.Write(dest);
+            for (uint32_t i = before; i < padding; ++i) *dest++ = piece.fill;
+            return tail.Write(text, pieces + 1, dest);
+        }
+
+        FormatArgument<C, First> head;
+        FormatArguments<C, Rest...> tail;
+    };
+
+    template<typename Pattern, typename... Args, size_t... I>
+    String<typename Pattern::CharType> FormatWith(std::index_sequence<I...>, const Args&... args)
+    {
+        using C = typename Pattern::CharType;
+        static constexpr FormatPiece<C> pieces[] = { FormatPieceAt(Pattern::Text(), I)..., FormatPieceAt(Pattern::Text(), sizeof...(I)) };
+        static constexpr int maxPrecisions[] = { FormatArgument<C, Args>::MaxPrecision..., 0 };
+        static_assert(FormatPrecisionsFit(pieces, maxPrecisions, sizeof...(I)), "A precision is given to an argument which takes none or is too large");
+
+        const FormatArguments<C, Args...> arguments(pieces, args...);
+        const uint64_t length = arguments.Length(pieces);
+        if (length >= String<C>::MaxSize) throw Exception(L"The formatted string is too long!");
+        StringBuilder<C> builder(static_cast<uint32_t>(length));
+        arguments.Write(Pattern::Text(), pieces, builder.AppendUninitialized(static_cast<uint32_t>(length)));
+        return builder.ToString();
+    }
+    /// <summary>
+    /// Format arguments into a new string following a pattern made by YTC_PATTERN. The pattern is split and checked against
+    /// the count of arguments at compile time; then the arguments are measured, one buffer of the total length is allocated,
+    /// and everything is written into it. String and StringView arguments are not copied before that final write.
+    /// Arguments may be strings, characters of the pattern's type, bool, integers and floating-point numbers.
+    /// </summary>
+    /// <returns>a new string instance</returns>
+    template<typename Pattern, typename... Args>
+    String<typename Pattern::CharType> Format(Pattern, const Args&... args)
+    {
+        static_assert(FormatCount(Pattern::Text()) >= 0, "The pattern is malformed");
+        static_assert(FormatCount(Pattern::Text()) == sizeof...(Args), "The pattern does not have one placeholder per argument");
+        return FormatWith<Pattern, typename std::decay<const Args>::type...>(std::index_sequence_for<Args...>(), args...);
+    }
+}
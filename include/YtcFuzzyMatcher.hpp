@@ -0,0 +1,141 @@
+#pragma once
+
+#include "YtcString.hpp"
+#include "YtcCollection.hpp"
+#include "YtcLevenshtein.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <thread>
+
+namespace Ytc
+{
+    /// <summary>
+    /// Scores one query against many candidates by Levenshtein distance, for suggestions and typo tolerant lookups.
+    /// The bit masks of the query are built once and shared by every candidate, and a long list of candidates is
+    /// split into ranges scored on several threads.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class FuzzyMatcher
+    {
+    public:
+        static constexpr uint32_t MaxSize = String<T>::MaxSize;
+
+        struct Match
+        {
+            uint32_t index;
+            uint32_t distance;
+        };
+
+        explicit FuzzyMatcher(StringView<T> query) : masks_(query.Buffer(), query.Length())
+        {
+        }
+
+        FuzzyMatcher(const FuzzyMatcher&) = delete;
+        FuzzyMatcher& operator=(const FuzzyMatcher&) = delete;
+        /// <summary>
+        /// The distance of the query to a candidate, see String::EditDistance.
+        /// </summary>
+        /// <returns>the distance, or maxDistance + 1 if it is larger than maxDistance</returns>
+        uint32_t Distance(StringView<T> candidate, uint32_t maxDistance = MaxSize) const
+        {
+            return Levenshtein::Distance(masks_, candidate.Buffer(), candidate.Length(), maxDistance);
+        }
+        /// <summary>
+        /// The distances of the query to all candidates.
+        /// </summary>
+        /// <param name="candidates">the strings to score</param>
+        /// <param name="maxDistance">the largest distance of interest, a larger one is reported as maxDistance + 1</param>
+        /// <param name="threadCount">the count of threads, 0 for one for each processor</param>
+        /// <returns>the distance of each candidate at its index</returns>
+        List<uint32_t> Distances(const List<String<T>>& candidates, uint32_t maxDistance = MaxSize, uint32_t threadCount = 0) const
+        {
+            List<uint32_t> distances;
+            const uint32_t count = candidates.Count();
+            for (uint32_t i = 0; i < count; ++i) distances.Add(0);
+            if (!count) return distances;
+            ForEachRange(count, threadCount, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i) distances[i] = Distance(candidates[i], maxDistance);
+            });
+            return distances;
+        }
+        /// <summary>
+        /// The candidates within a distance of the query, closest first and in the order of the list among equals.
+        /// </summary>
+        /// <param name="candidates">the strings to score</param>
+        /// <param name="maxDistance">the largest distance of a match</param>
+        /// <param name="threadCount">the count of threads, 0 for one for each processor</param>
+        List<Match> FindWithin(const List<String<T>>& candidates, uint32_t maxDistance, uint32_t threadCount = 0) const
+        {
+            const List<uint32_t> distances = Distances(candidates, maxDistance, threadCount);
+            List<Match> matches;
+            for (uint32_t i = 0; i < distances.Count(); ++i)
+            {
+                if (distances[i] <= maxDistance) matches.Add(Match{ i, distances[i] });
+            }
+            if (matches.Count() > 1)
+            {
+                std::sort(&matches[0], &matches[0] + matches.Count(), [](const Match& a, const Match& b)
+                {
+                    return a.distance != b.distance ? a.distance < b.distance : a.index < b.index;
+                });
+            }
+            return matches;
+        }
+
+    private:
+        // starting a thread costs about as much as scoring this many short candidates
+        static constexpr uint32_t MinCandidatesPerThread = 1024;
+
+        template<typename Action>
+        static void ForEachRange(uint32_t count, uint32_t threadCount, const Action& action)
+        {
+            if (!threadCount) threadCount = std::max(1u, std::thread::hardware_concurrency());
+            threadCount = std::min(threadCount, std::max(1u, count / MinCandidatesPerThread));
+            if (threadCount == 1)
+            {
+                action(0, count);
+                return;
+            }
+            // the calling thread scores the last range
+            std::unique_ptr<std::thread[]> threads(new std::thread[threadCount - 1]);
+            std::unique_ptr<std::exception_ptr[]> errors(new std::exception_ptr[threadCount]);
+            const uint32_t rangeSize = count / threadCount;
+            uint32_t started = 0;
+            try
+            {
+                for (; started + 1 < threadCount; ++started)
+                {
+                    const uint32_t begin = started * rangeSize;
+                    std::exception_ptr& error = errors[started];
+                    threads[started] = std::thread([&action, &error, begin, rangeSize]()
+                    {
+                        try
+                        {
+                            action(begin, begin + rangeSize);
+                        }
+                        catch (...)
+                        {
+                            error = std::current_exception();
+                        }
+                    });
+                }
+                action(started * rangeSize, count);
+            }
+            catch (...)
+            {
+                errors[threadCount - 1] = std::current_exception();
+            }
+            for (uint32_t i = 0; i < started; ++i) threads[i].join();
+            for (uint32_t i = 0; i < threadCount; ++i)
+            {
+                if (errors[i]) std::rethrow_exception(errors[i]);
+            }
+        }
+
+        Levenshtein::PatternMasks<T> masks_;
+    };
+}
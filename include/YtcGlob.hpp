@@ -0,0 +1,533 @@
+#pragma once
+
+#include "YtcString.hpp"
+#include "YtcCollection.hpp"
+#include "YtcMultiPatternMatcher.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace Ytc
+{
+    /// <summary>
+    /// A wildcard pattern compiled once and matched against any number of strings without allocating.
+    /// '*' matches any run of characters, '?' any single character, "[a-z_]" one character of a class ("[!...]" or
+    /// "[^...]" for the complement) and '\' takes the next character literally.
+    /// The stars cut the pattern into segments of fixed length: the first and the last are compared at both ends of the
+    /// string, which rejects most strings at once, and each one in between is found at its leftmost place after the
+    /// previous one through a StringSearcher on its longest literal run. When the hits of that run keep failing to match
+    /// the whole segment, or it has no literal, the rest is scanned bit-parallel (Shift-And), one step per character.
+    /// Taking the leftmost place is always right for a star, so nothing is retried and the time is linear in the length of
+    /// the string for segments of up to MaxScannedLength characters; longer ones which are not all literal may take the
+    /// length of the string times their own.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class GlobPattern
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = String<T>::InvalidIndex;
+        static constexpr uint32_t MaxScannedLength = 256;
+        /// <summary>
+        /// Compile a pattern, an unterminated class or a trailing '\' throws.
+        /// </summary>
+        explicit GlobPattern(StringView<T> pattern) : pattern_(pattern.ToString()), minLength_(0), hasStar_(false)
+        {
+            Compile();
+        }
+
+        const String<T>& Pattern() const noexcept
+        {
+            return pattern_;
+        }
+        /// <summary>
+        /// The count of characters a match has at least.
+        /// </summary>
+        uint32_t MinLength() const noexcept
+        {
+            return minLength_;
+        }
+        /// <summary>
+        /// The longest run of literal characters which every match contains, empty if there is none.
+        /// </summary>
+        StringView<T> RequiredLiteral() const noexcept
+        {
+            uint32_t best = InvalidIndex;
+            for (uint32_t i = 0; i < searchers_.Count(); ++i)
+            {
+                if (best == InvalidIndex || searchers_[i].Needle().Length() > searchers_[best].Needle().Length()) best = i;
+            }
+            return best == InvalidIndex ? StringView<T>() : StringView<T>(searchers_[best].Needle());
+        }
+
+        bool IsMatch(StringView<T> value) const noexcept
+        {
+            const T* buffer = value.Buffer();
+            const uint32_t length = value.Length();
+            if (length < minLength_) return false;
+            const Segment& prefix = segments_[0];
+            if (!hasStar_) return length == minLength_ && MatchAt(prefix, buffer);
+            const Segment& suffix = segments_[segments_.Count() - 1];
+            if (!MatchAt(prefix, buffer) || !MatchAt(suffix, buffer + length - suffix.length)) return false;
+            uint32_t start = prefix.length;
+            const uint32_t end = length - suffix.length;
+            for (uint32_t i = 1; i + 1 < segments_.Count(); ++i)
+            {
+                const uint32_t index = Find(segments_[i], buffer, start, end);
+                if (index == InvalidIndex) return false;
+                start = index + segments_[i].length;
+            }
+            return true;
+        }
+
+    private:
+        using Unit = Simd::Unit<T>;
+        static constexpr uint32_t ByteUnits = 256;
+        static constexpr uint32_t MaxScanWords = MaxScannedLength / 64;
+
+        enum class AtomKind : uint8_t
+        {
+            Literal,
+            Any,
+            Class,
+        };
+
+        struct Atom
+        {
+            AtomKind kind;
+            bool negated;
+            T c;
+            uint32_t firstRange;
+            uint32_t rangeCount;
+        };
+
+        struct Range
+        {
+            Unit first;
+            Unit last;
+        };
+
+        struct Segment
+        {
+            uint32_t firstAtom;
+            uint32_t length;
+            // the longest literal run, found by searchers_[searcher]
+            uint32_t literalOffset;
+            uint32_t searcher;
+            // the Shift-And tables of a segment in between which is not all literal
+            uint32_t scanner;
+            bool literal;
+        };
+        /// <summary>
+        /// Bit j of the mask of a character is set when atom j of the segment accepts it. The units below 256 have a mask
+        /// each; the others fall into intervals, starting at the boundaries, on which every atom answers alike.
+        /// </summary>
+        struct Scanner
+        {
+            uint32_t words;
+            uint32_t firstMask;
+            uint32_t firstBoundary;
+            uint32_t boundaryCount;
+        };
+
+        void Compile()
+        {
+            const T* p = pattern_.Buffer();
+            const uint32_t length = pattern_.Length();
+            segments_.Add(Segment{ 0, 0, 0, InvalidIndex, InvalidIndex, true });
+            for (uint32_t i = 0; i < length;)
+            {
+                const T c = p[i++];
+                if (c == T('*'))
+                {
+                    // a run of stars is one star
+                    if (!hasStar_ || segments_[segments_.Count() - 1].length)
+                    {
+                        EndSegment();
+                        segments_.Add(Segment{ atoms_.Count(), 0, 0, InvalidIndex, InvalidIndex, true });
+                    }
+                    hasStar_ = true;
+                    continue;
+                }
+                Atom atom = { AtomKind::Literal, false, c, 0, 0 };
+                if (c == T('?'))
+                {
+                    atom.kind = AtomKind::Any;
+                }
+                else if (c == T('['))
+                {
+                    i = CompileClass(p, length, i, atom);
+                }
+                else if (c == T('\\'))
+                {
+                    if (i == length) throw Exception(L"The pattern ends with an escape!");
+                    atom.c = p[i++];
+                }
+                atoms_.Add(atom);
+                ++segments_[segments_.Count() - 1].length;
+                ++minLength_;
+            }
+            // the suffix, which is empty if the pattern ends with a star
+            EndSegment();
+            for (uint32_t i = 1; i + 1 < segments_.Count(); ++i)
+            {
+                if (!segments_[i].literal && segments_[i].length <= MaxScannedLength) BuildScanner(segments_[i]);
+            }
+        }
+
+        uint32_t CompileClass(const T* p, uint32_t length, uint32_t i, Atom& atom)
+        {
+            atom.kind = AtomKind::Class;
+            atom.firstRange = ranges_.Count();
+            if (i < length && (p[i] == T('!') || p[i] == T('^')))
+            {
+                atom.negated = true;
+                ++i;
+            }
+            // a ']' right after the '[' is a member
+            for (bool first = true; ; first = false)
+            {
+                if (i == length) throw Exception(L"The character class is not terminated!");
+                if (p[i] == T(']') && !first) return i + 1;
+                if (p[i] == T('\\') && ++i == length) throw Exception(L"The character class is not terminated!");
+                Range range = { static_cast<Unit>(p[i]), static_cast<Unit>(p[i]) };
+                ++i;
+                if (i + 1 < length && p[i] == T('-') && p[i + 1] != T(']'))
+                {
+                    if (p[i + 1] == T('\\') && i + 2 < length) ++i;
+                    range.last = static_cast<Unit>(p[i + 1]);
+                    i += 2;
+                    if (range.last < range.first) std::swap(range.first, range.last);
+                }
+                ranges_.Add(range);
+                ++atom.rangeCount;
+            }
+        }
+
+        void EndSegment()
+        {
+            Segment& segment = segments_[segments_.Count() - 1];
+            // find the longest run of literals to search for
+            uint32_t bestOffset = 0, bestLength = 0;
+            for (uint32_t i = 0; i < segment.length;)
+            {
+                if (atoms_[segment.firstAtom + i].kind != AtomKind::Literal)
+                {
+                    segment.literal = false;
+                    ++i;
+                    continue;
+                }
+                uint32_t run = 1;
+                while (i + run < segment.length && atoms_[segment.firstAtom + i + run].kind == AtomKind::Literal) ++run;
+                if (run > bestLength)
+                {
+                    bestOffset = i;
+                    bestLength = run;
+                }
+                i += run;
+            }
+            if (bestLength)
+            {
+                String<T> literal;
+                for (uint32_t i = 0; i < bestLength; ++i) literal += atoms_[segment.firstAtom + bestOffset + i].c;
+                segment.literalOffset = bestOffset;
+                segment.searcher = searchers_.Count();
+                searchers_.Add(StringSearcher<T>(literal));
+            }
+        }
+
+        void BuildScanner(Segment& segment)
+        {
+            const Scanner scanner = { (segment.length + 63) / 64, masks_.Count(), boundaries_.Count(), 0 };
+            for (uint32_t unit = 0; unit < ByteUnits; ++unit) AddMasks(segment, static_cast<Unit>(unit));
+            // every atom answers alike from one boundary up to the next
+            const uint64_t maxUnit = static_cast<Unit>(-1);
+            List<uint64_t> points;
+            points.Add(ByteUnits);
+            for (uint32_t i = 0; i < segment.length; ++i)
+            {
+                const Atom& atom = atoms_[segment.firstAtom + i];
+                if (atom.kind == AtomKind::Literal)
+                {
+                    points.Add(static_cast<Unit>(atom.c));
+                    points.Add(static_cast<uint64_t>(static_cast<Unit>(atom.c)) + 1);
+                }
+                for (uint32_t r = 0; atom.kind == AtomKind::Class && r < atom.rangeCount; ++r)
+                {
+                    points.Add(ranges_[atom.firstRange + r].first);
+                    points.Add(static_cast<uint64_t>(ranges_[atom.firstRange + r].last) + 1);
+                }
+            }
+            uint64_t* first = &points[0];
+            std::sort(first, first + points.Count());
+            const uint32_t count = static_cast<uint32_t>(std::unique(first, first + points.Count()) - first);
+            segment.scanner = scanners_.Count();
+            scanners_.Add(scanner);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (points[i] < ByteUnits || points[i] > maxUnit) continue;
+                boundaries_.Add(static_cast<Unit>(points[i]));
+                AddMasks(segment, static_cast<Unit>(points[i]));
+                ++scanners_[segment.scanner].boundaryCount;
+            }
+        }
+
+        void AddMasks(const Segment& segment, Unit unit)
+        {
+            for (uint32_t word = 0; word * 64 < segment.length; ++word)
+            {
+                uint64_t mask = 0;
+                for (uint32_t bit = 0; bit < 64 && word * 64 + bit < segment.length; ++bit)
+                {
+                    if (MatchAtom(atoms_[segment.firstAtom + word * 64 + bit], unit)) mask |= uint64_t(1) << bit;
+                }
+                masks_.Add(mask);
+            }
+        }
+
+        bool MatchAtom(const Atom& atom, Unit unit) const noexcept
+        {
+            if (atom.kind == AtomKind::Literal) return static_cast<Unit>(atom.c) == unit;
+            return atom.kind == AtomKind::Any || MatchClass(atom, static_cast<T>(unit));
+        }
+
+        bool MatchClass(const Atom& atom, T c) const noexcept
+        {
+            const Unit u = static_cast<Unit>(c);
+            bool member = false;
+            for (uint32_t i = 0; i < atom.rangeCount && !member; ++i)
+            {
+                const Range& range = ranges_[atom.firstRange + i];
+                member = u >= range.first && u <= range.last;
+            }
+            return member != atom.negated;
+        }
+
+        bool MatchAt(const Segment& segment, const T* buffer) const noexcept
+        {
+            if (segment.literal)
+            {
+                return !segment.length || Simd::Equals(buffer, searchers_[segment.searcher].Needle().Buffer(), segment.length);
+            }
+            for (uint32_t i = 0; i < segment.length; ++i)
+            {
+                const Atom& atom = atoms_[segment.firstAtom + i];
+                if (atom.kind == AtomKind::Literal ? buffer[i] != atom.c : atom.kind == AtomKind::Class && !MatchClass(atom, buffer[i])) return false;
+            }
+            return true;
+        }
+        // the leftmost place of a segment in [start, end)
+        uint32_t Find(const Segment& segment, const T* buffer, uint32_t start, uint32_t end) const noexcept
+        {
+            if (end - start < segment.length) return InvalidIndex;
+            const uint32_t last = end - segment.length;
+            if (segment.scanner != InvalidIndex && segment.searcher == InvalidIndex) return Scan(segment, buffer, start, end);
+            if (segment.searcher == InvalidIndex)
+            {
+                for (uint32_t i = start; i <= last; ++i)
+                {
+                    if (MatchAt(segment, buffer + i)) return i;
+                }
+                return InvalidIndex;
+            }
+            const StringSearcher<T>& searcher = searchers_[segment.searcher];
+            const uint32_t literalEnd = last + segment.literalOffset + searcher.Needle().Length();
+            uint32_t misses = 0;
+            for (uint32_t from = start + segment.literalOffset; ;)
+            {
+                const uint32_t index = searcher.IndexOf(buffer + from, literalEnd - from);
+                if (index == InvalidIndex) return InvalidIndex;
+                const uint32_t candidate = from + index - segment.literalOffset;
+                if (segment.literal || MatchAt(segment, buffer + candidate)) return candidate;
+                // each miss costs up to the length of the segment, past a budget the scan takes over
+                if (segment.scanner != InvalidIndex && Simd::TooManyMisses(++misses, segment.length, candidate - start))
+                {
+                    return Scan(segment, buffer, candidate + 1, end);
+                }
+                from += index + 1;
+            }
+        }
+        // the leftmost place of a segment in [start, end) by Shift-And: bit j of the state is set while the last j + 1
+        // characters match the first j + 1 atoms
+        uint32_t Scan(const Segment& segment, const T* buffer, uint32_t start, uint32_t end) const noexcept
+        {
+            const Scanner& scanner = scanners_[segment.scanner];
+            const uint32_t words = scanner.words;
+            const uint64_t found = uint64_t(1) << ((segment.length - 1) % 64);
+            if (words == 1)
+            {
+                uint64_t state = 0;
+                for (uint32_t i = start; i < end; ++i)
+                {
+                    state = ((state << 1) | 1) & *Masks(scanner, buffer[i]);
+                    if (state & found) return i + 1 - segment.length;
+                }
+                return InvalidIndex;
+            }
+            uint64_t state[MaxScanWords] = {};
+            for (uint32_t i = start; i < end; ++i)
+            {
+                const uint64_t* masks = Masks(scanner, buffer[i]);
+                uint64_t carry = 1;
+                for (uint32_t word = 0; word < words; ++word)
+                {
+                    const uint64_t next = (state[word] << 1) | carry;
+                    carry = state[word] >> 63;
+                    state[word] = next & masks[word];
+                }
+                if (state[words - 1] & found) return i + 1 - segment.length;
+            }
+            return InvalidIndex;
+        }
+
+        const uint64_t* Masks(const Scanner& scanner, T c) const noexcept
+        {
+            const Unit unit = static_cast<Unit>(c);
+            if (unit < ByteUnits) return &masks_[scanner.firstMask + unit * scanner.words];
+            // the last interval starting at or below the unit, the first one starts at 256
+            const Unit* first = &boundaries_[scanner.firstBoundary];
+            const uint32_t interval = static_cast<uint32_t>(std::upper_bound(first, first + scanner.boundaryCount, unit) - first) - 1;
+            return &masks_[scanner.firstMask + (ByteUnits + interval) * scanner.words];
+        }
+
+        String<T> pattern_;
+        uint32_t minLength_;
+        bool hasStar_;
+        List<Atom> atoms_;
+        List<Range> ranges_;
+        List<Segment> segments_;
+        List<StringSearcher<T>> searchers_;
+        List<Scanner> scanners_;
+        List<uint64_t> masks_;
+        List<Unit> boundaries_;
+    };
+    /// <summary>
+    /// Tests a string against many glob patterns in one pass. The longest literal run of each pattern is fed to a
+    /// MultiPatternMatcher, one scan of the string finds which of them occur and only their patterns, together with those
+    /// having no literal at all, are matched in full.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class GlobSet
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = String<T>::InvalidIndex;
+
+        explicit GlobSet(const List<String<T>>& patterns) : patterns_(Compile(patterns)), matcher_(CollectLiterals())
+        {
+        }
+
+        uint32_t PatternCount() const noexcept
+        {
+            return patterns_.Count();
+        }
+
+        const GlobPattern<T>& Pattern(uint32_t index) const
+        {
+            return patterns_[index];
+        }
+
+        bool IsMatch(StringView<T> value) const
+        {
+            return FirstMatch(value) != InvalidIndex;
+        }
+        /// <summary>
+        /// The lowest index of a pattern matching a string, as for rules tried in order.
+        /// </summary>
+        /// <returns>index of the pattern, or InvalidIndex</returns>
+        uint32_t FirstMatch(StringView<T> value) const
+        {
+            uint32_t first = InvalidIndex;
+            ForEachCandidate(value, [&](uint32_t index)
+            {
+                if (!patterns_[index].IsMatch(value)) return true;
+                first = index;
+                return false;
+            });
+            return first;
+        }
+        /// <summary>
+        /// The indexes of all patterns matching a string, in ascending order.
+        /// </summary>
+        List<uint32_t> Matches(StringView<T> value) const
+        {
+            List<uint32_t> matches;
+            ForEachCandidate(value, [&](uint32_t index)
+            {
+                if (patterns_[index].IsMatch(value)) matches.Add(index);
+                return true;
+            });
+            return matches;
+        }
+
+    private:
+        // candidates of this many patterns are marked on the stack
+        static constexpr uint32_t LocalCandidateWords = 64;
+
+        static List<GlobPattern<T>> Compile(const List<String<T>>& patterns)
+        {
+            List<GlobPattern<T>> compiled;
+            for (uint32_t i = 0; i < patterns.Count(); ++i) compiled.Add(GlobPattern<T>(patterns[i]));
+            return compiled;
+        }
+
+        List<String<T>> CollectLiterals()
+        {
+            List<String<T>> literals;
+            for (uint32_t i = 0; i < patterns_.Count(); i += 64) unfiltered_.Add(0);
+            for (uint32_t i = 0; i < patterns_.Count(); ++i)
+            {
+                const StringView<T> literal = patterns_[i].RequiredLiteral();
+                if (literal.Length())
+                {
+                    literals.Add(literal.ToString());
+                    literalOwners_.Add(i);
+                }
+                else
+                {
+                    unfiltered_[i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+            return literals;
+        }
+        /// <summary>
+        /// Visit the patterns whose literal occurs in the string, or which have none, in ascending order and each one once.
+        /// They are marked in a bitset, so a literal occurring many times costs no more than setting its bit again.
+        /// </summary>
+        template<typename Action>
+        void ForEachCandidate(StringView<T> value, const Action& action) const
+        {
+            const uint32_t wordCount = unfiltered_.Count();
+            if (!wordCount) return;
+            uint64_t local[LocalCandidateWords];
+            std::unique_ptr<uint64_t[]> heap;
+            uint64_t* candidates = local;
+            if (wordCount > LocalCandidateWords)
+            {
+                heap.reset(new uint64_t[wordCount]);
+                candidates = heap.get();
+            }
+            std::memcpy(candidates, &unfiltered_[0], wordCount * sizeof(uint64_t));
+            matcher_.ForEachMatch(value.Buffer(), value.Length(), [&](uint32_t literal, uint32_t)
+            {
+                const uint32_t owner = literalOwners_[literal];
+                candidates[owner / 64] |= uint64_t(1) << (owner % 64);
+                return true;
+            });
+            for (uint32_t word = 0; word < wordCount; ++word)
+            {
+                for (uint64_t bits = candidates[word]; bits; bits &= bits - 1)
+                {
+                    if (!action(word * 64 + Simd::LowestBit64(bits))) return;
+                }
+            }
+        }
+
+        List<GlobPattern<T>> patterns_;
+        List<uint32_t> literalOwners_;
+        // a bitset of the patterns without a literal
+        List<uint64_t> unfiltered_;
+        MultiPatternMatcher<T> matcher_;
+    };
+}
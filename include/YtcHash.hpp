@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace Ytc
+{
+    /// <summary>
+    /// A fast non-cryptographic hash of byte sequences (wyhash), it is not meant to resist hash flooding.
+    /// </summary>
+    namespace Hash
+    {
+        constexpr uint64_t Secret[4] =
+        {
+            0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+        };
+        /// <summary>
+        /// The full 128-bit product, the low half is stored into a and the high half into b.
+        /// </summary>
+        inline void Multiply(uint64_t& a, uint64_t& b) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            __uint128_t product = a;
+            product *= b;
+            a = static_cast<uint64_t>(product);
+            b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            a = _umul128(a, b, &b);
+#else
+            const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+            const uint64_t high = ha * hb, middle0 = ha * lb, middle1 = hb * la, low = la * lb;
+            const uint64_t t = low + (middle0 << 32);
+            uint64_t carry = t < low;
+            const uint64_t lo = t + (middle1 << 32);
+            carry += lo < t;
+            a = lo;
+            b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+        }
+
+        inline uint64_t Mix(uint64_t a, uint64_t b) noexcept
+        {
+            Multiply(a, b);
+            return a ^ b;
+        }
+
+        inline uint64_t Read64(const uint8_t* p) noexcept
+        {
+            uint64_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t Read32(const uint8_t* p) noexcept
+        {
+            uint32_t value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        /// <summary>
+        /// Hash a byte sequence, equal sequences hash equal whatever their address or alignment.
+        /// </summary>
+        /// <param name="data">the bytes</param>
+        /// <param name="size">count of bytes</param>
+        /// <param name="seed">selects another member of the hash family</param>
+        inline uint64_t Bytes(const void* data, size_t size, uint64_t seed = 0) noexcept
+        {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            seed ^= Mix(seed ^ Secret[0], Secret[1]);
+            uint64_t a, b;
+            if (size <= 16)
+            {
+                if (size >= 4)
+                {
+                    // two overlapping pairs of words cover every size from 4 to 16
+                    const size_t step = (size >> 3) << 2;
+                    a = (Read32(p) << 32) | Read32(p + step);
+                    b = (Read32(p + size - 4) << 32) | Read32(p + size - 4 - step);
+                }
+                else if (size > 0)
+                {
+                    a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+                    b = 0;
+                }
+                else
+                {
+                    a = b = 0;
+                }
+            }
+            else
+            {
+                size_t remaining = size;
+                if (remaining > 48)
+                {
+                    uint64_t seed1 = seed, seed2 = seed;
+                    do
+                    {
+                        seed = Mix(Read64(p) ^ Secret[1], Read64(p + 8) ^ seed);
+                        seed1 = Mix(Read64(p + 16) ^ Secret[2], Read64(p + 24) ^ seed1);
+                        seed2 = Mix(Read64(p + 32) ^ Secret[3], Read64(p + 40) ^ seed2);
+                        p += 48;
+                        remaining -= 48;
+                    } while (remaining > 48);
+                    seed ^= seed1 ^ seed2;
+                }
+                while (remaining > 16)
+                {
+                    seed = Mix(Read64(p) ^ Secret[1], Read64(p + 8) ^ seed);
+                    p += 16;
+                    remaining -= 16;
+                }
+                a = Read64(p + remaining - 16);
+                b = Read64(p + remaining - 8);
+            }
+            a ^= Secret[1];
+            b ^= seed;
+            Multiply(a, b);
+            return Mix(a ^ Secret[0] ^ size, b ^ Secret[1]);
+        }
+    }
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "YtcString.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace Ytc
+{
+    template<typename T>
+    class InternPool;
+
+    /// <summary>
+    /// A handle to a string interned by an InternPool, atoms of the same pool are equal if and only if their strings are equal.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class Atom
+    {
+    public:
+        constexpr Atom() noexcept : entry_(nullptr)
+        {
+        }
+        /// <summary>
+        /// Whether the atom is default-constructed or returned by an unsuccessful Find.
+        /// </summary>
+        bool IsNull() const noexcept
+        {
+            return entry_ == nullptr;
+        }
+
+        const String<T>& Value() const noexcept
+        {
+            static const String<T> empty;
+            return entry_ ? entry_->value : empty;
+        }
+
+        StringView<T> View() const noexcept
+        {
+            return Value();
+        }
+
+        size_t GetHashCode() const noexcept
+        {
+            return entry_ ? entry_->hash : 0;
+        }
+
+        friend bool operator==(Atom lhs, Atom rhs) noexcept
+        {
+            return lhs.entry_ == rhs.entry_;
+        }
+
+        friend bool operator!=(Atom lhs, Atom rhs) noexcept
+        {
+            return lhs.entry_ != rhs.entry_;
+        }
+
+    private:
+        friend class InternPool<T>;
+
+        explicit Atom(const typename InternPool<T>::Entry* entry) noexcept : entry_(entry)
+        {
+        }
+
+        const typename InternPool<T>::Entry* entry_;
+    };
+
+    /// <summary>
+    /// Keeps one copy of each distinct string and hands out atoms which compare by pointer.
+    /// Lookups of strings already interned take no lock: the pool is split into shards by hash, each shard is an open-addressing
+    /// table which readers probe without locking and which a writer grows by publishing a new table, the old one is kept alive.
+    /// Interned strings live as long as the pool.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class InternPool
+    {
+        friend class Ytc::Atom<T>;
+
+        struct Entry
+        {
+            String<T> value;
+            size_t hash;
+        };
+
+    public:
+        using Atom = Ytc::Atom<T>;
+
+        InternPool()
+        {
+            for (auto& shard : shards_)
+            {
+                shard.table.store(new Table(InitialCapacity, nullptr), std::memory_order_relaxed);
+                shard.count = 0;
+            }
+        }
+
+        InternPool(const InternPool&) = delete;
+        InternPool& operator=(const InternPool&) = delete;
+
+        ~InternPool()
+        {
+            for (auto& shard : shards_)
+            {
+                Table* table = shard.table.load(std::memory_order_relaxed);
+                for (uint32_t i = 0; i < table->capacity; ++i)
+                {
+                    delete table->slots[i].load(std::memory_order_relaxed);
+                }
+                while (table)
+                {
+                    Table* previous = table->previous;
+                    delete table;
+                    table = previous;
+                }
+            }
+        }
+        /// <summary>
+        /// Get the atom of a string, the string is copied into the pool the first time.
+        /// </summary>
+        /// <param name="value">the string</param>
+        /// <returns>the atom, never null</returns>
+        Atom Intern(StringView<T> value)
+        {
+            const size_t hash = value.GetHashCode();
+            Shard& shard = shards_[hash & (ShardCount - 1)];
+            if (const Entry* entry = Lookup(shard.table.load(std::memory_order_acquire), hash, value))
+            {
+                return Atom(entry);
+            }
+
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Table* table = shard.table.load(std::memory_order_relaxed);
+            if (const Entry* entry = Lookup(table, hash, value))
+            {
+                return Atom(entry);
+            }
+            if ((shard.count + 1) * 2 > table->capacity)
+            {
+                table = Grow(shard, table);
+            }
+            // interned strings outlive any request, they must not come from an arena
+            MemoryResourceScope heap(nullptr);
+            Entry* entry = new Entry{ value.ToString(), hash };
+            Insert(table, entry, std::memory_order_release);
+            ++shard.count;
+            return Atom(entry);
+        }
+        /// <summary>
+        /// Get the atom of a string without interning it.
+        /// </summary>
+        /// <returns>the atom, null if the string has not been interned</returns>
+        Atom Find(StringView<T> value) const noexcept
+        {
+            const size_t hash = value.GetHashCode();
+            const Shard& shard = shards_[hash & (ShardCount - 1)];
+            return Atom(Lookup(shard.table.load(std::memory_order_acquire), hash, value));
+        }
+        /// <summary>
+        /// Count of distinct strings interned.
+        /// </summary>
+        uint32_t Count() const
+        {
+            uint32_t count = 0;
+            for (auto& shard : shards_)
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                count += shard.count;
+            }
+            return count;
+        }
+
+    private:
+        static constexpr uint32_t ShardBits = 6;
+        static constexpr uint32_t ShardCount = 1u << ShardBits;
+        static constexpr uint32_t InitialCapacity = 16;
+
+        struct Table
+        {
+            Table(uint32_t capacity, Table* previous) : capacity(capacity), previous(previous), slots(new std::atomic<const Entry*>[capacity])
+            {
+                for (uint32_t i = 0; i < capacity; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            ~Table()
+            {
+                delete[] slots;
+            }
+
+            uint32_t capacity; // power of two
+            Table* previous; // retired, readers may still be probing it
+            std::atomic<const Entry*>* slots;
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::atomic<Table*> table;
+            uint32_t count;
+        };
+
+        static const Entry* Lookup(const Table* table, size_t hash, StringView<T> value) noexcept
+        {
+            const uint32_t mask = table->capacity - 1;
+            for (uint32_t i = static_cast<uint32_t>(hash >> ShardBits) & mask;; i = (i + 1) & mask)
+            {
+                const Entry* entry = table->slots[i].load(std::memory_order_acquire);
+                if (!entry) return nullptr;
+                if (entry->hash == hash && StringView<T>(entry->value) == value) return entry;
+            }
+        }
+
+        static void Insert(Table* table, const Entry* entry, std::memory_order order) noexcept
+        {
+            const uint32_t mask = table->capacity - 1;
+            uint32_t i = static_cast<uint32_t>(entry->hash >> ShardBits) & mask;
+            while (table->slots[i].load(std::memory_order_relaxed)) i = (i + 1) & mask;
+            table->slots[i].store(entry, order);
+        }
+
+        static Table* Grow(Shard& shard, Table* table)
+        {
+            if (table->capacity > (String<T>::MaxSize >> 1))
+            {
+                throw Exception(L"Too many strings for the intern pool!");
+            }
+            Table* grown = new Table(table->capacity * 2, table);
+            for (uint32_t i = 0; i < table->capacity; ++i)
+            {
+                if (const Entry* entry = table->slots[i].load(std::memory_order_relaxed))
+                {
+                    Insert(grown, entry, std::memory_order_relaxed);
+                }
+            }
+            shard.table.store(grown, std::memory_order_release);
+            return grown;
+        }
+
+        Shard shards_[ShardCount];
+    };
+}
+
+namespace std
+{
+    template<typename T>
+    struct hash<Ytc::Atom<T>>
+    {
+        size_t operator()(Ytc::Atom<T> value) const noexcept
+        {
+            return value.GetHashCode();
+        }
+    };
+}
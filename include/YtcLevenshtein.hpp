@@ -0,0 +1,327 @@
+#pragma once
+
+#include "YtcSimd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace Ytc
+{
+    /// <summary>
+    /// Bit-parallel Levenshtein distance (Myers, in the formulation of Hyyrö) which String::EditDistance and
+    /// String::FuzzyIndexOf are built on. A column of the matrix is kept as vertical deltas, one bit per character of
+    /// the pattern, so a character of the text costs a few word operations for each 64 characters of the pattern.
+    /// </summary>
+    namespace Levenshtein
+    {
+        /// <summary>
+        /// For each character of a pattern, the bits of the positions where it occurs, in blocks of 64 positions.
+        /// Characters below 256 are found in a direct table, wider ones in a small open addressed table.
+        /// </summary>
+        /// <typeparam name="T">The type of character</typeparam>
+        template<typename T>
+        class PatternMasks
+        {
+        public:
+            /// <summary>
+            /// Build the masks of a pattern.
+            /// </summary>
+            /// <param name="pattern">the characters of the pattern</param>
+            /// <param name="length">the count of characters</param>
+            /// <param name="reversed">number the positions from the last character, to match the pattern backwards</param>
+            PatternMasks(const T* pattern, uint32_t length, bool reversed = false)
+                : length_(length), blocks_((length + 63) / 64), slotCount_(1), wideShift_(32)
+            {
+                // a character which is not in the pattern has the mask of slot 0, which is all zero
+                std::memset(byteSlots_, 0, sizeof(byteSlots_));
+                const size_t maxSlots = size_t(length) + 1;
+                if (maxSlots * blocks_ <= InlineSlots)
+                {
+                    masks_ = inlineMasks_;
+                }
+                else
+                {
+                    heapMasks_.reset(new uint64_t[maxSlots * blocks_]);
+                    masks_ = heapMasks_.get();
+                }
+                std::memset(masks_, 0, sizeof(uint64_t) * blocks_);
+                wide_ = inlineWide_;
+                if (sizeof(T) > 1)
+                {
+                    uint32_t capacity = 2;
+                    while (capacity < 2 * length) capacity *= 2;
+                    if (capacity > InlineWide)
+                    {
+                        heapWide_.reset(new WideSlot[capacity]);
+                        wide_ = heapWide_.get();
+                    }
+                    std::memset(wide_, 0, sizeof(WideSlot) * capacity);
+                    for (uint32_t i = capacity; i > 1; i /= 2) --wideShift_;
+                }
+                for (uint32_t i = 0; i < length; ++i)
+                {
+                    const Unit c = static_cast<Unit>(pattern[reversed ? length - 1 - i : i]);
+                    masks_[size_t(AddSlot(c)) * blocks_ + i / 64] |= uint64_t(1) << (i % 64);
+                }
+            }
+
+            PatternMasks(const PatternMasks&) = delete;
+            PatternMasks& operator=(const PatternMasks&) = delete;
+
+            uint32_t Length() const noexcept
+            {
+                return length_;
+            }
+
+            uint32_t Blocks() const noexcept
+            {
+                return blocks_;
+            }
+            /// <summary>
+            /// The masks of a character, one for each block.
+            /// </summary>
+            const uint64_t* Masks(T c) const noexcept
+            {
+                return masks_ + size_t(Slot(static_cast<Unit>(c))) * blocks_;
+            }
+
+        private:
+            using Unit = Simd::Unit<T>;
+
+            struct WideSlot
+            {
+                Unit c;
+                uint32_t slot;
+            };
+
+            // a pattern of a single block has 64 different characters at most
+            static constexpr uint32_t InlineSlots = 65;
+            static constexpr uint32_t InlineWide = sizeof(T) > 1 ? 128 : 1;
+
+            uint32_t WideIndex(Unit c) const noexcept
+            {
+                return static_cast<uint32_t>((static_cast<uint64_t>(c) * 0x9E3779B1u) & 0xFFFFFFFFu) >> wideShift_;
+            }
+
+            uint32_t Slot(Unit c) const noexcept
+            {
+                if (sizeof(T) == 1 || c < 256) return byteSlots_[static_cast<uint8_t>(c)];
+                const uint32_t mask = (uint32_t(1) << (32 - wideShift_)) - 1;
+                for (uint32_t i = WideIndex(c); ; i = (i + 1) & mask)
+                {
+                    if (!wide_[i].slot || wide_[i].c == c) return wide_[i].slot;
+                }
+            }
+
+            uint32_t AddSlot(Unit c) noexcept
+            {
+                uint32_t* slot;
+                if (sizeof(T) == 1 || c < 256)
+                {
+                    slot = &byteSlots_[static_cast<uint8_t>(c)];
+                }
+                else
+                {
+                    const uint32_t mask = (uint32_t(1) << (32 - wideShift_)) - 1;
+                    uint32_t i = WideIndex(c);
+                    while (wide_[i].slot && wide_[i].c != c) i = (i + 1) & mask;
+                    wide_[i].c = c;
+                    slot = &wide_[i].slot;
+                }
+                if (!*slot)
+                {
+                    *slot = slotCount_++;
+                    std::memset(masks_ + size_t(*slot) * blocks_, 0, sizeof(uint64_t) * blocks_);
+                }
+                return *slot;
+            }
+
+            uint32_t length_;
+            uint32_t blocks_;
+            uint32_t slotCount_;
+            uint32_t wideShift_;
+            uint64_t* masks_;
+            WideSlot* wide_;
+            std::unique_ptr<uint64_t[]> heapMasks_;
+            std::unique_ptr<WideSlot[]> heapWide_;
+            uint32_t byteSlots_[256];
+            uint64_t inlineMasks_[InlineSlots];
+            WideSlot inlineWide_[InlineWide];
+        };
+        // advance 64 rows by one column, taking the horizontal delta of the row above and giving the one of outBit
+        inline int AdvanceBlock(uint64_t& pv, uint64_t& mv, uint64_t eq, int delta, uint64_t outBit) noexcept
+        {
+            const uint64_t xv = eq | mv;
+            if (delta < 0) eq |= 1;
+            const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+            uint64_t ph = mv | ~(xh | pv);
+            uint64_t mh = pv & xh;
+            const int out = static_cast<int>((ph & outBit) != 0) - static_cast<int>((mh & outBit) != 0);
+            ph = (ph << 1) | static_cast<uint64_t>(delta > 0);
+            mh = (mh << 1) | static_cast<uint64_t>(delta < 0);
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+            return out;
+        }
+        /// <summary>
+        /// Compute the last row of the matrix of a pattern against a text, one character of the text at a time.
+        /// An anchored matrix starts the text at its first character (the top row counts insertions), otherwise a
+        /// match may start anywhere in the text (the top row is zero).
+        /// </summary>
+        /// <param name="text">the first character of the text</param>
+        /// <param name="step">1 to read the text forwards, -1 to read it backwards</param>
+        /// <param name="length">the count of characters</param>
+        /// <param name="visit">called with the count of characters read and the distance of the whole pattern to
+        /// them, the scan stops when it returns false</param>
+        template<typename T, typename Visit>
+        inline void Scan(const PatternMasks<T>& masks, bool anchored, const T* text, ptrdiff_t step, uint32_t length, Visit&& visit)
+        {
+            const uint32_t blocks = masks.Blocks();
+            const int topDelta = anchored ? 1 : 0;
+            const uint64_t lastBit = uint64_t(1) << ((masks.Length() + 63) % 64);
+            uint32_t score = masks.Length();
+            if (!visit(0, score)) return;
+            // a single block is kept in locals which the compiler holds in registers
+            if (blocks == 1)
+            {
+                uint64_t pv = ~uint64_t(0), mv = 0;
+                for (uint32_t i = 0; i < length; ++i)
+                {
+                    score += AdvanceBlock(pv, mv, *masks.Masks(text[step * ptrdiff_t(i)]), topDelta, lastBit);
+                    if (!visit(i + 1, score)) return;
+                }
+                return;
+            }
+            std::unique_ptr<uint64_t[]> state(new uint64_t[2 * size_t(blocks)]);
+            for (uint32_t i = 0; i < blocks; ++i)
+            {
+                state[2 * i] = ~uint64_t(0);
+                state[2 * i + 1] = 0;
+            }
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                const uint64_t* eq = masks.Masks(text[step * ptrdiff_t(i)]);
+                int delta = topDelta;
+                for (uint32_t j = 0; j + 1 < blocks; ++j)
+                {
+                    delta = AdvanceBlock(state[2 * j], state[2 * j + 1], eq[j], delta, uint64_t(1) << 63);
+                }
+                score += AdvanceBlock(state[2 * blocks - 2], state[2 * blocks - 1], eq[blocks - 1], delta, lastBit);
+                if (!visit(i + 1, score)) return;
+            }
+        }
+        /// <summary>
+        /// The distance of a pattern to a text, stopping as soon as it is known to be larger than maxDistance.
+        /// </summary>
+        /// <returns>the distance, or maxDistance + 1 if it is larger than maxDistance</returns>
+        template<typename T>
+        inline uint32_t Distance(const PatternMasks<T>& masks, const T* text, uint32_t length, uint32_t maxDistance)
+        {
+            const uint32_t patternLength = masks.Length();
+            // each character the longer one has over the other one costs an insertion
+            const uint32_t difference = patternLength > length ? patternLength - length : length - patternLength;
+            if (difference > maxDistance) return maxDistance + 1;
+            if (!patternLength) return length;
+            uint32_t distance = maxDistance + 1;
+            Scan(masks, true, text, 1, length, [&](uint32_t read, uint32_t score)
+            {
+                // the rest of the text lowers the distance by one for each character at most
+                if (score > uint64_t(maxDistance) + (length - read)) return false;
+                if (read == length) distance = score;
+                return true;
+            });
+            return distance;
+        }
+        /// <summary>
+        /// The distance of two strings, stopping as soon as it is known to be larger than maxDistance.
+        /// </summary>
+        /// <returns>the distance, or maxDistance + 1 if it is larger than maxDistance</returns>
+        template<typename T>
+        inline uint32_t Distance(const T* s1, uint32_t length1, const T* s2, uint32_t length2, uint32_t maxDistance)
+        {
+            // the characters both strings start or end with do not change the distance
+            const uint32_t shorter = length1 < length2 ? length1 : length2;
+            uint32_t prefix = Simd::Mismatch(s1, s2, shorter);
+            if (prefix == Simd::NotFound) prefix = shorter;
+            s1 += prefix;
+            s2 += prefix;
+            length1 -= prefix;
+            length2 -= prefix;
+            while (length1 && length2 && s1[length1 - 1] == s2[length2 - 1])
+            {
+                --length1;
+                --length2;
+            }
+            // the shorter string is the pattern so it takes the fewest blocks
+            if (length1 > length2)
+            {
+                std::swap(s1, s2);
+                std::swap(length1, length2);
+            }
+            const PatternMasks<T> masks(s1, length1);
+            return Distance(masks, s2, length2, maxDistance);
+        }
+        /// <summary>
+        /// Find the first part of a text within maxDistance of a pattern. The end of the match is the first position
+        /// where the distance is small enough, moved on while the distance keeps dropping; the start is then found by
+        /// matching the reversed pattern backwards from that end, in the same way.
+        /// </summary>
+        /// <param name="matchLength">the count of characters of the match</param>
+        /// <returns>the index of the match, or Simd::NotFound</returns>
+        template<typename T>
+        inline uint32_t Find(const T* text, uint32_t length, const T* pattern, uint32_t patternLength, uint32_t maxDistance, uint32_t& matchLength)
+        {
+            matchLength = 0;
+            if (!patternLength) return 0;
+            // the first position where the distance gets small enough, moved on while it keeps dropping
+            uint32_t end = Simd::NotFound;
+            uint32_t best = 0;
+            {
+                const PatternMasks<T> masks(pattern, patternLength);
+                Scan(masks, false, text, 1, length, [&](uint32_t read, uint32_t score)
+                {
+                    if (end == Simd::NotFound)
+                    {
+                        if (score <= maxDistance)
+                        {
+                            end = read;
+                            best = score;
+                        }
+                        return true;
+                    }
+                    if (score >= best) return false;
+                    end = read;
+                    best = score;
+                    return best != 0;
+                });
+            }
+            if (end == Simd::NotFound || !end) return end;
+            // the start is found in the same way by matching the reversed pattern backwards from the end, a match
+            // within maxDistance has no more than patternLength + maxDistance characters
+            const PatternMasks<T> masks(pattern, patternLength, true);
+            const uint32_t limit = end < uint64_t(patternLength) + maxDistance ? end : patternLength + maxDistance;
+            bool found = false;
+            Scan(masks, true, text + end - 1, -1, limit, [&](uint32_t read, uint32_t score)
+            {
+                if (!found)
+                {
+                    if (score <= maxDistance)
+                    {
+                        found = true;
+                        matchLength = read;
+                        best = score;
+                    }
+                    return true;
+                }
+                if (score >= best) return false;
+                matchLength = read;
+                best = score;
+                return best != 0;
+            });
+            return end - matchLength;
+        }
+    }
+}
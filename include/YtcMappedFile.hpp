@@ -0,0 +1,172 @@
+#pragma once
+
+#include "YtcString.hpp"
+
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Ytc
+{
+    /// <summary>
+    /// A file mapped read-only into memory, the strings made from it refer to its characters without copying them.
+    /// Pages are read on demand by the system, so opening a file of any size costs the same. The mapping is shared by the
+    /// copies of this handle and by those strings, and unmapped when the last of them goes away.
+    /// </summary>
+    class MappedFile
+    {
+    public:
+        /// <summary>
+        /// Map a whole file, it should not be truncated while it is mapped.
+        /// </summary>
+        /// <param name="path">The path of the file.</param>
+        explicit MappedFile(const char* path) : region_(Map(path))
+        {
+        }
+
+        MappedFile(const MappedFile& other) noexcept : region_(other.region_)
+        {
+            region_->AddRef();
+        }
+
+        MappedFile& operator=(const MappedFile& other) noexcept
+        {
+            other.region_->AddRef();
+            region_->Release();
+            region_ = other.region_;
+            return *this;
+        }
+
+        ~MappedFile()
+        {
+            region_->Release();
+        }
+
+        const char* Data() const noexcept
+        {
+            return static_cast<const char*>(region_->Data());
+        }
+        /// <summary>
+        /// Count of bytes of the file.
+        /// </summary>
+        uint64_t Size() const noexcept
+        {
+            return region_->Size();
+        }
+        /// <summary>
+        /// Get a string referring to characters of the file, it is not zero-terminated; see String::FromRegion.
+        /// </summary>
+        /// <param name="offset">The byte offset of the first character, a multiple of the size of a character.</param>
+        /// <param name="length">The number of characters, MaxSize for all of them up to the end of the file.</param>
+        /// <returns>a new string instance</returns>
+        template<typename T>
+        String<T> ToString(uint64_t offset = 0, uint32_t length = String<T>::MaxSize) const
+        {
+            return String<T>::FromRegion(*region_, offset, length);
+        }
+
+    private:
+        class Region : public MappedRegion
+        {
+        public:
+            Region(const void* data, uint64_t size) noexcept : MappedRegion(data, size)
+            {
+            }
+
+        protected:
+            ~Region() override
+            {
+                if (!Size()) return;
+#ifdef _WIN32
+                UnmapViewOfFile(Data());
+#else
+                munmap(const_cast<void*>(Data()), static_cast<size_t>(Size()));
+#endif
+            }
+        };
+
+        static MappedRegion* Map(const char* path)
+        {
+            if (!path) throw Exception(L"Null pointer is not a path!");
+#ifdef _WIN32
+            HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) throw Exception(L"Cannot open the file!");
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size))
+            {
+                CloseHandle(file);
+                throw Exception(L"Cannot open the file!");
+            }
+            // a file of zero bytes cannot be mapped
+            if (size.QuadPart == 0)
+            {
+                CloseHandle(file);
+                return new Region("", 0);
+            }
+            if (static_cast<uint64_t>(size.QuadPart) > SIZE_MAX)
+            {
+                CloseHandle(file);
+                throw Exception(L"The file is too large to be mapped!");
+            }
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (!mapping) throw Exception(L"Cannot map the file!");
+            // the view keeps the mapping alive
+            const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (!data) throw Exception(L"Cannot map the file!");
+            const uint64_t bytes = static_cast<uint64_t>(size.QuadPart);
+#else
+            const int file = open(path, O_RDONLY | O_CLOEXEC);
+            if (file < 0) throw Exception(L"Cannot open the file!");
+            struct stat status;
+            if (fstat(file, &status) != 0)
+            {
+                close(file);
+                throw Exception(L"Cannot open the file!");
+            }
+            // a file of zero bytes cannot be mapped
+            if (status.st_size == 0)
+            {
+                close(file);
+                return new Region("", 0);
+            }
+            if (static_cast<uint64_t>(status.st_size) > SIZE_MAX)
+            {
+                close(file);
+                throw Exception(L"The file is too large to be mapped!");
+            }
+            const uint64_t bytes = static_cast<uint64_t>(status.st_size);
+            void* data = mmap(nullptr, static_cast<size_t>(bytes), PROT_READ, MAP_PRIVATE, file, 0);
+            // the mapping keeps the file alive
+            close(file);
+            if (data == MAP_FAILED) throw Exception(L"Cannot map the file!");
+#endif
+            try
+            {
+                return new Region(data, bytes);
+            }
+            catch (...)
+            {
+#ifdef _WIN32
+                UnmapViewOfFile(data);
+#else
+                munmap(data, static_cast<size_t>(bytes));
+#endif
+                throw;
+            }
+        }
+
+        MappedRegion* region_;
+    };
+}
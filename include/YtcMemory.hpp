@@ -1,6 +1,13 @@
+#pragma once
+
 #include "YtcError.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
+#include <type_traits>
 namespace Ytc
 {
     template<typename T>
@@ -12,5 +19,220 @@ namespace Ytc
     {
         return std::make_shared<T>(std::forward<Args>(args)...);
     }
+    /// <summary>
+    /// Whether an object may be moved to another address by copying its bytes, the source then being dropped without its
+    /// destructor; containers shift and grow such elements with memmove and realloc. Trivially copyable types are, other
+    /// types opt in by specializing this trait when they hold no pointer into themselves and are not known by address.
+    /// </summary>
+    template<typename T>
+    struct IsTriviallyRelocatable : std::is_trivially_copyable<T>
+    {
+    };
+
+    // a pair of pointers to the object and to its control block
+    template<typename T>
+    struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type
+    {
+    };
+
+    /// <summary>
+    /// Where buffers of strings come from. A null resource stands for the global heap.
+    /// </summary>
+    class MemoryResource
+    {
+    public:
+        virtual ~MemoryResource() = default;
+
+        virtual void* Allocate(size_t size, size_t alignment) = 0;
+        /// <summary>
+        /// Give back a block got from Allocate with the same size and alignment.
+        /// </summary>
+        virtual void Deallocate(void* block, size_t size, size_t alignment) noexcept = 0;
+        /// <summary>
+        /// The resource new buffers are allocated from on this thread, null unless a MemoryResourceScope is active.
+        /// </summary>
+        static MemoryResource* Current() noexcept
+        {
+            return CurrentSlot();
+        }
+
+    private:
+        friend class MemoryResourceScope;
+
+        static MemoryResource*& CurrentSlot() noexcept
+        {
+            static thread_local MemoryResource* current = nullptr;
+            return current;
+        }
+    };
+    /// <summary>
+    /// Makes a resource the current one of this thread until the scope ends, scopes may be nested.
+    /// Buffers remember the resource they come from: a string which grows later stays in it, copies share it.
+    /// </summary>
+    class MemoryResourceScope
+    {
+    public:
+        explicit MemoryResourceScope(MemoryResource* resource) noexcept : previous_(MemoryResource::CurrentSlot())
+        {
+            MemoryResource::CurrentSlot() = resource;
+        }
+
+        MemoryResourceScope(const MemoryResourceScope&) = delete;
+        MemoryResourceScope& operator=(const MemoryResourceScope&) = delete;
+
+        ~MemoryResourceScope()
+        {
+            MemoryResource::CurrentSlot() = previous_;
+        }
+
+    private:
+        MemoryResource* previous_;
+    };
+    /// <summary>
+    /// Read-only memory which strings refer to without copying it, such as a mapped file, see String::FromRegion.
+    /// The region counts its references atomically whatever the RefCountPolicy of those strings and is deleted with the last one.
+    /// </summary>
+    class MappedRegion
+    {
+    public:
+        MappedRegion(const void* data, uint64_t size) noexcept : refCount_(1), data_(data), size_(size)
+        {
+        }
+
+        MappedRegion(const MappedRegion&) = delete;
+        MappedRegion& operator=(const MappedRegion&) = delete;
+
+        const void* Data() const noexcept
+        {
+            return data_;
+        }
+        /// <summary>
+        /// Count of bytes.
+        /// </summary>
+        uint64_t Size() const noexcept
+        {
+            return size_;
+        }
+
+        void AddRef() noexcept
+        {
+            refCount_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Release() noexcept
+        {
+            if (refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+        }
+
+    protected:
+        // deleted by Release only
+        virtual ~MappedRegion() = default;
+
+    private:
+        std::atomic_uint32_t refCount_;
+        const void* data_;
+        uint64_t size_;
+    };
+    /// <summary>
+    /// Hands out blocks by bumping a pointer through chunks of growing size, blocks are never freed one by one but all at once
+    /// by Release(), Reset() or the destructor. Everything allocated from the arena must be gone by then.
+    /// An arena is not thread-safe, strings allocating from it should stay on the thread which owns it.
+    /// </summary>
+    class MonotonicArena : public MemoryResource
+    {
+    public:
+        explicit MonotonicArena(size_t initialChunkSize = 4096) noexcept
+            : chunks_(nullptr), cursor_(0), end_(0), initialChunkSize_(initialChunkSize), nextChunkSize_(initialChunkSize)
+        {
+        }
+
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+        ~MonotonicArena() override
+        {
+            Release();
+        }
+
+        void* Allocate(size_t size, size_t alignment) override
+        {
+            uintptr_t block = (cursor_ + alignment - 1) & ~uintptr_t(alignment - 1);
+            if (block < cursor_ || block > end_ || end_ - block < size)
+            {
+                AddChunk(size + alignment);
+                block = (cursor_ + alignment - 1) & ~uintptr_t(alignment - 1);
+            }
+            cursor_ = block + size;
+            return reinterpret_cast<void*>(block);
+        }
+
+        void Deallocate(void*, size_t, size_t) noexcept override
+        {
+        }
+        /// <summary>
+        /// Free every block at once.
+        /// </summary>
+        void Release() noexcept
+        {
+            while (chunks_)
+            {
+                Chunk* next = chunks_->next;
+                ::operator delete(chunks_);
+                chunks_ = next;
+            }
+            cursor_ = end_ = 0;
+            nextChunkSize_ = initialChunkSize_;
+        }
+        /// <summary>
+        /// Free every block at once but keep the largest chunk, so an arena reused for one request after another stops allocating.
+        /// </summary>
+        void Reset() noexcept
+        {
+            if (!chunks_) return;
+            // an oversized block may have been given a chunk of its own after a larger one
+            Chunk** link = &chunks_;
+            for (Chunk** p = &chunks_->next; *p; p = &(*p)->next)
+            {
+                if ((*p)->size > (*link)->size) link = p;
+            }
+            Chunk* largest = *link;
+            *link = largest->next;
+            const size_t nextChunkSize = nextChunkSize_;
+            Release();
+            nextChunkSize_ = nextChunkSize;
+            largest->next = nullptr;
+            chunks_ = largest;
+            cursor_ = reinterpret_cast<uintptr_t>(largest + 1);
+            end_ = cursor_ + largest->size;
+        }
+
+    private:
+        struct Chunk
+        {
+            Chunk* next;
+            size_t size; // bytes after the chunk header
+        };
+
+        void AddChunk(size_t minSize)
+        {
+            if (minSize > size_t(-1) - sizeof(Chunk))
+            {
+                throw Exception(L"The block is too large!");
+            }
+            size_t size = nextChunkSize_ > minSize + sizeof(Chunk) ? nextChunkSize_ : minSize + sizeof(Chunk);
+            Chunk* chunk = static_cast<Chunk*>(::operator new(size));
+            chunk->next = chunks_;
+            chunk->size = size - sizeof(Chunk);
+            chunks_ = chunk;
+            cursor_ = reinterpret_cast<uintptr_t>(chunk + 1);
+            end_ = reinterpret_cast<uintptr_t>(chunk) + size;
+            if (nextChunkSize_ <= (size_t(-1) >> 2)) nextChunkSize_ *= 2;
+        }
 
-}
\ No newline at end of file
+        Chunk* chunks_;
+        uintptr_t cursor_;
+        uintptr_t end_;
+        size_t initialChunkSize_;
+        size_t nextChunkSize_;
+    };
+}
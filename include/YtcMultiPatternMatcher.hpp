@@ -0,0 +1,373 @@
+#pragma once
+
+#include "YtcString.hpp"
+#include "YtcCollection.hpp"
+#include "YtcStringBuilder.hpp"
+
+namespace Ytc
+{
+    /// <summary>
+    /// Finds occurrences of many patterns in a single pass over a string (Aho-Corasick).
+    /// The automaton is compiled into a flat transition table indexed by state row and character class, the characters
+    /// which occur in no pattern share one class so the rows stay narrow.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class MultiPatternMatcher
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = String<T>::InvalidIndex;
+
+        struct Match
+        {
+            uint32_t patternIndex;
+            uint32_t position;
+        };
+        /// <summary>
+        /// Compile the automaton, empty patterns never match.
+        /// </summary>
+        /// <param name="patterns">the patterns, a match reports the index into this list</param>
+        /// <param name="ignoreCase">fold ASCII letters while matching</param>
+        explicit MultiPatternMatcher(const List<String<T>>& patterns, bool ignoreCase = false)
+            : patterns_(patterns), ignoreCase_(ignoreCase)
+        {
+            BuildAlphabet();
+            BuildTrie();
+            BuildTransitions();
+        }
+
+        uint32_t PatternCount() const noexcept
+        {
+            return patterns_.Count();
+        }
+
+        const String<T>& Pattern(uint32_t index) const
+        {
+            return patterns_[index];
+        }
+        /// <summary>
+        /// Find every occurrence of every pattern, including overlapping ones.
+        /// </summary>
+        /// <returns>matches ordered by their end position</returns>
+        List<Match> FindAll(const T* buffer, uint32_t length) const
+        {
+            List<Match> matches;
+            Scan(buffer, length, [&](uint32_t patternIndex, uint32_t end)
+            {
+                matches.Add(Match{ patternIndex, end - patterns_[patternIndex].Length() });
+                return true;
+            });
+            return matches;
+        }
+
+        List<Match> FindAll(const String<T>& value) const
+        {
+            return FindAll(value.Buffer(), value.Length());
+        }
+        /// <summary>
+        /// Find the match which ends first, the scan stops there. Among the patterns ending at the same position the longest one is reported.
+        /// </summary>
+        /// <returns>the match, its patternIndex is InvalidIndex if nothing matches</returns>
+        Match FindFirst(const T* buffer, uint32_t length) const noexcept
+        {
+            Match first = { InvalidIndex, InvalidIndex };
+            Scan(buffer, length, [&](uint32_t patternIndex, uint32_t end)
+            {
+                first.patternIndex = patternIndex;
+                first.position = end - patterns_[patternIndex].Length();
+                return false;
+            });
+            return first;
+        }
+
+        Match FindFirst(const String<T>& value) const noexcept
+        {
+            return FindFirst(value.Buffer(), value.Length());
+        }
+
+        bool Contains(const String<T>& value) const noexcept
+        {
+            return FindFirst(value).patternIndex != InvalidIndex;
+        }
+        /// <summary>
+        /// Visit every occurrence of every pattern without collecting them, onMatch(patternIndex, end) returns false to
+        /// stop the scan.
+        /// </summary>
+        template<typename Function>
+        void ForEachMatch(const T* buffer, uint32_t length, Function&& onMatch) const
+        {
+            Scan(buffer, length, std::forward<Function>(onMatch));
+        }
+        /// <summary>
+        /// Replace every pattern by its replacement in one pass. Matches do not overlap: the one starting first wins, then the
+        /// longest one starting there; the text of a replacement is not searched again. The result is written into a buffer
+        /// of its final length.
+        /// </summary>
+        /// <param name="replacements">one per pattern, in the same order</param>
+        /// <returns>a new string instance</returns>
+        String<T> ReplaceAll(StringView<T> value, const List<String<T>>& replacements) const
+        {
+            if (replacements.Count() != patterns_.Count())
+            {
+                throw Exception(L"There must be one replacement per pattern!");
+            }
+            const T* buffer = value.Buffer();
+            const uint32_t length = value.Length();
+            List<Match> matches;
+            uint64_t resultLength = length;
+            FindLeftmostLongest(buffer, length, [&](const Match& match)
+            {
+                matches.Add(match);
+                resultLength += replacements[match.patternIndex].Length();
+                resultLength -= patterns_[match.patternIndex].Length();
+            });
+            if (resultLength >= String<T>::MaxSize) throw Exception(L"The string is too long!");
+            StringBuilder<T> builder(static_cast<uint32_t>(resultLength));
+            uint32_t start = 0;
+            for (uint32_t i = 0; i < matches.Count(); ++i)
+            {
+                const Match& match = matches[i];
+                builder.Append(buffer + start, match.position - start);
+                builder.Append(replacements[match.patternIndex]);
+                start = match.position + patterns_[match.patternIndex].Length();
+            }
+            builder.Append(buffer + start, length - start);
+            return builder.ToString();
+        }
+
+    private:
+        using Unit = Simd::Unit<T>;
+        static constexpr uint32_t ByteClassCount = 256;
+        static constexpr uint32_t OutputFlag = 1u << 31;
+        static constexpr uint32_t RowMask = OutputFlag - 1;
+
+        static Unit Fold(Unit c, bool ignoreCase) noexcept
+        {
+            return ignoreCase && c >= 'A' && c <= 'Z' ? static_cast<Unit>(c + ('a' - 'A')) : c;
+        }
+
+        uint32_t ClassOf(T c) const noexcept
+        {
+            const Unit unit = static_cast<Unit>(c);
+            if (unit < ByteClassCount) return byteClasses_[unit];
+            uint32_t low = 0, high = wideUnits_.Count();
+            while (low < high)
+            {
+                uint32_t middle = (low + high) / 2;
+                if (wideUnits_[middle] < unit) low = middle + 1;
+                else high = middle;
+            }
+            return low < wideUnits_.Count() && wideUnits_[low] == unit ? wideClasses_[low] : 0;
+        }
+
+        void BuildAlphabet()
+        {
+            for (uint32_t i = 0; i < ByteClassCount; ++i) byteClasses_[i] = 0;
+            classCount_ = 1;
+            List<Unit> wideUnits;
+            for (uint32_t p = 0; p < patterns_.Count(); ++p)
+            {
+                const String<T>& pattern = patterns_[p];
+                for (uint32_t i = 0; i < pattern.Length(); ++i)
+                {
+                    const Unit unit = Fold(static_cast<Unit>(pattern.Buffer()[i]), ignoreCase_);
+                    if (unit < ByteClassCount)
+                    {
+                        if (!byteClasses_[unit]) byteClasses_[unit] = classCount_++;
+                    }
+                    else if (!wideUnits.Contains(unit))
+                    {
+                        wideUnits.Add(unit);
+                    }
+                }
+            }
+            if (ignoreCase_)
+            {
+                for (Unit c = 'a'; c <= 'z'; ++c) byteClasses_[c - ('a' - 'A')] = byteClasses_[c];
+            }
+            // kept sorted for the binary search in ClassOf
+            for (uint32_t i = 0; i < wideUnits.Count(); ++i)
+            {
+                Unit unit = wideUnits[i];
+                uint32_t pos = 0;
+                while (pos < wideUnits_.Count() && wideUnits_[pos] < unit) ++pos;
+                wideUnits_.Insert(pos, unit);
+            }
+            for (uint32_t i = 0; i < wideUnits_.Count(); ++i)
+            {
+                wideClasses_.Add(classCount_++);
+            }
+        }
+
+        uint32_t AddState()
+        {
+            const uint32_t state = output_.Count();
+            if (transitions_.Count() + classCount_ > RowMask)
+            {
+                throw Exception(L"Too many patterns for the automaton!");
+            }
+            for (uint32_t c = 0; c < classCount_; ++c) transitions_.Add(0);
+            output_.Add(InvalidIndex);
+            outputLink_.Add(InvalidIndex);
+            return state;
+        }
+
+        void BuildTrie()
+        {
+            maxLength_ = 0;
+            AddState();
+            for (uint32_t p = 0; p < patterns_.Count(); ++p) patternLink_.Add(InvalidIndex);
+            // inserted backward so the patterns sharing a final state are chained by ascending index
+            for (uint32_t p = patterns_.Count(); p-- != 0;)
+            {
+                const String<T>& pattern = patterns_[p];
+                if (pattern.IsEmpty()) continue;
+                uint32_t state = 0;
+                for (uint32_t i = 0; i < pattern.Length(); ++i)
+                {
+                    const uint32_t slot = state * classCount_ + ClassOf(pattern.Buffer()[i]);
+                    if (!transitions_[slot])
+                    {
+                        const uint32_t next = AddState();
+                        transitions_[slot] = next;
+                    }
+                    state = transitions_[slot];
+                }
+                patternLink_[p] = output_[state];
+                output_[state] = p;
+                if (pattern.Length() > maxLength_) maxLength_ = pattern.Length();
+            }
+        }
+        /// <summary>
+        /// Turn the trie into a complete automaton by resolving failure links breadth first, then encode
+        /// every transition as the target row offset tagged with OutputFlag when the target reports a match.
+        /// </summary>
+        void BuildTransitions()
+        {
+            const uint32_t stateCount = output_.Count();
+            List<uint32_t> failure;
+            List<uint32_t> queue;
+            for (uint32_t s = 0; s < stateCount; ++s) failure.Add(0);
+            for (uint32_t c = 0; c < classCount_; ++c)
+            {
+                uint32_t child = transitions_[c];
+                if (child) queue.Add(child);
+            }
+            for (uint32_t head = 0; head < queue.Count(); ++head)
+            {
+                const uint32_t state = queue[head];
+                const uint32_t fail = failure[state];
+                outputLink_[state] = output_[fail] != InvalidIndex ? fail : outputLink_[fail];
+                for (uint32_t c = 0; c < classCount_; ++c)
+                {
+                    uint32_t& edge = transitions_[state * classCount_ + c];
+                    const uint32_t fallback = transitions_[fail * classCount_ + c];
+                    if (edge)
+                    {
+                        failure[edge] = fallback;
+                        queue.Add(edge);
+                    }
+                    else
+                    {
+                        edge = fallback;
+                    }
+                }
+            }
+            for (uint32_t i = 0; i < transitions_.Count(); ++i)
+            {
+                const uint32_t target = transitions_[i];
+                const bool reports = output_[target] != InvalidIndex || outputLink_[target] != InvalidIndex;
+                transitions_[i] = target * classCount_ | (reports ? OutputFlag : 0);
+            }
+        }
+        /// <summary>
+        /// Report the matches which do not overlap, the one starting first wins and then the longest one starting there.
+        /// The automaton runs once over the text: the longest match seen so far at each position is kept in a ring as wide as
+        /// the longest pattern, and the match at the next free position is taken once no later character could end one
+        /// starting there.
+        /// </summary>
+        template<typename Function>
+        void FindLeftmostLongest(const T* buffer, uint32_t length, Function&& onMatch) const
+        {
+            if (output_.Count() == 1) return;
+            uint32_t ringSize = 1;
+            while (ringSize < maxLength_) ringSize <<= 1;
+            const uint32_t ringMask = ringSize - 1;
+            List<uint32_t> longest;
+            for (uint32_t i = 0; i < ringSize; ++i) longest.Add(InvalidIndex);
+            const uint32_t* transitions = &transitions_[0];
+            uint32_t row = 0, start = 0;
+            for (uint32_t i = 0;; ++i)
+            {
+                // a match starting at start ends before start + maxLength_
+                while (start < i && (i == length || i - start >= maxLength_))
+                {
+                    const uint32_t p = longest[start & ringMask];
+                    if (p == InvalidIndex)
+                    {
+                        ++start;
+                        continue;
+                    }
+                    onMatch(Match{ p, start });
+                    const uint32_t end = start + patterns_[p].Length();
+                    for (; start < end; ++start) longest[start & ringMask] = InvalidIndex;
+                }
+                if (i == length) break;
+                const uint32_t entry = transitions[row + ClassOf(buffer[i])];
+                row = entry & RowMask;
+                if (!(entry & OutputFlag)) continue;
+                for (uint32_t state = row / classCount_; state != InvalidIndex; state = outputLink_[state])
+                {
+                    // the patterns of a state are equal, the first one has the lowest index
+                    const uint32_t p = output_[state];
+                    if (p == InvalidIndex) continue;
+                    const uint32_t position = i + 1 - patterns_[p].Length();
+                    if (position < start) continue;
+                    uint32_t& slot = longest[position & ringMask];
+                    if (slot == InvalidIndex || patterns_[p].Length() > patterns_[slot].Length()) slot = p;
+                }
+            }
+        }
+
+        /// <summary>
+        /// Run the automaton, onMatch(patternIndex, end) returns false to stop the scan.
+        /// </summary>
+        template<typename Function>
+        void Scan(const T* buffer, uint32_t length, Function&& onMatch) const
+        {
+            if (output_.Count() == 1) return;
+            const uint32_t* transitions = &transitions_[0];
+            uint32_t row = 0;
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                const uint32_t entry = transitions[row + ClassOf(buffer[i])];
+                row = entry & RowMask;
+                if (entry & OutputFlag)
+                {
+                    for (uint32_t state = row / classCount_; state != InvalidIndex; state = outputLink_[state])
+                    {
+                        for (uint32_t p = output_[state]; p != InvalidIndex; p = patternLink_[p])
+                        {
+                            if (!onMatch(p, i + 1)) return;
+                        }
+                    }
+                }
+            }
+        }
+
+        List<String<T>> patterns_;
+        bool ignoreCase_;
+        uint32_t classCount_;
+        uint32_t maxLength_;
+        uint32_t byteClasses_[ByteClassCount];
+        List<Unit> wideUnits_;
+        List<uint32_t> wideClasses_;
+        List<uint32_t> transitions_;
+        List<uint32_t> output_;
+        List<uint32_t> outputLink_;
+        List<uint32_t> patternLink_;
+    };
+
+    template<typename T>
+    constexpr uint32_t MultiPatternMatcher<T>::InvalidIndex;
+}
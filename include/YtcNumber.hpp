@@ -0,0 +1,711 @@
+#pragma once
+
+#include "YtcHash.hpp"
+
+#include <clocale>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+
+namespace Ytc
+{
+    /// <summary>
+    /// Conversions between numbers and decimal text which String::From and String::TryParse are built on.
+    /// Nothing allocates except the rare parse of a double which needs the exact algorithm of strtod.
+    /// </summary>
+    namespace Number
+    {
+        // -9223372036854775808 or 18446744073709551615
+        constexpr uint32_t MaxIntegerLength = 20;
+        // -0.0000012345678901234567 or -1.2345678901234567e-308
+        constexpr uint32_t MaxDoubleLength = 25;
+
+        inline const char* DigitPairs() noexcept
+        {
+            static const char pairs[201] =
+                "00010203040506070809"
+                "10111213141516171819"
+                "20212223242526272829"
+                "30313233343536373839"
+                "40414243444546474849"
+                "50515253545556575859"
+                "60616263646566676869"
+                "70717273747576777879"
+                "80818283848586878889"
+                "90919293949596979899";
+            return pairs;
+        }
+
+        inline uint32_t CountDigits(uint64_t value) noexcept
+        {
+            uint32_t count = 1;
+            for (;;)
+            {
+                if (value < 10) return count;
+                if (value < 100) return count + 1;
+                if (value < 1000) return count + 2;
+                if (value < 10000) return count + 3;
+                value /= 10000;
+                count += 4;
+            }
+        }
+        /// <summary>
+        /// Write the decimal digits of a value backward, two at a time, so that the last one lands just before end.
+        /// </summary>
+        template<typename T>
+        inline void WriteDigits(uint64_t value, T* end) noexcept
+        {
+            const char* pairs = DigitPairs();
+            while (value >= 100)
+            {
+                const uint32_t pair = static_cast<uint32_t>(value % 100) * 2;
+                value /= 100;
+                *--end = T(pairs[pair + 1]);
+                *--end = T(pairs[pair]);
+            }
+            if (value >= 10)
+            {
+                *--end = T(pairs[value * 2 + 1]);
+                *--end = T(pairs[value * 2]);
+            }
+            else
+            {
+                *--end = T('0' + value);
+            }
+        }
+
+        template<typename T>
+        inline uint32_t FormatUnsigned(uint64_t value, T* dest) noexcept
+        {
+            const uint32_t length = CountDigits(value);
+            WriteDigits(value, dest + length);
+            return length;
+        }
+
+        template<typename T>
+        inline uint32_t FormatSigned(int64_t value, T* dest) noexcept
+        {
+            if (value >= 0) return FormatUnsigned(static_cast<uint64_t>(value), dest);
+            *dest = T('-');
+            return 1 + FormatUnsigned(0 - static_cast<uint64_t>(value), dest + 1);
+        }
+        /// <summary>
+        /// A floating-point number with a 64-bit significand and a binary exponent, the working type of Grisu.
+        /// </summary>
+        struct DiyFp
+        {
+            static constexpr int SignificandSize = 52;
+            static constexpr int ExponentBias = 0x3FF + SignificandSize;
+            static constexpr uint64_t HiddenBit = uint64_t(1) << SignificandSize;
+            static constexpr uint64_t SignificandMask = HiddenBit - 1;
+
+            uint64_t f;
+            int e;
+
+            DiyFp(uint64_t significand, int exponent) noexcept : f(significand), e(exponent)
+            {
+            }
+            /// <summary>
+            /// The exact value of a positive finite double.
+            /// </summary>
+            explicit DiyFp(double value) noexcept
+            {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                const int biased = static_cast<int>((bits >> SignificandSize) & 0x7FF);
+                f = bits & SignificandMask;
+                if (biased)
+                {
+                    f += HiddenBit;
+                    e = biased - ExponentBias;
+                }
+                else
+                {
+                    e = 1 - ExponentBias;
+                }
+            }
+
+            DiyFp operator-(const DiyFp& other) const noexcept
+            {
+                return DiyFp(f - other.f, e);
+            }
+            // the high half of the product, rounded
+            DiyFp operator*(const DiyFp& other) const noexcept
+            {
+                uint64_t low = f, high = other.f;
+                Hash::Multiply(low, high);
+                return DiyFp(high + (low >> 63), e + other.e + 64);
+            }
+
+            DiyFp Normalize() const noexcept
+            {
+                DiyFp result = *this;
+                while (!(result.f & (uint64_t(1) << 63)))
+                {
+                    result.f <<= 1;
+                    --result.e;
+                }
+                return result;
+            }
+            /// <summary>
+            /// The bounds of the values which round to this one, normalized to the same exponent.
+            /// </summary>
+            void NormalizedBoundaries(DiyFp& minus, DiyFp& plus) const noexcept
+            {
+                plus = DiyFp((f << 1) + 1, e - 1).Normalize();
+                // the gap below a power of two is half the gap above it
+                minus = f == HiddenBit ? DiyFp((f << 2) - 1, e - 2) : DiyFp((f << 1) - 1, e - 1);
+                minus.f <<= minus.e - plus.e;
+                minus.e = plus.e;
+            }
+        };
+        /// <summary>
+        /// The normalized power of ten 10^(8 * index - 348).
+        /// </summary>
+        inline DiyFp CachedPowerAt(uint32_t index) noexcept
+        {
+            // 10^-348, 10^-340, ..., 10^340
+            static const uint64_t significands[87] =
+            {
+                0xFA8FD5A0081C0288ull, 0xBAAEE17FA23EBF76ull, 0x8B16FB203055AC76ull, 0xCF42894A5DCE35EAull,
+                0x9A6BB0AA55653B2Dull, 0xE61ACF033D1A45DFull, 0xAB70FE17C79AC6CAull, 0xFF77B1FCBEBCDC4Full,
+                0xBE5691EF416BD60Cull, 0x8DD01FAD907FFC3Cull, 0xD3515C2831559A83ull, 0x9D71AC8FADA6C9B5ull,
+                0xEA9C227723EE8BCBull, 0xAECC49914078536Dull, 0x823C12795DB6CE57ull, 0xC21094364DFB5637ull,
+                0x9096EA6F3848984Full, 0xD77485CB25823AC7ull, 0xA086CFCD97BF97F4ull, 0xEF340A98172AACE5ull,
+                0xB23867FB2A35B28Eull, 0x84C8D4DFD2C63F3Bull, 0xC5DD44271AD3CDBAull, 0x936B9FCEBB25C996ull,
+                0xDBAC6C247D62A584ull, 0xA3AB66580D5FDAF6ull, 0xF3E2F893DEC3F126ull, 0xB5B5ADA8AAFF80B8ull,
+                0x87625F056C7C4A8Bull, 0xC9BCFF6034C13053ull, 0x964E858C91BA2655ull, 0xDFF9772470297EBDull,
+                0xA6DFBD9FB8E5B88Full, 0xF8A95FCF88747D94ull, 0xB94470938FA89BCFull, 0x8A08F0F8BF0F156Bull,
+                0xCDB02555653131B6ull, 0x993FE2C6D07B7FACull, 0xE45C10C42A2B3B06ull, 0xAA242499697392D3ull,
+                0xFD87B5F28300CA0Eull, 0xBCE5086492111AEBull, 0x8CBCCC096F5088CCull, 0xD1B71758E219652Cull,
+                0x9C40000000000000ull, 0xE8D4A51000000000ull, 0xAD78EBC5AC620000ull, 0x813F3978F8940984ull,
+                0xC097CE7BC90715B3ull, 0x8F7E32CE7BEA5C70ull, 0xD5D238A4ABE98068ull, 0x9F4F2726179A2245ull,
+                0xED63A231D4C4FB27ull, 0xB0DE65388CC8ADA8ull, 0x83C7088E1AAB65DBull, 0xC45D1DF942711D9Aull,
+                0x924D692CA61BE758ull, 0xDA01EE641A708DEAull, 0xA26DA3999AEF774Aull, 0xF209787BB47D6B85ull,
+                0xB454E4A179DD1877ull, 0x865B86925B9BC5C2ull, 0xC83553C5C8965D3Dull, 0x952AB45CFA97A0B3ull,
+                0xDE469FBD99A05FE3ull, 0xA59BC234DB398C25ull, 0xF6C69A72A3989F5Cull, 0xB7DCBF5354E9BECEull,
+                0x88FCF317F22241E2ull, 0xCC20CE9BD35C78A5ull, 0x98165AF37B2153DFull, 0xE2A0B5DC971F303Aull,
+                0xA8D9D1535CE3B396ull, 0xFB9B7CD9A4A7443Cull, 0xBB764C4CA7A44410ull, 0x8BAB8EEFB6409C1Aull,
+                0xD01FEF10A657842Cull, 0x9B10A4E5E9913129ull, 0xE7109BFBA19C0C9Dull, 0xAC2820D9623BF429ull,
+                0x80444B5E7AA7CF85ull, 0xBF21E44003ACDD2Dull, 0x8E679C2F5E44FF8Full, 0xD433179D9C8CB841ull,
+                0x9E19DB92B4E31BA9ull, 0xEB96BF6EBADF77D9ull, 0xAF87023B9BF0EE6Bull,
+            };
+            static const int16_t exponents[87] =
+            {
+                -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+                -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+                -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+                -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+                -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+                109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+                375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+                641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+                907, 933, 960, 986, 1013, 1039, 1066,
+            };
+            return DiyFp(significands[index], exponents[index]);
+        }
+        /// <summary>
+        /// The normalized power of ten 10^-k which brings a binary exponent e into the range Grisu needs.
+        /// </summary>
+        inline DiyFp CachedPower(int e, int& k) noexcept
+        {
+            const double dk = (-61 - e) * 0.30102999566398114 + 347;
+            int ceiling = static_cast<int>(dk);
+            if (dk - ceiling > 0.0) ++ceiling;
+            const uint32_t index = static_cast<uint32_t>((ceiling >> 3) + 1);
+            k = -(-348 + static_cast<int>(index << 3));
+            return CachedPowerAt(index);
+        }
+
+        inline void GrisuRound(char* digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) noexcept
+        {
+            while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance))
+            {
+                --digits[length - 1];
+                rest += tenKappa;
+            }
+        }
+        /// <summary>
+        /// Generate the digits of the scaled value until they fall within delta of the upper bound.
+        /// </summary>
+        inline void GenerateDigits(const DiyFp& w, const DiyFp& upper, uint64_t delta, char* digits, int& length, int& k) noexcept
+        {
+            static const uint32_t powers[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+            const DiyFp one(uint64_t(1) << -upper.e, upper.e);
+            const DiyFp distance = upper - w;
+            uint32_t integral = static_cast<uint32_t>(upper.f >> -one.e);
+            uint64_t fraction = upper.f & (one.f - 1);
+            int kappa = static_cast<int>(CountDigits(integral));
+            length = 0;
+            while (kappa > 0)
+            {
+                const uint32_t digit = integral / powers[kappa - 1];
+                integral %= powers[kappa - 1];
+                if (digit || length) digits[length++] = static_cast<char>('0' + digit);
+                --kappa;
+                const uint64_t rest = (static_cast<uint64_t>(integral) << -one.e) + fraction;
+                if (rest <= delta)
+                {
+                    k += kappa;
+                    GrisuRound(digits, length, delta, rest, static_cast<uint64_t>(powers[kappa]) << -one.e, distance.f);
+                    return;
+                }
+            }
+            for (;;)
+            {
+                fraction *= 10;
+                delta *= 10;
+                const char digit = static_cast<char>(fraction >> -one.e);
+                if (digit || length) digits[length++] = static_cast<char>('0' + digit);
+                fraction &= one.f - 1;
+                --kappa;
+                if (fraction < delta)
+                {
+                    k += kappa;
+                    GrisuRound(digits, length, delta, fraction, one.f, -kappa < 10 ? distance.f * powers[-kappa] : 0);
+                    return;
+                }
+            }
+        }
+        /// <summary>
+        /// Grisu2 of Florian Loitsch, "Printing floating-point numbers quickly and accurately with integers": the digits of a
+        /// positive finite double such that digits * 10^k reads back as the same double. They are the shortest in all but rare cases.
+        /// </summary>
+        inline void Grisu2(double value, char* digits, int& length, int& k) noexcept
+        {
+            const DiyFp v(value);
+            DiyFp minus(0, 0), plus(0, 0);
+            v.NormalizedBoundaries(minus, plus);
+            const DiyFp power = CachedPower(plus.e, k);
+            const DiyFp w = v.Normalize() * power;
+            DiyFp upper = plus * power;
+            DiyFp lower = minus * power;
+            ++lower.f;
+            --upper.f;
+            GenerateDigits(w, upper, upper.f - lower.f, digits, length, k);
+        }
+
+        template<typename T>
+        inline uint32_t CopyAscii(const char* text, T* dest) noexcept
+        {
+            uint32_t length = 0;
+            for (; text[length]; ++length) dest[length] = T(text[length]);
+            return length;
+        }
+        /// <summary>
+        /// Format a double with the Grisu2 digits, which read back as the same value and are the shortest in all but rare
+        /// cases, in the notation of JavaScript:
+        /// plain digits while the decimal exponent is within [-7, 21), otherwise d.ddde+x. NaN and Infinity are spelled out.
+        /// </summary>
+        /// <param name="dest">room for MaxDoubleLength characters, no terminator is written</param>
+        /// <returns>count of characters written</returns>
+        template<typename T>
+        inline uint32_t FormatDouble(double value, T* dest) noexcept
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            if ((bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull && (bits & DiyFp::SignificandMask)) return CopyAscii("NaN", dest);
+            T* p = dest;
+            if (bits >> 63)
+            {
+                *p++ = T('-');
+                value = -value;
+            }
+            if ((bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull) return static_cast<uint32_t>(p - dest) + CopyAscii("Infinity", p);
+            if (!(bits << 1))
+            {
+                *p++ = T('0');
+                return static_cast<uint32_t>(p - dest);
+            }
+            char digits[24];
+            int length = 0, k = 0;
+            Grisu2(value, digits, length, k);
+            // the value is 0.digits * 10^point
+            const int point = length + k;
+            if (length <= point && point <= 21)
+            {
+                for (int i = 0; i < length; ++i) *p++ = T(digits[i]);
+                for (int i = length; i < point; ++i) *p++ = T('0');
+            }
+            else if (0 < point && point <= 21)
+            {
+                for (int i = 0; i < point; ++i) *p++ = T(digits[i]);
+                *p++ = T('.');
+                for (int i = point; i < length; ++i) *p++ = T(digits[i]);
+            }
+            else if (-6 < point && point <= 0)
+            {
+                *p++ = T('0');
+                *p++ = T('.');
+                for (int i = point; i < 0; ++i) *p++ = T('0');
+                for (int i = 0; i < length; ++i) *p++ = T(digits[i]);
+            }
+            else
+            {
+                *p++ = T(digits[0]);
+                if (length > 1)
+                {
+                    *p++ = T('.');
+                    for (int i = 1; i < length; ++i) *p++ = T(digits[i]);
+                }
+                *p++ = T('e');
+                const int exponent = point - 1;
+                *p++ = T(exponent < 0 ? '-' : '+');
+                p += FormatUnsigned(static_cast<uint64_t>(exponent < 0 ? -exponent : exponent), p);
+            }
+            return static_cast<uint32_t>(p - dest);
+        }
+
+        // printf's %.*f, with the decimal point of the C locale whatever the current one is
+        inline uint32_t SnprintfFixed(double value, int precision, char* dest, uint32_t capacity) noexcept
+        {
+            const int length = snprintf(dest, capacity, "%.*f", precision, value);
+            if (length <= 0) return 0;
+            const char point = *std::localeconv()->decimal_point;
+            if (point != '.')
+            {
+                char* found = static_cast<char*>(std::memchr(dest, point, static_cast<size_t>(length)));
+                if (found) *found = '.';
+            }
+            return static_cast<uint32_t>(length);
+        }
+
+        /// <summary>
+        /// Format a double with exactly precision digits after the point, as printf's %.*f does. Values below 2^53 with a
+        /// precision of at most 19 are rounded exactly, half to even, from the 128-bit product of their significand and a
+        /// power of ten; the others go through snprintf.
+        /// </summary>
+        /// <param name="dest">room for 320 + precision characters, a terminator is written</param>
+        /// <returns>count of characters written, without the terminator</returns>
+        inline uint32_t FormatFixed(double value, int precision, char* dest, uint32_t capacity) noexcept
+        {
+            static const uint64_t powers[] = { 1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+                100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+                100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+                1000000000000000000ull, 10000000000000000000ull };
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            const int biased = static_cast<int>((bits >> DiyFp::SignificandSize) & 0x7FF);
+            // value = significand * 2^-shift, and integers from 2^53 on have no fraction to round
+            const uint64_t significand = biased ? (bits & DiyFp::SignificandMask) | DiyFp::HiddenBit : bits & DiyFp::SignificandMask;
+            const int shift = DiyFp::ExponentBias - (biased ? biased : 1);
+            if (precision < 0 || precision > 19 || shift <= 0 || capacity < 22 + static_cast<uint32_t>(precision))
+            {
+                return SnprintfFixed(value, precision, dest, capacity);
+            }
+            uint64_t low = significand, high = powers[precision];
+            Hash::Multiply(low, high);
+            // the product split into a quotient and a remainder compared with half of 2^shift
+            uint64_t quotient = 0;
+            bool fits = true, above = false, tie = false;
+            if (shift < 64)
+            {
+                const uint64_t remainder = low & ((uint64_t(1) << shift) - 1), half = uint64_t(1) << (shift - 1);
+                fits = !(high >> shift);
+                quotient = (low >> shift) | (high << (64 - shift));
+                above = remainder > half;
+                tie = remainder == half;
+            }
+            else if (shift == 64)
+            {
+                quotient = high;
+                above = low > (uint64_t(1) << 63);
+                tie = low == (uint64_t(1) << 63);
+            }
+            else if (shift < 128)
+            {
+                const uint64_t remainder = high & ((uint64_t(1) << (shift - 64)) - 1), half = uint64_t(1) << (shift - 65);
+                quotient = high >> (shift - 64);
+                above = remainder > half || (remainder == half && low);
+                tie = remainder == half && !low;
+            }
+            if (above || (tie && (quotient & 1))) fits = fits && ++quotient;
+            if (!fits)
+            {
+                return SnprintfFixed(value, precision, dest, capacity);
+            }
+            char* p = dest;
+            if (bits >> 63) *p++ = '-';
+            p += FormatUnsigned(quotient / powers[precision], p);
+            if (precision)
+            {
+                *p++ = '.';
+                std::memset(p, '0', static_cast<size_t>(precision));
+                p += precision;
+                WriteDigits(quotient % powers[precision], p);
+            }
+            *p = '\0';
+            return static_cast<uint32_t>(p - dest);
+        }
+
+        /// <summary>
+        /// Round a positive DiyFp with a 53-bit significand to a double, subnormal, zero or infinite if need be.
+        /// </summary>
+        inline double ToDouble(DiyFp value) noexcept
+        {
+            constexpr int DenormalExponent = 1 - DiyFp::ExponentBias;
+            constexpr int MaxExponent = 0x7FF - DiyFp::ExponentBias;
+            while (value.f > DiyFp::HiddenBit + DiyFp::SignificandMask)
+            {
+                value.f >>= 1;
+                ++value.e;
+            }
+            if (value.e >= MaxExponent) return std::numeric_limits<double>::infinity();
+            if (value.e < DenormalExponent) return 0.0;
+            while (value.e > DenormalExponent && !(value.f & DiyFp::HiddenBit))
+            {
+                value.f <<= 1;
+                --value.e;
+            }
+            const uint64_t biased = value.e == DenormalExponent && !(value.f & DiyFp::HiddenBit) ? 0 : static_cast<uint64_t>(value.e + DiyFp::ExponentBias);
+            const uint64_t bits = (value.f & DiyFp::SignificandMask) | (biased << DiyFp::SignificandSize);
+            double result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+        /// <summary>
+        /// The double nearest to mantissa * 10^exponent computed with 64-bit products by a cached power of ten, as the DiyFp
+        /// method of double-conversion does; the error of the products is bounded in eighths of their last bit.
+        /// </summary>
+        /// <param name="digits">count of decimal digits of the mantissa</param>
+        /// <param name="truncated">whether nonzero digits were dropped after the mantissa</param>
+        /// <returns>false when the error leaves the rounding undecided, then an exact algorithm must be used</returns>
+        inline bool ScaleByPowerOfTen(uint64_t mantissa, int exponent, int digits, bool truncated, double& value) noexcept
+        {
+            constexpr int DenominatorLog = 3;
+            constexpr int Denominator = 1 << DenominatorLog;
+            // 10^1 to 10^7 exactly
+            static const uint64_t adjustments[] =
+            {
+                0, 0xA000000000000000ull, 0xC800000000000000ull, 0xFA00000000000000ull,
+                0x9C40000000000000ull, 0xC350000000000000ull, 0xF424000000000000ull, 0x9896800000000000ull
+            };
+            static const int adjustmentExponents[] = { 0, -60, -57, -54, -50, -47, -44, -40 };
+            DiyFp input = DiyFp(mantissa, 0).Normalize();
+            // a truncated mantissa has 19 digits, the shift is small
+            int error = truncated ? Denominator << -input.e : 0;
+            const uint32_t index = static_cast<uint32_t>(exponent + 348) / 8;
+            const int adjustment = exponent + 348 - static_cast<int>(index * 8);
+            if (adjustment)
+            {
+                input = input * DiyFp(adjustments[adjustment], adjustmentExponents[adjustment]);
+                // the product is exact while it fits 64 bits
+                if (19 - digits < adjustment) error += Denominator / 2;
+            }
+            input = input * CachedPowerAt(index);
+            error += Denominator / 2 + (error ? 1 : 0) + Denominator / 2;
+            const int before = input.e;
+            input = input.Normalize();
+            error <<= before - input.e;
+
+            const int magnitude = 64 + input.e;
+            constexpr int DenormalExponent = 1 - DiyFp::ExponentBias;
+            const int significandSize = magnitude >= DenormalExponent + 53 ? 53 : magnitude <= DenormalExponent ? 0 : magnitude - DenormalExponent;
+            int precision = 64 - significandSize;
+            if (precision + DenominatorLog >= 64)
+            {
+                const int shift = precision + DenominatorLog - 64 + 1;
+                input.f >>= shift;
+                input.e += shift;
+                error = (error >> shift) + 1 + Denominator;
+                precision -= shift;
+            }
+            const uint64_t bits = (input.f & ((uint64_t(1) << precision) - 1)) * Denominator;
+            const uint64_t halfWay = (uint64_t(1) << (precision - 1)) * Denominator;
+            DiyFp rounded(input.f >> precision, input.e + precision);
+            if (bits >= halfWay + error) ++rounded.f;
+            value = ToDouble(rounded);
+            return bits <= halfWay - error || bits >= halfWay + error;
+        }
+
+        template<typename T>
+        inline bool IsDigit(T c) noexcept
+        {
+            return static_cast<uint32_t>(c) - '0' < 10;
+        }
+        /// <summary>
+        /// Parse decimal digits with an optional plus sign, the whole text must be consumed.
+        /// </summary>
+        /// <returns>false if the text is not a number or the number is larger than uint64_t</returns>
+        template<typename T>
+        inline bool ParseInteger(const T* text, uint32_t length, uint64_t& value) noexcept
+        {
+            const T* p = text;
+            const T* end = text + length;
+            if (p != end && *p == T('+')) ++p;
+            if (p == end) return false;
+            uint64_t result = 0;
+            // 19 digits never overflow
+            const T* safeEnd = end - p > 19 ? p + 19 : end;
+            for (; p != safeEnd; ++p)
+            {
+                if (!IsDigit(*p)) return false;
+                result = result * 10 + static_cast<uint32_t>(*p - T('0'));
+            }
+            for (; p != end; ++p)
+            {
+                if (!IsDigit(*p)) return false;
+                const uint32_t digit = static_cast<uint32_t>(*p - T('0'));
+                if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10) return false;
+                result = result * 10 + digit;
+            }
+            value = result;
+            return true;
+        }
+
+        /// <summary>
+        /// Parse decimal digits with an optional sign, the whole text must be consumed.
+        /// </summary>
+        template<typename T>
+        inline bool ParseInteger(const T* text, uint32_t length, int64_t& value) noexcept
+        {
+            const bool negative = length && *text == T('-');
+            uint64_t magnitude;
+            if (negative)
+            {
+                if (length < 2 || text[1] == T('+') || !ParseInteger(text + 1, length - 1, magnitude)) return false;
+            }
+            else if (!ParseInteger(text, length, magnitude))
+            {
+                return false;
+            }
+            const uint64_t limit = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + negative;
+            if (magnitude > limit) return false;
+            value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+            return true;
+        }
+
+        template<typename T>
+        inline bool MatchAscii(const T* text, const T* end, const char* word) noexcept
+        {
+            for (; *word; ++word, ++text)
+            {
+                if (text == end || *text != T(*word)) return false;
+            }
+            return text == end;
+        }
+        /// <summary>
+        /// Parse [sign] digits [. digits] [e [sign] digits], or NaN and Infinity as FormatDouble writes them; the whole text
+        /// must be consumed and the result is correctly rounded. A mantissa of at most 53 bits scaled by at most 10^22 is
+        /// computed exactly with one operation (Clinger's fast path), other numbers with ScaleByPowerOfTen, and the few
+        /// it cannot decide with strtod.
+        /// </summary>
+        template<typename T>
+        inline bool ParseDouble(const T* text, uint32_t length, double& value) noexcept
+        {
+            static const double powers[] =
+            {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+            };
+            const T* p = text;
+            const T* end = text + length;
+            const bool negative = p != end && *p == T('-');
+            if (p != end && (*p == T('-') || *p == T('+'))) ++p;
+            if (MatchAscii(p, end, "NaN"))
+            {
+                value = std::numeric_limits<double>::quiet_NaN();
+                return true;
+            }
+            if (MatchAscii(p, end, "Infinity"))
+            {
+                value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+                return true;
+            }
+            uint64_t mantissa = 0;
+            int significant = 0;
+            int exponent = 0;
+            bool truncated = false;
+            uint32_t digits = 0;
+            for (; p != end && IsDigit(*p); ++p, ++digits)
+            {
+                const uint32_t digit = static_cast<uint32_t>(*p - T('0'));
+                if (significant < 19)
+                {
+                    mantissa = mantissa * 10 + digit;
+                    if (mantissa) ++significant;
+                }
+                else
+                {
+                    ++exponent;
+                    truncated |= digit != 0;
+                }
+            }
+            if (p != end && *p == T('.'))
+            {
+                for (++p; p != end && IsDigit(*p); ++p, ++digits)
+                {
+                    const uint32_t digit = static_cast<uint32_t>(*p - T('0'));
+                    if (significant < 19)
+                    {
+                        mantissa = mantissa * 10 + digit;
+                        if (mantissa) ++significant;
+                        --exponent;
+                    }
+                    else
+                    {
+                        truncated |= digit != 0;
+                    }
+                }
+            }
+            if (!digits) return false;
+            if (p != end && (*p == T('e') || *p == T('E')))
+            {
+                ++p;
+                const bool negativeExponent = p != end && *p == T('-');
+                if (p != end && (*p == T('-') || *p == T('+'))) ++p;
+                if (p == end) return false;
+                int explicitExponent = 0;
+                for (; p != end && IsDigit(*p); ++p)
+                {
+                    // beyond any double either way, further digits do not matter
+                    if (explicitExponent < 100000) explicitExponent = explicitExponent * 10 + static_cast<int>(*p - T('0'));
+                }
+                exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            }
+            if (p != end) return false;
+            if (!truncated && mantissa <= (uint64_t(1) << 53) && -22 <= exponent && exponent <= 22)
+            {
+                double result = static_cast<double>(mantissa);
+                result = exponent < 0 ? result / powers[-exponent] : result * powers[exponent];
+                value = negative ? -result : result;
+                return true;
+            }
+            double result = 0.0;
+            if (!mantissa || significant + exponent <= -324)
+            {
+                value = negative ? -result : result;
+                return true;
+            }
+            if (significant + exponent > 309)
+            {
+                value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+                return true;
+            }
+            if (ScaleByPowerOfTen(mantissa, exponent, significant, truncated, result))
+            {
+                value = negative ? -result : result;
+                return true;
+            }
+            // strtod wants a terminated narrow copy with the decimal point of the current locale
+            char local[64];
+            std::unique_ptr<char[]> heap;
+            char* copy = local;
+            if (length >= sizeof(local))
+            {
+                heap.reset(new (std::nothrow) char[length + 1]);
+                if (!heap) return false;
+                copy = heap.get();
+            }
+            const char point = *std::localeconv()->decimal_point;
+            for (uint32_t i = 0; i < length; ++i) copy[i] = text[i] == T('.') ? point : static_cast<char>(text[i]);
+            copy[length] = 0;
+            value = std::strtod(copy, nullptr);
+            return true;
+        }
+    }
+}
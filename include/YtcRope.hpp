@@ -0,0 +1,424 @@
+#pragma once
+
+#include "YtcString.hpp"
+#include "YtcStringBuilder.hpp"
+#include "YtcCollection.hpp"
+
+#include <iterator>
+
+namespace Ytc
+{
+    /// <summary>
+    /// A large text edited in the middle without moving the rest of it: a balanced tree of pieces, each a slice of an immutable
+    /// String. Slicing a piece shares the buffer of its string, so inserting a long string or cutting one never copies characters.
+    /// The tree is a treap whose nodes are never modified once built: Insert, Remove and SubString rebuild only the O(log n)
+    /// nodes on their path, so copies of a rope and ropes cut from it share the rest. Expected cost is O(log n) per operation.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class Rope
+    {
+    private:
+        struct Node;
+        using NodeRef = Ref<const Node>;
+
+    public:
+        static constexpr uint32_t MaxSize = String<T>::MaxSize;
+        /// <summary>
+        /// Small inserts next to a piece shorter than this are copied into it, so typing does not leave a piece per character.
+        /// </summary>
+        static constexpr uint32_t CoalesceLength = 512;
+        /// <summary>
+        /// Walks the pieces in order, each one a view of the characters it shares with a string; nothing is copied.
+        /// It must not outlive the rope nor be used after the rope is modified.
+        /// </summary>
+        class ChunkIterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = StringView<T>;
+            using difference_type = ptrdiff_t;
+            using pointer = const StringView<T>*;
+            using reference = const StringView<T>&;
+
+            ChunkIterator() noexcept
+            {
+            }
+
+            explicit ChunkIterator(const Node* root)
+            {
+                PushLeftSpine(root);
+                Load();
+            }
+
+            const StringView<T>& operator*() const noexcept
+            {
+                return chunk_;
+            }
+
+            const StringView<T>* operator->() const noexcept
+            {
+                return &chunk_;
+            }
+
+            ChunkIterator& operator++()
+            {
+                const Node* node = path_[path_.Count() - 1];
+                path_.RemoveAt(static_cast<int>(path_.Count()) - 1);
+                PushLeftSpine(node->right.get());
+                Load();
+                return *this;
+            }
+
+            ChunkIterator operator++(int)
+            {
+                ChunkIterator old = *this;
+                ++*this;
+                return old;
+            }
+            // the next node to visit tells apart two positions of one walk, the end has none
+            friend bool operator==(const ChunkIterator& lhs, const ChunkIterator& rhs) noexcept
+            {
+                return lhs.Top() == rhs.Top();
+            }
+
+            friend bool operator!=(const ChunkIterator& lhs, const ChunkIterator& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+        private:
+            void PushLeftSpine(const Node* node)
+            {
+                for (; node; node = node->left.get()) path_.Add(node);
+            }
+
+            void Load() noexcept
+            {
+                const Node* node = Top();
+                chunk_ = node ? node->Piece() : StringView<T>();
+            }
+
+            const Node* Top() const noexcept
+            {
+                return path_.Count() ? path_[path_.Count() - 1] : nullptr;
+            }
+
+            // nodes whose piece is not visited yet, the next one on top
+            List<const Node*> path_;
+            StringView<T> chunk_;
+        };
+
+        struct Chunks
+        {
+            ChunkIterator begin() const
+            {
+                return ChunkIterator(root);
+            }
+
+            ChunkIterator end() const noexcept
+            {
+                return ChunkIterator();
+            }
+
+            const Node* root;
+        };
+
+        Rope() noexcept : seed_(DefaultSeed)
+        {
+        }
+        /// <summary>
+        /// A rope of one piece, the characters of a long string are shared and not copied.
+        /// </summary>
+        explicit Rope(const String<T>& text) : seed_(DefaultSeed)
+        {
+            if (!text.IsEmpty()) root_ = MakeNode(text, 0, text.Length(), NextPriority(), nullptr, nullptr);
+        }
+
+        uint32_t Length() const noexcept
+        {
+            return Total(root_);
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return !root_;
+        }
+        /// <summary>
+        /// The character at a position, found by descending the tree.
+        /// </summary>
+        T At(uint32_t index) const
+        {
+            if (index >= Length()) throw Exception(L"The argument<index> is out of range!");
+            const Node* node = root_.get();
+            for (;;)
+            {
+                const uint32_t leftLength = Total(node->left);
+                if (index < leftLength)
+                {
+                    node = node->left.get();
+                }
+                else if (index - leftLength < node->length)
+                {
+                    return node->text.Buffer()[node->offset + index - leftLength];
+                }
+                else
+                {
+                    index -= leftLength + node->length;
+                    node = node->right.get();
+                }
+            }
+        }
+
+        T operator[](uint32_t index) const
+        {
+            return At(index);
+        }
+        /// <summary>
+        /// Insert a string before a position, the characters of a long string are shared and not copied.
+        /// </summary>
+        /// <param name="start">The position, it may equal the length to append.</param>
+        Rope& Insert(uint32_t start, const String<T>& text)
+        {
+            if (start > Length()) throw Exception(L"The argument<start> is out of range!");
+            CheckGrowth(text.Length());
+            if (text.IsEmpty()) return *this;
+            NodeRef left, right;
+            Split(root_, start, left, right);
+            NodeRef coalesced;
+            if (left && text.Length() < CoalesceLength && AppendToLast(left, text, coalesced))
+            {
+                root_ = Merge(coalesced, right);
+            }
+            else
+            {
+                root_ = Merge(Merge(left, MakeNode(text, 0, text.Length(), NextPriority(), nullptr, nullptr)), right);
+            }
+            return *this;
+        }
+        /// <summary>
+        /// Insert another rope before a position, its nodes are shared.
+        /// </summary>
+        Rope& Insert(uint32_t start, const Rope& text)
+        {
+            if (start > Length()) throw Exception(L"The argument<start> is out of range!");
+            CheckGrowth(text.Length());
+            NodeRef left, right;
+            Split(root_, start, left, right);
+            root_ = Merge(Merge(left, text.root_), right);
+            return *this;
+        }
+
+        Rope& Append(const String<T>& text)
+        {
+            return Insert(Length(), text);
+        }
+
+        Rope& Append(const Rope& text)
+        {
+            return Insert(Length(), text);
+        }
+        /// <summary>
+        /// Delete a specified number of characters beginning at a specified position, the pieces on either side are sliced and not copied.
+        /// </summary>
+        Rope& Remove(uint32_t start, uint32_t count)
+        {
+            if (start >= Length() || uint64_t(start) + count > Length())
+            {
+                throw Exception(L"The argument is out of range for this instance!");
+            }
+            NodeRef left, middle, right;
+            Split(root_, start, left, middle);
+            Split(middle, count, middle, right);
+            root_ = Merge(left, right);
+            return *this;
+        }
+        /// <summary>
+        /// Retrieves a part of this rope, which shares the nodes and the characters of this one.
+        /// </summary>
+        /// <param name="start">The zero-based starting character position.</param>
+        /// <param name="length">The number of characters.</param>
+        Rope SubString(uint32_t start, uint32_t length = MaxSize) const
+        {
+            if (start >= Length()) throw Exception(L"The argument<start> is out of range!");
+            const uint32_t maxLength = Length() - start;
+            NodeRef left, middle, right;
+            Split(root_, start, left, middle);
+            Split(middle, length < maxLength ? length : maxLength, middle, right);
+            Rope result;
+            result.root_ = middle;
+            result.seed_ = seed_ ^ start;
+            return result;
+        }
+        /// <summary>
+        /// The pieces in order as views, for output without flattening: for (StringView&lt;T&gt; chunk : rope.GetChunks()).
+        /// </summary>
+        Chunks GetChunks() const noexcept
+        {
+            return Chunks{ root_.get() };
+        }
+
+        uint32_t ChunkCount() const noexcept
+        {
+            return root_ ? root_->count : 0;
+        }
+        /// <summary>
+        /// Copy the characters into one string, a rope of a single whole string returns that string which shares its buffer.
+        /// </summary>
+        String<T> Flatten() const
+        {
+            if (!root_) return String<T>();
+            if (root_->count == 1 && root_->offset == 0 && root_->length == root_->text.Length()) return root_->text;
+            StringBuilder<T> builder(Length());
+            for (StringView<T> chunk : GetChunks()) builder.Append(chunk);
+            return builder.ToString();
+        }
+
+    private:
+        static constexpr uint32_t DefaultSeed = 0x9E3779B9u;
+
+        struct Node
+        {
+            Node(const String<T>& text, uint32_t offset, uint32_t length, uint32_t priority, const NodeRef& left, const NodeRef& right)
+                : text(text), offset(offset), length(length), priority(priority), left(left), right(right),
+                total(Total(left) + length + Total(right)), count(Count(left) + 1 + Count(right))
+            {
+            }
+
+            StringView<T> Piece() const
+            {
+                return StringView<T>(text.Buffer() + offset, length);
+            }
+
+            String<T> text;
+            uint32_t offset;
+            uint32_t length;
+            uint32_t priority;
+            NodeRef left;
+            NodeRef right;
+            // characters and pieces of the subtree
+            uint32_t total;
+            uint32_t count;
+        };
+
+        static uint32_t Total(const NodeRef& node) noexcept
+        {
+            return node ? node->total : 0;
+        }
+
+        static uint32_t Count(const NodeRef& node) noexcept
+        {
+            return node ? node->count : 0;
+        }
+
+        static NodeRef MakeNode(const String<T>& text, uint32_t offset, uint32_t length, uint32_t priority, const NodeRef& left, const NodeRef& right)
+        {
+            return MakeRef<const Node>(text, offset, length, priority, left, right);
+        }
+
+        static NodeRef WithChildren(const Node& node, const NodeRef& left, const NodeRef& right)
+        {
+            return MakeNode(node.text, node.offset, node.length, node.priority, left, right);
+        }
+
+        void CheckGrowth(uint32_t extraLength) const
+        {
+            if (uint64_t(Length()) + extraLength >= MaxSize) throw Exception(L"The string is too long!");
+        }
+        /// <summary>
+        /// Xorshift, the priorities keep the treap balanced in expectation whatever the order of the edits.
+        /// </summary>
+        uint32_t NextPriority() noexcept
+        {
+            seed_ ^= seed_ << 13;
+            seed_ ^= seed_ >> 17;
+            seed_ ^= seed_ << 5;
+            return seed_;
+        }
+        /// <summary>
+        /// The finalizer of MurmurHash3, a piece cut in two derives the priority of its second half from where it is cut.
+        /// </summary>
+        static uint32_t Mix(uint32_t value) noexcept
+        {
+            value ^= value >> 16;
+            value *= 0x85EBCA6Bu;
+            value ^= value >> 13;
+            value *= 0xC2B2AE35u;
+            value ^= value >> 16;
+            return value;
+        }
+        /// <summary>
+        /// Split a tree into its first position characters and the rest, a piece across the position is sliced in two.
+        /// The tree is taken by value since it may be one of the outputs.
+        /// </summary>
+        static void Split(NodeRef node, uint32_t position, NodeRef& left, NodeRef& right)
+        {
+            if (!node)
+            {
+                left = nullptr;
+                right = nullptr;
+                return;
+            }
+            const uint32_t leftLength = Total(node->left);
+            if (position <= leftLength)
+            {
+                NodeRef rest;
+                Split(node->left, position, left, rest);
+                right = WithChildren(*node, rest, node->right);
+            }
+            else if (position >= leftLength + node->length)
+            {
+                NodeRef rest;
+                Split(node->right, position - leftLength - node->length, rest, right);
+                left = WithChildren(*node, node->left, rest);
+            }
+            else
+            {
+                // the left half keeps the place of the piece, the right one gets a priority of its own, otherwise the pieces
+                // cut out of one string would all tie and the tree would degenerate into a list
+                const uint32_t cut = position - leftLength;
+                left = MakeNode(node->text, node->offset, cut, node->priority, node->left, nullptr);
+                const uint32_t priority = Mix(node->priority ^ (node->offset + cut));
+                right = Merge(MakeNode(node->text, node->offset + cut, node->length - cut, priority, nullptr, nullptr), node->right);
+            }
+        }
+
+        static NodeRef Merge(const NodeRef& left, const NodeRef& right)
+        {
+            if (!left) return right;
+            if (!right) return left;
+            if (left->priority > right->priority) return WithChildren(*left, left->left, Merge(left->right, right));
+            return WithChildren(*right, Merge(left, right->left), right->right);
+        }
+        /// <summary>
+        /// Rebuild the last piece of a tree with a short text appended, if that piece is short too.
+        /// </summary>
+        /// <returns>false if the last piece is too long</returns>
+        static bool AppendToLast(const NodeRef& node, const String<T>& text, NodeRef& result)
+        {
+            if (node->right)
+            {
+                NodeRef right;
+                if (!AppendToLast(node->right, text, right)) return false;
+                result = WithChildren(*node, node->left, right);
+                return true;
+            }
+            if (node->length + text.Length() > CoalesceLength) return false;
+            StringBuilder<T> builder(node->length + text.Length());
+            builder.Append(node->Piece());
+            builder.Append(text);
+            const String<T> joined = builder.ToString();
+            result = MakeNode(joined, 0, joined.Length(), node->priority, node->left, nullptr);
+            return true;
+        }
+
+        NodeRef root_;
+        uint32_t seed_;
+    };
+
+    template<typename T>
+    constexpr uint32_t Rope<T>::MaxSize;
+
+    template<typename T>
+    constexpr uint32_t Rope<T>::CoalesceLength;
+}
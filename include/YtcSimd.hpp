@@ -0,0 +1,995 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define YTC_SIMD_X86 1
+#include <immintrin.h>
+#ifndef _MSC_VER
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(_MSC_VER) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define YTC_LITTLE_ENDIAN 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define YTC_TARGET_SSE2
+#define YTC_TARGET_AVX2
+#else
+#define YTC_TARGET_SSE2 __attribute__((target("sse2")))
+#define YTC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace Ytc
+{
+    namespace Simd
+    {
+        constexpr uint32_t NotFound = uint32_t(-1);
+
+        /// <summary>
+        /// Instruction set extensions detected on the running processor.
+        /// </summary>
+        struct CpuFeatures
+        {
+            bool sse2;
+            bool avx2;
+
+            static const CpuFeatures& Current() noexcept
+            {
+                static const CpuFeatures features = Detect();
+                return features;
+            }
+
+        private:
+            static CpuFeatures Detect() noexcept
+            {
+                CpuFeatures features = { false, false };
+#ifdef YTC_SIMD_X86
+                uint32_t regs[4] = { 0, 0, 0, 0 };
+                CpuId(0, regs);
+                const uint32_t maxLeaf = regs[0];
+                if (maxLeaf < 1) return features;
+                CpuId(1, regs);
+                features.sse2 = (regs[3] & (1u << 26)) != 0;
+                const bool osxsave = (regs[2] & (1u << 27)) != 0;
+                const bool avx = (regs[2] & (1u << 28)) != 0;
+                if (maxLeaf >= 7 && osxsave && avx && (ReadXcr0() & 0x6) == 0x6)
+                {
+                    CpuId(7, regs);
+                    features.avx2 = (regs[1] & (1u << 5)) != 0;
+                }
+#endif
+                return features;
+            }
+
+#ifdef YTC_SIMD_X86
+            static void CpuId(uint32_t leaf, uint32_t regs[4]) noexcept
+            {
+#ifdef _MSC_VER
+                int info[4];
+                __cpuidex(info, static_cast<int>(leaf), 0);
+                for (int i = 0; i < 4; ++i) regs[i] = static_cast<uint32_t>(info[i]);
+#else
+                __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+            }
+
+            static uint64_t ReadXcr0() noexcept
+            {
+#ifdef _MSC_VER
+                return _xgetbv(0);
+#else
+                uint32_t eax, edx;
+                __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+                return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+            }
+#endif
+        };
+
+        /// <summary>
+        /// Index of the lowest set bit, the mask must not be zero.
+        /// </summary>
+        inline uint32_t LowestBit(uint32_t mask) noexcept
+        {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        /// <summary>
+        /// Index of the highest set bit, the mask must not be zero.
+        /// </summary>
+        inline uint32_t HighestBit(uint32_t mask) noexcept
+        {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanReverse(&index, mask);
+            return index;
+#else
+            return 31 - __builtin_clz(mask);
+#endif
+        }
+
+        /// <summary>
+        /// Index of the lowest set bit of a 64-bit mask, the mask must not be zero.
+        /// </summary>
+        inline uint32_t LowestBit64(uint64_t mask) noexcept
+        {
+            const uint32_t low = static_cast<uint32_t>(mask);
+            return low ? LowestBit(low) : 32 + LowestBit(static_cast<uint32_t>(mask >> 32));
+        }
+
+        template<size_t Size> struct UnitOf;
+        template<> struct UnitOf<1> { using Type = uint8_t; };
+        template<> struct UnitOf<2> { using Type = uint16_t; };
+        template<> struct UnitOf<4> { using Type = uint32_t; };
+
+        /// <summary>
+        /// Reinterpret a character type as the unsigned integer of the same width, which picks the vector lane size.
+        /// </summary>
+        template<typename T>
+        using Unit = typename UnitOf<sizeof(T)>::Type;
+
+        template<typename T>
+        inline uint32_t FindCharScalar(const T* buffer, uint32_t length, T c) noexcept
+        {
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                if (buffer[i] == c) return i;
+            }
+            return NotFound;
+        }
+
+        template<typename T>
+        inline uint32_t FindLastCharScalar(const T* buffer, uint32_t length, T c) noexcept
+        {
+            for (uint32_t i = length - 1; i != NotFound; --i)
+            {
+                if (buffer[i] == c) return i;
+            }
+            return NotFound;
+        }
+
+        template<typename T>
+        inline uint32_t FindAnyCharScalar(const T* buffer, uint32_t length, const T* set, uint32_t setLength) noexcept
+        {
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                for (uint32_t k = 0; k < setLength; ++k)
+                {
+                    if (buffer[i] == set[k]) return i;
+                }
+            }
+            return NotFound;
+        }
+
+        /// <summary>
+        /// The sign of the result orders two characters as their values, character types narrower than int give the difference itself.
+        /// </summary>
+        template<typename T>
+        inline int Difference(T a, T b) noexcept
+        {
+            return sizeof(T) < sizeof(int) ? int(a) - int(b) : (a > b) - (a < b);
+        }
+
+        template<typename T>
+        inline uint32_t MismatchScalar(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            uint32_t i = 0;
+            constexpr uint32_t WordLanes = sizeof(uint64_t) / sizeof(T);
+            for (; i + WordLanes <= count; i += WordLanes)
+            {
+                uint64_t word1, word2;
+                memcpy(&word1, s1 + i, sizeof(word1));
+                memcpy(&word2, s2 + i, sizeof(word2));
+                if (word1 != word2)
+                {
+#ifdef YTC_LITTLE_ENDIAN
+                    return i + LowestBit64(word1 ^ word2) / (8 * sizeof(T));
+#else
+                    break;
+#endif
+                }
+            }
+            for (; i < count; ++i)
+            {
+                if (s1[i] != s2[i]) return i;
+            }
+            return NotFound;
+        }
+
+        /// <summary>
+        /// Whether a character lies in [first, first + 26), that is an ASCII letter of the case starting at first.
+        /// </summary>
+        template<typename T>
+        inline bool IsAsciiLetter(T c, T first) noexcept
+        {
+            return static_cast<Unit<T>>(c - first) < 26;
+        }
+
+        template<typename T>
+        inline T ToLowerAscii(T c) noexcept
+        {
+            return IsAsciiLetter(c, T('A')) ? T(c ^ 0x20) : c;
+        }
+
+        template<typename T>
+        inline T* ChangeCaseScalar(const T* source, uint32_t length, T* dest, T first) noexcept
+        {
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                const T c = source[i];
+                dest[i] = IsAsciiLetter(c, first) ? T(c ^ 0x20) : c;
+            }
+            return dest + length;
+        }
+
+        template<typename T>
+        inline T* ReplaceCharScalar(const T* source, uint32_t length, T* dest, T oldChar, T newChar) noexcept
+        {
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                const T c = source[i];
+                dest[i] = c == oldChar ? newChar : c;
+            }
+            return dest + length;
+        }
+
+        template<typename T>
+        inline uint32_t MismatchIgnoreCaseScalar(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                if (ToLowerAscii(s1[i]) != ToLowerAscii(s2[i])) return i;
+            }
+            return NotFound;
+        }
+
+        template<typename T>
+        inline uint32_t FindIgnoreCaseScalar(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t start) noexcept
+        {
+            const T first = ToLowerAscii(needle[0]);
+            for (uint32_t i = start; i + needleLength <= length; ++i)
+            {
+                if (ToLowerAscii(haystack[i]) == first && MismatchIgnoreCaseScalar(haystack + i + 1, needle + 1, needleLength - 1) == NotFound) return i;
+            }
+            return NotFound;
+        }
+
+#ifdef YTC_SIMD_X86
+        YTC_TARGET_SSE2 inline __m128i Broadcast128(uint8_t c) noexcept { return _mm_set1_epi8(static_cast<char>(c)); }
+        YTC_TARGET_SSE2 inline __m128i Broadcast128(uint16_t c) noexcept { return _mm_set1_epi16(static_cast<short>(c)); }
+        YTC_TARGET_SSE2 inline __m128i Broadcast128(uint32_t c) noexcept { return _mm_set1_epi32(static_cast<int>(c)); }
+        YTC_TARGET_SSE2 inline __m128i CompareEqual128(__m128i a, __m128i b, uint8_t) noexcept { return _mm_cmpeq_epi8(a, b); }
+        YTC_TARGET_SSE2 inline __m128i CompareEqual128(__m128i a, __m128i b, uint16_t) noexcept { return _mm_cmpeq_epi16(a, b); }
+        YTC_TARGET_SSE2 inline __m128i CompareEqual128(__m128i a, __m128i b, uint32_t) noexcept { return _mm_cmpeq_epi32(a, b); }
+
+        YTC_TARGET_SSE2 inline __m128i Add128(__m128i a, __m128i b, uint8_t) noexcept { return _mm_add_epi8(a, b); }
+        YTC_TARGET_SSE2 inline __m128i Add128(__m128i a, __m128i b, uint16_t) noexcept { return _mm_add_epi16(a, b); }
+        YTC_TARGET_SSE2 inline __m128i Add128(__m128i a, __m128i b, uint32_t) noexcept { return _mm_add_epi32(a, b); }
+        YTC_TARGET_SSE2 inline __m128i CompareGreater128(__m128i a, __m128i b, uint8_t) noexcept { return _mm_cmpgt_epi8(a, b); }
+        YTC_TARGET_SSE2 inline __m128i CompareGreater128(__m128i a, __m128i b, uint16_t) noexcept { return _mm_cmpgt_epi16(a, b); }
+        YTC_TARGET_SSE2 inline __m128i CompareGreater128(__m128i a, __m128i b, uint32_t) noexcept { return _mm_cmpgt_epi32(a, b); }
+
+        YTC_TARGET_AVX2 inline __m256i Broadcast256(uint8_t c) noexcept { return _mm256_set1_epi8(static_cast<char>(c)); }
+        YTC_TARGET_AVX2 inline __m256i Broadcast256(uint16_t c) noexcept { return _mm256_set1_epi16(static_cast<short>(c)); }
+        YTC_TARGET_AVX2 inline __m256i Broadcast256(uint32_t c) noexcept { return _mm256_set1_epi32(static_cast<int>(c)); }
+        YTC_TARGET_AVX2 inline __m256i CompareEqual256(__m256i a, __m256i b, uint8_t) noexcept { return _mm256_cmpeq_epi8(a, b); }
+        YTC_TARGET_AVX2 inline __m256i CompareEqual256(__m256i a, __m256i b, uint16_t) noexcept { return _mm256_cmpeq_epi16(a, b); }
+        YTC_TARGET_AVX2 inline __m256i CompareEqual256(__m256i a, __m256i b, uint32_t) noexcept { return _mm256_cmpeq_epi32(a, b); }
+
+        YTC_TARGET_AVX2 inline __m256i Add256(__m256i a, __m256i b, uint8_t) noexcept { return _mm256_add_epi8(a, b); }
+        YTC_TARGET_AVX2 inline __m256i Add256(__m256i a, __m256i b, uint16_t) noexcept { return _mm256_add_epi16(a, b); }
+        YTC_TARGET_AVX2 inline __m256i Add256(__m256i a, __m256i b, uint32_t) noexcept { return _mm256_add_epi32(a, b); }
+        YTC_TARGET_AVX2 inline __m256i CompareGreater256(__m256i a, __m256i b, uint8_t) noexcept { return _mm256_cmpgt_epi8(a, b); }
+        YTC_TARGET_AVX2 inline __m256i CompareGreater256(__m256i a, __m256i b, uint16_t) noexcept { return _mm256_cmpgt_epi16(a, b); }
+        YTC_TARGET_AVX2 inline __m256i CompareGreater256(__m256i a, __m256i b, uint32_t) noexcept { return _mm256_cmpgt_epi32(a, b); }
+
+        /// <summary>
+        /// Flips the case of the ASCII letters of one case in a vector: lanes in [first, first + 26) are found by one signed comparison
+        /// after the range is shifted to start at the lowest signed value, then bit 0x20 of them is toggled.
+        /// </summary>
+        template<typename T>
+        struct CaseFolder128
+        {
+            YTC_TARGET_SSE2 explicit CaseFolder128(T first) noexcept
+                : bias(Broadcast128(static_cast<Unit<T>>(SignBit - static_cast<Unit<T>>(first)))),
+                  bound(Broadcast128(static_cast<Unit<T>>(SignBit + 26))),
+                  flip(Broadcast128(static_cast<Unit<T>>(0x20)))
+            {
+            }
+
+            YTC_TARGET_SSE2 __m128i operator()(__m128i chunk) const noexcept
+            {
+                const __m128i letters = CompareGreater128(bound, Add128(chunk, bias, Unit<T>()), Unit<T>());
+                return _mm_xor_si128(chunk, _mm_and_si128(letters, flip));
+            }
+
+            static constexpr Unit<T> SignBit = static_cast<Unit<T>>(Unit<T>(1) << (8 * sizeof(T) - 1));
+            __m128i bias;
+            __m128i bound;
+            __m128i flip;
+        };
+
+        template<typename T>
+        struct CaseFolder256
+        {
+            YTC_TARGET_AVX2 explicit CaseFolder256(T first) noexcept
+                : bias(Broadcast256(static_cast<Unit<T>>(SignBit - static_cast<Unit<T>>(first)))),
+                  bound(Broadcast256(static_cast<Unit<T>>(SignBit + 26))),
+                  flip(Broadcast256(static_cast<Unit<T>>(0x20)))
+            {
+            }
+
+            YTC_TARGET_AVX2 __m256i operator()(__m256i chunk) const noexcept
+            {
+                const __m256i letters = CompareGreater256(bound, Add256(chunk, bias, Unit<T>()), Unit<T>());
+                return _mm256_xor_si256(chunk, _mm256_and_si256(letters, flip));
+            }
+
+            static constexpr Unit<T> SignBit = static_cast<Unit<T>>(Unit<T>(1) << (8 * sizeof(T) - 1));
+            __m256i bias;
+            __m256i bound;
+            __m256i flip;
+        };
+
+        /// <summary>
+        /// Bit mask of the bytes equal to the broadcasted character in 16 bytes starting at ptr.
+        /// </summary>
+        template<typename T>
+        YTC_TARGET_SSE2 inline uint32_t MatchMask128(const T* ptr, __m128i pattern) noexcept
+        {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+            return static_cast<uint32_t>(_mm_movemask_epi8(CompareEqual128(chunk, pattern, Unit<T>())));
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 inline uint32_t MatchMask256(const T* ptr, __m256i pattern) noexcept
+        {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(CompareEqual256(chunk, pattern, Unit<T>())));
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t FindCharSse2(const T* buffer, uint32_t length, T c) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            const __m128i pattern = Broadcast128(static_cast<Unit<T>>(c));
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                uint32_t mask = MatchMask128(buffer + i, pattern);
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = FindCharScalar(buffer + i, length - i, c);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t FindCharAvx2(const T* buffer, uint32_t length, T c) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            const __m256i pattern = Broadcast256(static_cast<Unit<T>>(c));
+            uint32_t i = 0;
+            for (; i + 4 * Lanes <= length; i += 4 * Lanes)
+            {
+                const T* ptr = buffer + i;
+                __m256i eq0 = CompareEqual256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr)), pattern, Unit<T>());
+                __m256i eq1 = CompareEqual256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + Lanes)), pattern, Unit<T>());
+                __m256i eq2 = CompareEqual256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 2 * Lanes)), pattern, Unit<T>());
+                __m256i eq3 = CompareEqual256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + 3 * Lanes)), pattern, Unit<T>());
+                __m256i any = _mm256_or_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq2, eq3));
+                if (_mm256_movemask_epi8(any))
+                {
+                    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq0));
+                    if (mask) return i + LowestBit(mask) / sizeof(T);
+                    mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq1));
+                    if (mask) return i + Lanes + LowestBit(mask) / sizeof(T);
+                    mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq2));
+                    if (mask) return i + 2 * Lanes + LowestBit(mask) / sizeof(T);
+                    mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq3));
+                    return i + 3 * Lanes + LowestBit(mask) / sizeof(T);
+                }
+            }
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                uint32_t mask = MatchMask256(buffer + i, pattern);
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = FindCharScalar(buffer + i, length - i, c);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        /// <summary>
+        /// Most characters of a set searched a vector at a time, every one costs a comparison per vector.
+        /// </summary>
+        constexpr uint32_t AnyCharVectorLimit = 8;
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t FindAnyCharSse2(const T* buffer, uint32_t length, const T* set, uint32_t setLength) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            __m128i patterns[AnyCharVectorLimit];
+            for (uint32_t k = 0; k < setLength; ++k) patterns[k] = Broadcast128(static_cast<Unit<T>>(set[k]));
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+                __m128i eq = CompareEqual128(chunk, patterns[0], Unit<T>());
+                for (uint32_t k = 1; k < setLength; ++k) eq = _mm_or_si128(eq, CompareEqual128(chunk, patterns[k], Unit<T>()));
+                const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = FindAnyCharScalar(buffer + i, length - i, set, setLength);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t FindAnyCharAvx2(const T* buffer, uint32_t length, const T* set, uint32_t setLength) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            __m256i patterns[AnyCharVectorLimit];
+            for (uint32_t k = 0; k < setLength; ++k) patterns[k] = Broadcast256(static_cast<Unit<T>>(set[k]));
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i));
+                __m256i eq = CompareEqual256(chunk, patterns[0], Unit<T>());
+                for (uint32_t k = 1; k < setLength; ++k) eq = _mm256_or_si256(eq, CompareEqual256(chunk, patterns[k], Unit<T>()));
+                const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = FindAnyCharScalar(buffer + i, length - i, set, setLength);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t FindLastCharSse2(const T* buffer, uint32_t length, T c) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            const __m128i pattern = Broadcast128(static_cast<Unit<T>>(c));
+            uint32_t end = length;
+            for (; end >= Lanes; end -= Lanes)
+            {
+                uint32_t mask = MatchMask128(buffer + end - Lanes, pattern);
+                if (mask) return end - Lanes + HighestBit(mask) / sizeof(T);
+            }
+            return FindLastCharScalar(buffer, end, c);
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t FindLastCharAvx2(const T* buffer, uint32_t length, T c) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            const __m256i pattern = Broadcast256(static_cast<Unit<T>>(c));
+            uint32_t end = length;
+            for (; end >= Lanes; end -= Lanes)
+            {
+                uint32_t mask = MatchMask256(buffer + end - Lanes, pattern);
+                if (mask) return end - Lanes + HighestBit(mask) / sizeof(T);
+            }
+            return FindLastCharScalar(buffer, end, c);
+        }
+
+        /// <summary>
+        /// Budget of failed verifications for the first/last character filter before the caller's linear fallback takes over,
+        /// the verification work is kept proportional to the scanned length.
+        /// </summary>
+        inline bool TooManyMisses(uint32_t misses, uint32_t needleLength, uint32_t scanned) noexcept
+        {
+            return static_cast<uint64_t>(misses) * needleLength > 8 * (static_cast<uint64_t>(scanned) + 256);
+        }
+
+        template<typename T>
+        inline bool Equals(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            return memcmp(s1, s2, count * sizeof(T)) == 0;
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t FindNeedleSse2(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            constexpr uint32_t LaneBits = (1u << sizeof(T)) - 1;
+            const uint32_t lastOffset = needleLength - 1;
+            const __m128i first = Broadcast128(static_cast<Unit<T>>(needle[0]));
+            const __m128i last = Broadcast128(static_cast<Unit<T>>(needle[lastOffset]));
+            uint32_t misses = 0;
+            uint32_t i = 0;
+            for (; i + lastOffset + Lanes <= length; i += Lanes)
+            {
+                uint32_t mask = MatchMask128(haystack + i, first) & MatchMask128(haystack + i + lastOffset, last);
+                while (mask)
+                {
+                    const uint32_t bit = LowestBit(mask);
+                    const uint32_t pos = i + bit / sizeof(T);
+                    if (Equals(haystack + pos + 1, needle + 1, needleLength - 2)) return pos;
+                    if (TooManyMisses(++misses, needleLength, i)) break;
+                    mask ^= LaneBits << bit;
+                }
+                if (mask) break;
+            }
+            resume = i;
+            return NotFound;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t FindNeedleAvx2(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            constexpr uint32_t LaneBits = (1u << sizeof(T)) - 1;
+            const uint32_t lastOffset = needleLength - 1;
+            const __m256i first = Broadcast256(static_cast<Unit<T>>(needle[0]));
+            const __m256i last = Broadcast256(static_cast<Unit<T>>(needle[lastOffset]));
+            uint32_t misses = 0;
+            uint32_t i = 0;
+            for (; i + lastOffset + Lanes <= length; i += Lanes)
+            {
+                uint32_t mask = MatchMask256(haystack + i, first) & MatchMask256(haystack + i + lastOffset, last);
+                while (mask)
+                {
+                    const uint32_t bit = LowestBit(mask);
+                    const uint32_t pos = i + bit / sizeof(T);
+                    if (Equals(haystack + pos + 1, needle + 1, needleLength - 2)) return pos;
+                    if (TooManyMisses(++misses, needleLength, i)) break;
+                    mask ^= LaneBits << bit;
+                }
+                if (mask) break;
+            }
+            resume = i;
+            return NotFound;
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t FindLastNeedleSse2(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            constexpr uint32_t LaneBits = (1u << sizeof(T)) - 1;
+            const uint32_t lastOffset = needleLength - 1;
+            const __m128i first = Broadcast128(static_cast<Unit<T>>(needle[0]));
+            const __m128i last = Broadcast128(static_cast<Unit<T>>(needle[lastOffset]));
+            uint32_t misses = 0;
+            uint32_t end = length - lastOffset;
+            for (; end >= Lanes; end -= Lanes)
+            {
+                const uint32_t base = end - Lanes;
+                uint32_t mask = MatchMask128(haystack + base, first) & MatchMask128(haystack + base + lastOffset, last);
+                while (mask)
+                {
+                    const uint32_t lane = HighestBit(mask) / sizeof(T);
+                    const uint32_t pos = base + lane;
+                    if (Equals(haystack + pos + 1, needle + 1, needleLength - 2)) return pos;
+                    if (TooManyMisses(++misses, needleLength, length - end)) break;
+                    mask ^= LaneBits << (lane * sizeof(T));
+                }
+                if (mask) break;
+            }
+            resume = end;
+            return NotFound;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t FindLastNeedleAvx2(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            constexpr uint32_t LaneBits = (1u << sizeof(T)) - 1;
+            const uint32_t lastOffset = needleLength - 1;
+            const __m256i first = Broadcast256(static_cast<Unit<T>>(needle[0]));
+            const __m256i last = Broadcast256(static_cast<Unit<T>>(needle[lastOffset]));
+            uint32_t misses = 0;
+            uint32_t end = length - lastOffset;
+            for (; end >= Lanes; end -= Lanes)
+            {
+                const uint32_t base = end - Lanes;
+                uint32_t mask = MatchMask256(haystack + base, first) & MatchMask256(haystack + base + lastOffset, last);
+                while (mask)
+                {
+                    const uint32_t lane = HighestBit(mask) / sizeof(T);
+                    const uint32_t pos = base + lane;
+                    if (Equals(haystack + pos + 1, needle + 1, needleLength - 2)) return pos;
+                    if (TooManyMisses(++misses, needleLength, length - end)) break;
+                    mask ^= LaneBits << (lane * sizeof(T));
+                }
+                if (mask) break;
+            }
+            resume = end;
+            return NotFound;
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 T* ChangeCaseSse2(const T* source, uint32_t length, T* dest, T first) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            const CaseFolder128<T> fold(first);
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), fold(chunk));
+            }
+            return ChangeCaseScalar(source + i, length - i, dest + i, first);
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 T* ChangeCaseAvx2(const T* source, uint32_t length, T* dest, T first) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            const CaseFolder256<T> fold(first);
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), fold(chunk));
+            }
+            return ChangeCaseScalar(source + i, length - i, dest + i, first);
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 T* ReplaceCharSse2(const T* source, uint32_t length, T* dest, T oldChar, T newChar) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            const __m128i from = Broadcast128(static_cast<Unit<T>>(oldChar));
+            const __m128i to = Broadcast128(static_cast<Unit<T>>(newChar));
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+                const __m128i hit = CompareEqual128(chunk, from, Unit<T>());
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_or_si128(_mm_and_si128(hit, to), _mm_andnot_si128(hit, chunk)));
+            }
+            return ReplaceCharScalar(source + i, length - i, dest + i, oldChar, newChar);
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 T* ReplaceCharAvx2(const T* source, uint32_t length, T* dest, T oldChar, T newChar) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            const __m256i from = Broadcast256(static_cast<Unit<T>>(oldChar));
+            const __m256i to = Broadcast256(static_cast<Unit<T>>(newChar));
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+                const __m256i hit = CompareEqual256(chunk, from, Unit<T>());
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_blendv_epi8(chunk, to, hit));
+            }
+            return ReplaceCharScalar(source + i, length - i, dest + i, oldChar, newChar);
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t MismatchSse2(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            uint32_t i = 0;
+            for (; i + Lanes <= count; i += Lanes)
+            {
+                __m128i chunk1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i));
+                __m128i chunk2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i));
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk1, chunk2))) ^ 0xFFFFu;
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = MismatchScalar(s1 + i, s2 + i, count - i);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t MismatchAvx2(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            uint32_t i = 0;
+            for (; i + 2 * Lanes <= count; i += 2 * Lanes)
+            {
+                __m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i)));
+                __m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i + Lanes)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i + Lanes)));
+                if (static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1))) != 0xFFFFFFFFu)
+                {
+                    uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(eq0));
+                    if (mask) return i + LowestBit(mask) / sizeof(T);
+                    mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(eq1));
+                    return i + Lanes + LowestBit(mask) / sizeof(T);
+                }
+            }
+            for (; i + Lanes <= count; i += Lanes)
+            {
+                uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i)))));
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = MismatchScalar(s1 + i, s2 + i, count - i);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t MismatchIgnoreCaseSse2(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            const CaseFolder128<T> lower(T('A'));
+            uint32_t i = 0;
+            for (; i + Lanes <= count; i += Lanes)
+            {
+                __m128i chunk1 = lower(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)));
+                __m128i chunk2 = lower(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i)));
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(CompareEqual128(chunk1, chunk2, Unit<T>()))) ^ 0xFFFFu;
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = MismatchIgnoreCaseScalar(s1 + i, s2 + i, count - i);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t MismatchIgnoreCaseAvx2(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            const CaseFolder256<T> lower(T('A'));
+            uint32_t i = 0;
+            for (; i + Lanes <= count; i += Lanes)
+            {
+                __m256i chunk1 = lower(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)));
+                __m256i chunk2 = lower(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i)));
+                uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(CompareEqual256(chunk1, chunk2, Unit<T>())));
+                if (mask) return i + LowestBit(mask) / sizeof(T);
+            }
+            uint32_t tail = MismatchIgnoreCaseScalar(s1 + i, s2 + i, count - i);
+            return tail == NotFound ? NotFound : i + tail;
+        }
+
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t FindIgnoreCaseSse2(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            constexpr uint32_t LaneBits = (1u << sizeof(T)) - 1;
+            const uint32_t lastOffset = needleLength - 1;
+            const CaseFolder128<T> lower(T('A'));
+            const __m128i first = Broadcast128(static_cast<Unit<T>>(ToLowerAscii(needle[0])));
+            const __m128i last = Broadcast128(static_cast<Unit<T>>(ToLowerAscii(needle[lastOffset])));
+            uint32_t i = 0;
+            for (; i + lastOffset + Lanes <= length; i += Lanes)
+            {
+                __m128i head = lower(_mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i)));
+                __m128i tail = lower(_mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + lastOffset)));
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(CompareEqual128(head, first, Unit<T>()), CompareEqual128(tail, last, Unit<T>()))));
+                while (mask)
+                {
+                    const uint32_t bit = LowestBit(mask);
+                    const uint32_t pos = i + bit / sizeof(T);
+                    if (MismatchIgnoreCaseSse2(haystack + pos, needle, needleLength) == NotFound) return pos;
+                    mask ^= LaneBits << bit;
+                }
+            }
+            resume = i;
+            return NotFound;
+        }
+
+        template<typename T>
+        YTC_TARGET_AVX2 uint32_t FindIgnoreCaseAvx2(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+            constexpr uint32_t Lanes = 32 / sizeof(T);
+            constexpr uint32_t LaneBits = (1u << sizeof(T)) - 1;
+            const uint32_t lastOffset = needleLength - 1;
+            const CaseFolder256<T> lower(T('A'));
+            const __m256i first = Broadcast256(static_cast<Unit<T>>(ToLowerAscii(needle[0])));
+            const __m256i last = Broadcast256(static_cast<Unit<T>>(ToLowerAscii(needle[lastOffset])));
+            uint32_t i = 0;
+            for (; i + lastOffset + Lanes <= length; i += Lanes)
+            {
+                __m256i head = lower(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i)));
+                __m256i tail = lower(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + lastOffset)));
+                uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(CompareEqual256(head, first, Unit<T>()), CompareEqual256(tail, last, Unit<T>()))));
+                while (mask)
+                {
+                    const uint32_t bit = LowestBit(mask);
+                    const uint32_t pos = i + bit / sizeof(T);
+                    if (MismatchIgnoreCaseAvx2(haystack + pos, needle, needleLength) == NotFound) return pos;
+                    mask ^= LaneBits << bit;
+                }
+            }
+            resume = i;
+            return NotFound;
+        }
+#endif
+
+        /// <summary>
+        /// Find the first occurrence of a character, the widest vector unit supported by the processor is used.
+        /// </summary>
+        /// <param name="buffer">characters to scan</param>
+        /// <param name="length">count of characters</param>
+        /// <param name="c">the character to seek</param>
+        /// <returns>zero-based index, or NotFound</returns>
+        template<typename T>
+        inline uint32_t FindChar(const T* buffer, uint32_t length, T c) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(length) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return FindCharAvx2(buffer, length, c);
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return FindCharSse2(buffer, length, c);
+#endif
+            return FindCharScalar(buffer, length, c);
+        }
+
+        /// <summary>
+        /// Find the first character which is any of a set, sets of up to AnyCharVectorLimit characters are searched a vector at a time.
+        /// </summary>
+        /// <param name="set">the characters to seek</param>
+        /// <param name="setLength">count of characters in the set</param>
+        /// <returns>zero-based index, or NotFound</returns>
+        template<typename T>
+        inline uint32_t FindAnyChar(const T* buffer, uint32_t length, const T* set, uint32_t setLength) noexcept
+        {
+            if (setLength == 1) return FindChar(buffer, length, set[0]);
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(length) * sizeof(T);
+            if (setLength && setLength <= AnyCharVectorLimit)
+            {
+                if (bytes >= 32 && CpuFeatures::Current().avx2) return FindAnyCharAvx2(buffer, length, set, setLength);
+                if (bytes >= 16 && CpuFeatures::Current().sse2) return FindAnyCharSse2(buffer, length, set, setLength);
+            }
+#endif
+            return FindAnyCharScalar(buffer, length, set, setLength);
+        }
+
+        /// <summary>
+        /// Find the last occurrence of a character, the widest vector unit supported by the processor is used.
+        /// </summary>
+        /// <param name="buffer">characters to scan</param>
+        /// <param name="length">count of characters</param>
+        /// <param name="c">the character to seek</param>
+        /// <returns>zero-based index, or NotFound</returns>
+        template<typename T>
+        inline uint32_t FindLastChar(const T* buffer, uint32_t length, T c) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(length) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return FindLastCharAvx2(buffer, length, c);
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return FindLastCharSse2(buffer, length, c);
+#endif
+            return FindLastCharScalar(buffer, length, c);
+        }
+
+        /// <summary>
+        /// Find the first occurrence of a needle of at least two characters by testing its first and last characters a vector at a time.
+        /// It stops early when candidates keep failing verification or the rest of the haystack is shorter than a vector,
+        /// so the caller must finish the search from resume with a linear algorithm.
+        /// </summary>
+        /// <param name="resume">receives the first window start not examined yet</param>
+        /// <returns>zero-based index, or NotFound if no match starts before resume</returns>
+        template<typename T>
+        inline uint32_t FindNeedle(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            if (CpuFeatures::Current().avx2) return FindNeedleAvx2(haystack, length, needle, needleLength, resume);
+            if (CpuFeatures::Current().sse2) return FindNeedleSse2(haystack, length, needle, needleLength, resume);
+#endif
+            resume = 0;
+            return NotFound;
+        }
+
+        /// <summary>
+        /// Find the last occurrence of a needle of at least two characters, scanning backward a vector at a time.
+        /// </summary>
+        /// <param name="resume">receives the count of leading window starts not examined yet</param>
+        /// <returns>zero-based index, or NotFound if no match starts at or after resume</returns>
+        template<typename T>
+        inline uint32_t FindLastNeedle(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength, uint32_t& resume) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            if (CpuFeatures::Current().avx2) return FindLastNeedleAvx2(haystack, length, needle, needleLength, resume);
+            if (CpuFeatures::Current().sse2) return FindLastNeedleSse2(haystack, length, needle, needleLength, resume);
+#endif
+            resume = length - needleLength + 1;
+            return NotFound;
+        }
+
+        /// <summary>
+        /// Copy characters converting the ASCII lowercase letters to uppercase, other characters are copied unchanged.
+        /// The destination may be the source itself, otherwise they must not overlap.
+        /// </summary>
+        /// <returns>the end of the destination</returns>
+        template<typename T>
+        inline T* ToUpperAscii(const T* source, uint32_t length, T* dest) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(length) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return ChangeCaseAvx2(source, length, dest, T('a'));
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return ChangeCaseSse2(source, length, dest, T('a'));
+#endif
+            return ChangeCaseScalar(source, length, dest, T('a'));
+        }
+
+        /// <summary>
+        /// Copy characters converting the ASCII uppercase letters to lowercase, other characters are copied unchanged.
+        /// The destination may be the source itself, otherwise they must not overlap.
+        /// </summary>
+        /// <returns>the end of the destination</returns>
+        template<typename T>
+        inline T* ToLowerAscii(const T* source, uint32_t length, T* dest) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(length) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return ChangeCaseAvx2(source, length, dest, T('A'));
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return ChangeCaseSse2(source, length, dest, T('A'));
+#endif
+            return ChangeCaseScalar(source, length, dest, T('A'));
+        }
+
+        /// <summary>
+        /// Copy characters replacing every occurrence of one character by another.
+        /// The destination may be the source itself, otherwise they must not overlap.
+        /// </summary>
+        /// <returns>the end of the destination</returns>
+        template<typename T>
+        inline T* ReplaceChar(const T* source, uint32_t length, T* dest, T oldChar, T newChar) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(length) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return ReplaceCharAvx2(source, length, dest, oldChar, newChar);
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return ReplaceCharSse2(source, length, dest, oldChar, newChar);
+#endif
+            return ReplaceCharScalar(source, length, dest, oldChar, newChar);
+        }
+
+        /// <summary>
+        /// Find the first position where two sequences differ, the widest vector unit supported by the processor is used.
+        /// </summary>
+        /// <returns>zero-based index, or NotFound if they are equal</returns>
+        template<typename T>
+        inline uint32_t Mismatch(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(count) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return MismatchAvx2(s1, s2, count);
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return MismatchSse2(s1, s2, count);
+#endif
+            return MismatchScalar(s1, s2, count);
+        }
+
+        /// <summary>
+        /// Find the first position where two sequences differ once their ASCII letters are folded to lowercase.
+        /// </summary>
+        /// <returns>zero-based index, or NotFound if they are equal ignoring case</returns>
+        template<typename T>
+        inline uint32_t MismatchIgnoreCase(const T* s1, const T* s2, uint32_t count) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            const size_t bytes = static_cast<size_t>(count) * sizeof(T);
+            if (bytes >= 32 && CpuFeatures::Current().avx2) return MismatchIgnoreCaseAvx2(s1, s2, count);
+            if (bytes >= 16 && CpuFeatures::Current().sse2) return MismatchIgnoreCaseSse2(s1, s2, count);
+#endif
+            return MismatchIgnoreCaseScalar(s1, s2, count);
+        }
+
+        /// <summary>
+        /// Find the first occurrence of a non-empty needle ignoring the case of ASCII letters, nothing is allocated.
+        /// Candidates whose first and last characters match after folding are verified, a vector at a time when supported;
+        /// like a naive search the worst case is proportional to the product of the lengths.
+        /// </summary>
+        /// <returns>zero-based index, or NotFound</returns>
+        template<typename T>
+        inline uint32_t FindIgnoreCase(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength) noexcept
+        {
+            if (needleLength > length) return NotFound;
+            uint32_t resume = 0;
+#ifdef YTC_SIMD_X86
+            uint32_t found = NotFound;
+            if (CpuFeatures::Current().avx2) found = FindIgnoreCaseAvx2(haystack, length, needle, needleLength, resume);
+            else if (CpuFeatures::Current().sse2) found = FindIgnoreCaseSse2(haystack, length, needle, needleLength, resume);
+            if (found != NotFound) return found;
+#endif
+            return FindIgnoreCaseScalar(haystack, length, needle, needleLength, resume);
+        }
+    }
+}
@@ -1,10 +1,28 @@
 #pragma once
 
 #include "YtcError.hpp"
+#include "YtcSimd.hpp"
+#include "YtcHash.hpp"
+#include "YtcMemory.hpp"
+#include "YtcCollection.hpp"
+#include "YtcNumber.hpp"
+#include "YtcLevenshtein.hpp"
 
 #include <cstdint>
 #include <cstring>
+#include <cassert>
 #include <atomic>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Bytes of characters a String stores without allocating. The default keeps String 32 bytes large on 64-bit platforms,
+// more inline bytes trade a larger object for fewer allocations of short strings of wide characters.
+#ifndef YTC_STRING_INLINE_BYTES
+#define YTC_STRING_INLINE_BYTES 24
+#endif
 
 //#ifdef _DEBUG
 //#include "YtcDbg.hpp"
@@ -12,9 +30,84 @@
 //#endif
 namespace Ytc
 {
+    template<typename T>
+    class StringView;
+
+    template<typename T>
+    class StringSearcher;
+
+    template<typename T>
+    class StringBuilder;
+
+    template<typename T, typename Delimiter>
+    class StringSplitter;
+
+    template<typename T>
+    struct CharDelimiter;
 
+    template<typename T>
+    struct SeparatorDelimiter;
 
     template<typename T>
+    struct AnyCharDelimiter;
+    /// <summary>
+    /// Options of splitting a string into tokens.
+    /// </summary>
+    enum class SplitOptions
+    {
+        None = 0,
+        // empty tokens, between adjacent delimiters or at either end, are skipped
+        RemoveEmpty = 1
+    };
+
+    template<typename T, typename Left, typename Right>
+    class ConcatExpression;
+
+    /// <summary>
+    /// Reference counting of buffers shared by strings which may live on different threads.
+    /// </summary>
+    struct AtomicRefCount
+    {
+        static void Increment(std::atomic_uint32_t& count) noexcept
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+        }
+        /// <summary>
+        /// Drop a reference.
+        /// </summary>
+        /// <returns>whether it was the last one</returns>
+        static bool Decrement(std::atomic_uint32_t& count) noexcept
+        {
+            // a sole owner skips the atomic read-modify-write, nobody else can take a reference meanwhile
+            return count.load(std::memory_order_acquire) == 1 || count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+    };
+    /// <summary>
+    /// Reference counting for strings confined to one thread, the count is updated by plain loads and stores.
+    /// </summary>
+    struct LocalRefCount
+    {
+        static void Increment(std::atomic_uint32_t& count) noexcept
+        {
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        static bool Decrement(std::atomic_uint32_t& count) noexcept
+        {
+            const uint32_t value = count.load(std::memory_order_relaxed);
+            count.store(value - 1, std::memory_order_relaxed);
+            return value == 1;
+        }
+    };
+
+    /// <summary>
+    /// A string which shares the buffer of a long string among its copies until one of them is modified.
+    /// Buffers are allocated from the current MemoryResource of the thread, see MemoryResourceScope, or from the global heap.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    /// <typeparam name="RefCountPolicy">How copies count their references to a shared buffer: AtomicRefCount, or LocalRefCount for strings
+    /// confined to one thread, see Share() and Detach()</typeparam>
+    template<typename T, typename RefCountPolicy = AtomicRefCount>
     class String
     {
     public:
@@ -37,47 +130,101 @@ namespace Ytc
         /// <param name="s1"></param>
         /// <param name="s2"></param>
         /// <returns></returns>
-        static int Compare(const String<T>& s1, const String<T>& s2) noexcept
+        static int Compare(const String& s1, const String& s2) noexcept
         {
-            const T* buffer1 = s1.Buffer();
-            const T* buffer2 = s2.Buffer();
-            if (buffer1 == buffer2) return 0;
-            const uint32_t length = s1.length_ < s2.length_ ? s1.length_ : s2.length_;
-            for (uint32_t i = 0; i < length; ++i)
-            {
-                int diff = buffer1[i] - buffer2[i];
-                if (diff) return diff;
-            }
-            return s1.length_ - s2.length_;
+            return StringView<T>::Compare(s1, s2);
         }
 
-        static int Compare(const String<T>& s1, const T* s2) noexcept
+        /// <summary>
+        /// Compare with a zero-terminated string in one pass, a null pointer is ordered before every string.
+        /// </summary>
+        static int Compare(const String& s1, const T* s2) noexcept
         {
             if (!s2) return 1;
-            const T* buffer1 = s1.Buffer();
-            const uint32_t length1 = s1.Length();
-            for (uint32_t i = 0; i < length1; ++i)
+            return StringView<T>::Compare(s1, s2);
+        }
+
+        /// <summary>
+        /// Formats an integer in decimal, the digits are written straight into the buffer of the new string.
+        /// </summary>
+        template<typename Integer, typename std::enable_if<std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value, int>::type = 0>
+        static String From(Integer value)
+        {
+            return FromInteger(static_cast<typename std::conditional<std::is_signed<Integer>::value, int64_t, uint64_t>::type>(value));
+        }
+        /// <summary>
+        /// Formats a double with digits which parse back to the same value, the shortest in all but rare cases, see Number::FormatDouble.
+        /// </summary>
+        static String From(double value)
+        {
+            T buffer[Number::MaxDoubleLength];
+            return String(buffer, Number::FormatDouble(value, buffer));
+        }
+        /// <summary>
+        /// Parses a decimal integer with an optional sign, it never throws.
+        /// </summary>
+        /// <param name="text">The whole text must be the number, without spaces.</param>
+        /// <param name="value">Receives the number, it is left unchanged on failure.</param>
+        /// <returns>false if the text is not a number or the number is out of the range of Integer</returns>
+        template<typename Integer, typename std::enable_if<std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value, int>::type = 0>
+        static bool TryParse(StringView<T> text, Integer& value) noexcept
+        {
+            typename std::conditional<std::is_signed<Integer>::value, int64_t, uint64_t>::type wide;
+            if (!Number::ParseInteger(text.Buffer(), text.Length(), wide)) return false;
+            if (static_cast<decltype(wide)>(static_cast<Integer>(wide)) != wide) return false;
+            value = static_cast<Integer>(wide);
+            return true;
+        }
+        /// <summary>
+        /// Parses a decimal floating-point number, correctly rounded, it never throws; see Number::ParseDouble.
+        /// </summary>
+        static bool TryParse(StringView<T> text, double& value) noexcept
+        {
+            return Number::ParseDouble(text.Buffer(), text.Length(), value);
+        }
+        /// <summary>
+        /// Refers to characters of read-only memory such as a MappedFile without copying them, the string keeps the region alive.
+        /// Such a string is not zero-terminated, see CString(). Its copies share the region, and modifying or detaching it copies the characters
+        /// onto the heap first. Regions which fit in the inline buffer are copied at once.
+        /// </summary>
+        /// <param name="region">The memory to refer to.</param>
+        /// <param name="offset">The byte offset of the first character, a multiple of the size of a character.</param>
+        /// <param name="length">The number of characters, MaxSize for all of them up to the end of the region.</param>
+        /// <returns>a new string instance</returns>
+        static String FromRegion(MappedRegion& region, uint64_t offset = 0, uint32_t length = MaxSize)
+        {
+            if (offset > region.Size() || offset % sizeof(T))
             {
-                T c = *s2++;
-                if (c)
-                {
-                    int diff = buffer1[i] - c;
-                    if (diff) return diff;
-                }
-                else
-                {
-                    return 1;
-                }
+                throw Exception(L"The argument<offset> is out of range!");
+            }
+            const uint64_t available = (region.Size() - offset) / sizeof(T);
+            if (length == MaxSize)
+            {
+                if (available >= MaxSize) throw Exception(L"The string is too long!");
+                length = static_cast<uint32_t>(available);
+            }
+            else if (length > available)
+            {
+                throw Exception(L"The argument<length> is out of range!");
             }
-            return *s2 ? -1 : 0;
+            const T* buffer = reinterpret_cast<const T*>(static_cast<const char*>(region.Data()) + offset);
+            if (length < StaticBufferSize) return String(buffer, length);
+            // longer than the inline buffer, so every path which grows or detaches the string reallocates it
+            String result;
+            region.AddRef();
+            result.storage_.mappedBuffer.ptr = const_cast<T*>(buffer);
+            result.storage_.mappedBuffer.region = &region;
+            result.length_ = length;
+            result.flags_ = Mapped;
+            return result;
         }
 
-        constexpr String() noexcept : length_(0), bufferSize_(StaticBufferSize)
+        constexpr String() noexcept : length_(0), flags_(0)
         {
             storage_.staticBuffer[0] = 0;
         }
 
-        constexpr String(T value) noexcept : bufferSize_(StaticBufferSize)
+        constexpr String(T value) noexcept : flags_(0)
         {
             storage_.staticBuffer[0] = value;
             length_  = value ? 1 : 0;
@@ -95,7 +242,7 @@ namespace Ytc
             else
             {
                 length_ = 0;
-                bufferSize_ = StaticBufferSize;
+                flags_ = 0;
                 storage_.staticBuffer[0] = 0;
             }
         }
@@ -110,9 +257,9 @@ namespace Ytc
         {
         }
 
-        String(const String<T>& other) 
+        String(const String& other) 
         {
-            if (other.IsLong())
+            if (other.IsLong() || other.IsMapped())
             {
                 GetSharedFrom(other);
             }
@@ -122,13 +269,13 @@ namespace Ytc
             }
         }
 
-        String(const String<T>& _string, uint32_t start, uint32_t count = MaxSize)
+        String(const String& _string, uint32_t start, uint32_t count = MaxSize)
         {
             if (start < _string.Length())
             {
-                int length = _string.Length() - start;
+                uint32_t length = _string.Length() - start;
                 if (length < count) count = length;
-                CreateFrom(_string.Buffer() + start, length);
+                CreateFrom(_string.Buffer() + start, count);
             }
             else
             {
@@ -136,28 +283,86 @@ namespace Ytc
             }
         }
 
-        String(String<T>&& _string) noexcept
+        String(String&& _string) noexcept
         {
             MoveImpl(std::move(_string));
         }
+        /// <summary>
+        /// Copy a string which counts references another way, the buffers of the two kinds are never shared.
+        /// </summary>
+        template<typename OtherRefCount>
+        explicit String(const String<T, OtherRefCount>& other)
+        {
+            CreateFrom(other.Buffer(), other.Length());
+        }
+        /// <summary>
+        /// Take over the buffer of a string which counts references another way, if it is the only owner; otherwise copy it.
+        /// </summary>
+        template<typename OtherRefCount>
+        explicit String(String<T, OtherRefCount>&& other)
+        {
+            if (other.IsHeapAllocated() && other.storage_.variableBuffer.Sharing())
+            {
+                CreateFrom(other.Buffer(), other.Length());
+            }
+            else
+            {
+                memcpy(this, &other, sizeof(other));
+                other.storage_.staticBuffer[0] = 0;
+                other.length_ = 0;
+                other.flags_ = 0;
+            }
+        }
 
         ~String()
         {
             Destroy();
         }
 
+        /// <summary>
+        /// Get a copy which may be handed to another thread, its buffer is counted atomically.
+        /// </summary>
+        String<T> Share() const &
+        {
+            return String<T>(*this);
+        }
+        /// <summary>
+        /// Turn this string into one which may be handed to another thread, the buffer is moved when this instance owns it alone.
+        /// </summary>
+        String<T> Share() &&
+        {
+            return String<T>(std::move(*this));
+        }
+        /// <summary>
+        /// Make this instance the only owner of its buffer, the characters are copied if other strings share them or if they are mapped.
+        /// Afterwards the instance may be moved to another thread whatever its RefCountPolicy.
+        /// </summary>
+        void Detach()
+        {
+            if (IsMapped() || (IsHeapAllocated() && storage_.variableBuffer.Sharing()))
+            {
+                Reallocate(length_ + 1, Resource());
+            }
+        }
+
         void Assign(const T* buffer, uint32_t length)
         {
+            if (IsMapped())
+            {
+                // the characters may come from the region, which stays mapped until they are copied
+                *this = String(buffer, length);
+                return;
+            }
             auto* ptr = UninitializedCopy(buffer, length, Reserve(length));
             length_ = length;
             *ptr = 0;  
         }
 
-        String& operator=(const String<T>& other)
+        String& operator=(const String& other)
         {
             if (this != &other)
             {
-                if (other.IsLong())
+                if (other.IsLong() || other.IsMapped())
                 {
                     Destroy();
                     GetSharedFrom(other);
@@ -170,7 +375,7 @@ namespace Ytc
             return *this;
         }
 
-        String& operator=(String<T>&& _string) noexcept
+        String& operator=(String&& _string) noexcept
         {
             if (this != &_string)
             {
@@ -182,17 +387,18 @@ namespace Ytc
 
         String& operator=(T c)
         {
+            if (IsMapped()) Destroy();
             auto* ptr = storage_.staticBuffer;
             if (IsHeapAllocated())
             {
                 if (storage_.variableBuffer.Sharing())
                 {
-                    storage_.variableBuffer.DecRef();
-                    bufferSize_ = StaticBufferSize;;
+                    storage_.variableBuffer.Release();
+                    flags_ &= ~HeapAllocated;
                 }
                 else
                 {
-                    ptr = storage_.variableBuffer.ptr;
+                    ptr = MutableBuffer();
                 }
             }
             *ptr = c;
@@ -201,9 +407,29 @@ namespace Ytc
             return *this;
         }
 
+        /// <summary>
+        /// The characters, they are followed by a terminator unless the string is mapped from a region (see FromRegion).
+        /// Pass CString() where a zero-terminated string is expected.
+        /// </summary>
         const T* Buffer() const noexcept
         {
-            return IsHeapAllocated() ? storage_.variableBuffer.ptr : storage_.staticBuffer;
+            // a mapped buffer starts with the same pointer as a heap one
+            return flags_ ? storage_.variableBuffer.ptr : storage_.staticBuffer;
+        }
+        /// <summary>
+        /// The characters followed by a terminator, a mapped string is detached first so that it owns a terminated copy.
+        /// </summary>
+        const T* CString()
+        {
+            if (IsMapped()) Detach();
+            return Buffer();
+        }
+        /// <summary>
+        /// Whether Buffer() is followed by a terminator, only strings mapped from a region are not.
+        /// </summary>
+        bool IsZeroTerminated() const noexcept
+        {
+            return !IsMapped();
         }
         /// <summary>
         /// Return the count of characters.
@@ -219,12 +445,22 @@ namespace Ytc
             return Length() == 0;
         }
         /// <summary>
+        /// Hash the characters, the hash equals the one of a view on the same characters.
+        /// Long strings cache it for all their copies.
+        /// </summary>
+        /// <returns>the hash</returns>
+        size_t GetHashCode() const noexcept
+        {
+            const uint64_t hash = IsLong() && IsHeapAllocated() ? storage_.variableBuffer.CachedHash(length_) : Hash::Bytes(Buffer(), length_ * sizeof(T));
+            return static_cast<size_t>(hash);
+        }
+        /// <summary>
         /// Retrieves a substring from this instance.
         /// </summary>
         /// <param name="start">The zero-absed starting character position of a substring in this instance.</param>
         /// <param name="length">The number of characters in the substring.</param>
         /// <returns></returns>
-        String<T> SubString(uint32_t start, uint32_t length = MaxSize) const
+        String SubString(uint32_t start, uint32_t length = MaxSize) const
         {
             if (start < length_)
             {
@@ -234,43 +470,32 @@ namespace Ytc
             throw Exception(L"The argument<start> is out of range!");
         }
         /// <summary>
+        /// Retrieves a read-only view of a substring without copying it, the view must not outlive this instance or its next modification.
+        /// </summary>
+        /// <param name="start">The zero-based starting character position, it may equal the length for an empty view.</param>
+        /// <param name="length">The number of characters in the view.</param>
+        /// <returns></returns>
+        StringView<T> View(uint32_t start = 0, uint32_t length = MaxSize) const
+        {
+            return StringView<T>(*this).View(start, length);
+        }
+        /// <summary>
         /// Reports the zero-based index of the first occurrence of a specified character.
         /// </summary>
         /// <param name="c">The specified character.</param>
         /// <returns>index of the character</returns>
         uint32_t IndexOf(T c) const noexcept
         {
-            const T* buffer = Buffer();
-            for (uint32_t i = 0; i < length_; ++i)
-            {
-                if (buffer[i] == c) return i;
-            }
-            return InvalidIndex;
+            return Simd::FindChar(Buffer(), length_, c);
         }
         /// <summary>
         /// Reports the zero-based index of the first occurrence of a specified string.
         /// </summary>
         /// <param name="value">The string to seek.</param>
         /// <returns>index of the string</returns>
-        uint32_t IndexOf(const String<T>& value) const noexcept
+        uint32_t IndexOf(StringView<T> value) const noexcept
         {
-            if (value.IsEmpty()) return 0;
-            uint32_t length = value.length_;
-            const T* _buffer = value.Buffer();
-            const T* my_buffer = Buffer();
-            for (uint32_t start = 0; length <= length_ - start; ++start)
-            {
-                uint32_t i = start;
-                for (uint32_t j = 0; j < length && my_buffer[i] == _buffer[j]; ++j)
-                {
-                    ++i;
-                }
-                if ((i - start) == length)
-                {
-                    return start;
-                }
-            }
-            return InvalidIndex;
+            return StringSearcher<T>::Find(Buffer(), length_, value.Buffer(), value.Length());
         }
         /// <summary>
         /// Report the zero-based index position of the last occurrence of a specified character within this instance.
@@ -279,35 +504,45 @@ namespace Ytc
         /// <returns>the index of value</returns>
         uint32_t LastIndexOf(T value) const noexcept
         {
-            const T* buffer = Buffer();
-            for (uint32_t i = length_ - 1; i != InvalidIndex; --i)
-            {
-                if (buffer[i] == value) return i;
-            }
-            return InvalidIndex;
+            return Simd::FindLastChar(Buffer(), length_, value);
         }
         /// <summary>
         /// Report the zero-based index position of the last occurrence of a specified string within this instance.
         /// </summary>
         /// <param name="value">The specified string</param>
         /// <returns>the index of value</returns>
-        uint32_t LastIndexOf(const String<T>& value) const noexcept
+        uint32_t LastIndexOf(StringView<T> value) const noexcept
         {
-            if (IsEmpty()) return InvalidIndex;
-            if (value.IsEmpty()) return length_ - 1;
-            uint32_t length = value.length_;
-            const T* buffer = value.Buffer();
-            const T* my_buffer = Buffer();
-            for (uint32_t start = length_ - 1; length <= (start + 1); --start)
-            {
-                uint32_t i = start;
-                for (uint32_t j = length - 1; j != InvalidIndex && my_buffer[i] == buffer[j]; --j)
-                {
-                    --i;
-                }
-                if ((start - i) == length) return i + 1;
-            }
-            return InvalidIndex;
+            return StringSearcher<T>::FindLast(Buffer(), length_, value.Buffer(), value.Length());
+        }
+
+        /// <summary>
+        /// Splits into the tokens between occurrences of a character, lazily and without copying them.
+        /// The tokens are views of this instance, which must outlive the splitter and stay unmodified while it is used.
+        /// </summary>
+        /// <param name="delimiter">The character separating tokens.</param>
+        /// <param name="options">Whether empty tokens are skipped.</param>
+        /// <param name="maxCount">The most tokens enumerated, the last one holds the rest of the string.</param>
+        /// <returns>an enumerable of views which also works with range-for</returns>
+        StringSplitter<T, CharDelimiter<T>> Split(T delimiter, SplitOptions options = SplitOptions::None, uint32_t maxCount = MaxSize) const noexcept
+        {
+            return StringView<T>(*this).Split(delimiter, options, maxCount);
+        }
+        /// <summary>
+        /// Splits into the tokens between occurrences of a separator string, an empty separator leaves the whole string as one token.
+        /// The separator is not copied either and must outlive the splitter.
+        /// </summary>
+        StringSplitter<T, SeparatorDelimiter<T>> Split(StringView<T> separator, SplitOptions options = SplitOptions::None, uint32_t maxCount = MaxSize) const noexcept
+        {
+            return StringView<T>(*this).Split(separator, options, maxCount);
+        }
+        /// <summary>
+        /// Splits into the tokens between occurrences of any of a set of characters.
+        /// The set is not copied either and must outlive the splitter.
+        /// </summary>
+        StringSplitter<T, AnyCharDelimiter<T>> SplitAny(StringView<T> delimiters, SplitOptions options = SplitOptions::None, uint32_t maxCount = MaxSize) const noexcept
+        {
+            return StringView<T>(*this).SplitAny(delimiters, options, maxCount);
         }
 
         /// <summary>
@@ -324,7 +559,7 @@ namespace Ytc
         /// </summary>
         /// <param name="value">The specified string</param>
         /// <returns> true if the value occurs; otherwise, false</returns>
-        bool Contains(const String<T>& value) const noexcept
+        bool Contains(StringView<T> value) const noexcept
         {
             return IndexOf(value) != InvalidIndex;
         }
@@ -334,13 +569,13 @@ namespace Ytc
         /// <param name="start">specified zero-based position</param>
         /// <param name="count">number of characters</param>
         /// <returns>a new string instance</returns>
-        String<T> Remove(uint32_t start, uint32_t count) const
+        String Remove(uint32_t start, uint32_t count) const
         {
             if (start < length_ && (start + count) <= length_)
             {
                 auto* myBuffer = Buffer();
                 uint32_t newLength = length_ - count;
-                String<T> newString;
+                String newString;
                 auto* ptr = UninitializedCopy(myBuffer, start - 0, newString.InitializeCapacity(newLength));
                 uint32_t rightStart = start + count;
                 ptr = UninitializedCopy(myBuffer + rightStart, length_ - rightStart, ptr);
@@ -354,51 +589,201 @@ namespace Ytc
         }
 
         /// <summary>
-        /// Returns a copy of this string converted to uppercase.
+        /// Returns a new string in which every occurrence of a character is replaced by another one.
         /// </summary>
-        /// <returns>a new string instance</returns>
-        String<T> ToUpper() const
+        /// <param name="oldValue">the character to replace</param>
+        /// <param name="newValue">the character replacing it</param>
+        /// <returns>a new string instance, which shares the buffer of this one if nothing is replaced</returns>
+        String Replace(T oldValue, T newValue) const
+        {
+            const uint32_t first = IndexOf(oldValue);
+            if (first == InvalidIndex || oldValue == newValue) return *this;
+            String newString;
+            T* buffer = UninitializedCopy(Buffer(), first, newString.InitializeCapacity(length_));
+            *Simd::ReplaceChar(Buffer() + first, length_ - first, buffer, oldValue, newValue) = 0;
+            return newString;
+        }
+        /// <summary>
+        /// Returns a new string in which every occurrence of a string is replaced by another one, scanning from left to right
+        /// without overlapping. The occurrences are found once, then the result is written into a buffer of its final length.
+        /// </summary>
+        /// <param name="oldValue">the string to replace, it must not be empty</param>
+        /// <param name="newValue">the string replacing it, it may be empty</param>
+        /// <returns>a new string instance, which shares the buffer of this one if nothing is replaced</returns>
+        String Replace(StringView<T> oldValue, StringView<T> newValue) const
         {
-            String<T> newString(Buffer(), Length());
-            T* buffer = const_cast<T*>(newString.Buffer());
-            for (uint32_t i = 0; i < length_; ++i)
+            if (oldValue.IsEmpty()) throw Exception(L"The string to replace is empty!");
+            const T* buffer = Buffer();
+            const uint32_t oldLength = oldValue.Length(), newLength = newValue.Length();
+            uint32_t position = IndexOf(oldValue);
+            if (position == InvalidIndex) return *this;
+            String newString;
+            if (oldLength == newLength)
             {
-                T c = buffer[i];
-                if (c >= 'a' && c <= 'z')
+                T* dest = newString.InitializeCapacity(length_);
+                UninitializedCopy(buffer, length_, dest)[0] = 0;
+                for (; position != InvalidIndex; position = IndexOf(buffer, length_, position + oldLength, oldValue))
                 {
-                    buffer[i] = c - DistanceOfUpperLower;
+                    UninitializedCopy(newValue.Buffer(), newLength, dest + position);
                 }
+                return newString;
+            }
+            List<uint32_t> positions;
+            for (; position != InvalidIndex; position = IndexOf(buffer, length_, position + oldLength, oldValue))
+            {
+                positions.Add(position);
+            }
+            // the difference wraps around when the result is shorter, the sum is still exact
+            const uint64_t count = positions.Count();
+            const uint64_t resultLength = length_ + count * newLength - count * oldLength;
+            if (resultLength >= MaxSize) throw Exception(L"The string is too long!");
+            T* dest = newString.InitializeCapacity(static_cast<uint32_t>(resultLength));
+            uint32_t start = 0;
+            for (uint32_t i = 0; i < positions.Count(); ++i)
+            {
+                dest = UninitializedCopy(buffer + start, positions[i] - start, dest);
+                dest = UninitializedCopy(newValue.Buffer(), newLength, dest);
+                start = positions[i] + oldLength;
             }
+            *UninitializedCopy(buffer + start, length_ - start, dest) = 0;
             return newString;
         }
         /// <summary>
-        /// Returns a copy of this string converted to lowercase.
+        /// Replaces every occurrence of a character by another one, the characters are copied only if the buffer is shared.
         /// </summary>
-        /// <returns>a new string instance</returns>
-        String<T> ToLower() const
+        /// <returns>this instance</returns>
+        String& ReplaceInPlace(T oldValue, T newValue)
         {
-            String<T> newString(Buffer(), Length());
-            T* buffer = const_cast<T*>(newString.Buffer());
-            for (uint32_t i = 0; i < length_; ++i)
+            const uint32_t first = IndexOf(oldValue);
+            if (first != InvalidIndex && oldValue != newValue)
             {
-                T c = buffer[i];
-                if (c >= 'A' && c <= 'Z')
-                {
-                    buffer[i] = c + DistanceOfUpperLower;
-                }
+                Detach();
+                T* buffer = MutableBuffer();
+                Simd::ReplaceChar(buffer + first, length_ - first, buffer + first, oldValue, newValue);
+            }
+            return *this;
+        }
+        /// <summary>
+        /// Replaces every occurrence of a string by another one. When both have the same length the replacements are written
+        /// over the occurrences, and the characters are copied only if the buffer is shared; otherwise this instance takes the
+        /// result of Replace.
+        /// </summary>
+        /// <returns>this instance</returns>
+        String& ReplaceInPlace(StringView<T> oldValue, StringView<T> newValue)
+        {
+            if (oldValue.Length() != newValue.Length() || Overlaps(oldValue) || Overlaps(newValue))
+            {
+                *this = Replace(oldValue, newValue);
+                return *this;
+            }
+            if (oldValue.IsEmpty()) throw Exception(L"The string to replace is empty!");
+            uint32_t position = IndexOf(oldValue);
+            if (position == InvalidIndex) return *this;
+            Detach();
+            T* buffer = MutableBuffer();
+            // only the characters after the last replacement are searched, so they are still the original ones
+            for (; position != InvalidIndex; position = IndexOf(buffer, length_, position + oldValue.Length(), oldValue))
+            {
+                UninitializedCopy(newValue.Buffer(), newValue.Length(), buffer + position);
             }
+            return *this;
+        }
+
+        /// <summary>
+        /// Returns a copy of this string converted to uppercase.
+        /// </summary>
+        /// <returns>a new string instance</returns>
+        String ToUpper() const
+        {
+            String newString;
+            *Simd::ToUpperAscii(Buffer(), length_, newString.InitializeCapacity(length_)) = 0;
+            return newString;
+        }
+        /// <summary>
+        /// Returns a copy of this string converted to lowercase.
+        /// </summary>
+        /// <returns>a new string instance</returns>
+        String ToLower() const
+        {
+            String newString;
+            *Simd::ToLowerAscii(Buffer(), length_, newString.InitializeCapacity(length_)) = 0;
             return newString;
         }
+        /// <summary>
+        /// Converts this string to uppercase, the characters are copied only if the buffer is shared.
+        /// </summary>
+        /// <returns>this instance</returns>
+        String& ToUpperInPlace()
+        {
+            Detach();
+            Simd::ToUpperAscii(Buffer(), length_, MutableBuffer());
+            return *this;
+        }
+        /// <summary>
+        /// Converts this string to lowercase, the characters are copied only if the buffer is shared.
+        /// </summary>
+        /// <returns>this instance</returns>
+        String& ToLowerInPlace()
+        {
+            Detach();
+            Simd::ToLowerAscii(Buffer(), length_, MutableBuffer());
+            return *this;
+        }
+        /// <summary>
+        /// Compare two strings ignoring the case of ASCII letters, other characters compare as in Compare.
+        /// </summary>
+        static int CompareIgnoreCase(StringView<T> s1, StringView<T> s2) noexcept
+        {
+            return StringView<T>::CompareIgnoreCase(s1, s2);
+        }
+
+        bool EqualsIgnoreCase(StringView<T> value) const noexcept
+        {
+            return StringView<T>(*this).EqualsIgnoreCase(value);
+        }
+        /// <summary>
+        /// Reports the zero-based index of the first occurrence of a specified string, ignoring the case of ASCII letters.
+        /// </summary>
+        /// <param name="value">The string to seek.</param>
+        /// <returns>index of the string</returns>
+        uint32_t IndexOfIgnoreCase(StringView<T> value) const noexcept
+        {
+            return StringView<T>(*this).IndexOfIgnoreCase(value);
+        }
+        /// <summary>
+        /// The Levenshtein distance of two strings, see StringView::EditDistance.
+        /// </summary>
+        static uint32_t EditDistance(StringView<T> s1, StringView<T> s2, uint32_t maxDistance = MaxSize)
+        {
+            return StringView<T>::EditDistance(s1, s2, maxDistance);
+        }
+
+        static bool IsWithinEditDistance(StringView<T> s1, StringView<T> s2, uint32_t maxDistance)
+        {
+            return StringView<T>::IsWithinEditDistance(s1, s2, maxDistance);
+        }
+        /// <summary>
+        /// Reports the zero-based index of the first approximate occurrence of a specified string, see StringView::FuzzyIndexOf.
+        /// </summary>
+        uint32_t FuzzyIndexOf(StringView<T> value, uint32_t maxDistance) const
+        {
+            return StringView<T>(*this).FuzzyIndexOf(value, maxDistance);
+        }
+
+        uint32_t FuzzyIndexOf(StringView<T> value, uint32_t maxDistance, uint32_t& matchLength) const
+        {
+            return StringView<T>(*this).FuzzyIndexOf(value, maxDistance, matchLength);
+        }
 
         static constexpr auto DistanceOfUpperLower = 'a' - 'A';
 
-        String<T>& operator+=(const String<T>& value)
+        String& operator+=(const String& value)
         {
             Append(value.Buffer(), value.Length());
             return *this;
         }
 
-        String<T>& operator+=(const T* buffer)
+        String& operator+=(const T* buffer)
         {
             Append(buffer, CountChar(buffer));
             return *this;
@@ -434,78 +819,62 @@ namespace Ytc
             }
         }
 
-        String<T>& operator+=(T value)
+        String& operator+=(T value)
         {
             Append(value);
             return *this;
         }
-
-        friend String<T> operator+(const String<T>& lhs, const String<T>& rhs)
-        {
-            return ConstructByConcat(lhs.Buffer(), lhs.length_, rhs.Buffer(), rhs.length_);
-        }
-
-        friend String<T> operator+(const String<T>& lhs, T rhs)
-        {
-            if (!rhs) return lhs;
-            String<T> newString;
-            auto* buffer = UninitializedCopy(lhs.Buffer(), lhs.Length(), newString.InitializeCapacity(lhs.Length() + 1));
-            *buffer = rhs;
-            *(++buffer) = 0;
-            return newString;
-        }
-
-        friend String<T> operator+(T lhs, const String<T>& rhs)
-        {
-            if (!lhs) return rhs;
-            String<T> newString;
-            auto* buffer = newString.InitializeCapacity(lhs.Length() + 1);
-            *buffer = lhs;
-            UninitializedCopy(rhs.Buffer(), rhs.Length(), ++buffer);
-            *buffer = 0;
-            return newString;
-        }
-
-        friend String<T> operator+(const String<T>& lhs, const T* rhs)
-        {
-            auto rhsLen = CountChar(rhs);
-            if (rhsLen == 0) return lhs;
-            return ConstructByConcat(lhs.Buffer(), lhs.length_, rhs, rhsLen);
-        }
-
-        friend String<T> operator+(const T* lhs, const String<T>& rhs)
+        /// <summary>
+        /// Append a whole concatenation, at most one allocation is made for all of its operands.
+        /// </summary>
+        template<typename Left, typename Right>
+        String& operator+=(const ConcatExpression<T, Left, Right>& expression)
         {
-            auto lhsLen = CountChar(lhs);
-            if (lhsLen == 0) return rhs;
-            return ConstructByConcat(lhs, lhsLen, rhs.Buffer(), rhs.length_);
+            const uint32_t extraLength = expression.Length();
+            if (CanAppendInPlace(extraLength))
+            {
+                // the operands may refer to this instance, they are read before the tail they are written to
+                *expression.WriteTo(Expand(extraLength)) = 0;
+            }
+            else
+            {
+                // the old buffer stays alive until the operands are copied out of it
+                String newString;
+                newString.Reallocate(GrowBufferSize(length_ + extraLength + 1), Resource());
+                T* buffer = UninitializedCopy(Buffer(), length_, newString.MutableBuffer());
+                *expression.WriteTo(buffer) = 0;
+                newString.length_ = length_ + extraLength;
+                *this = std::move(newString);
+            }
+            return *this;
         }
 
-        bool operator==(const String<T>& _string) const noexcept
+        bool operator==(const String& _string) const noexcept
         {
-            return Length() == _string.Length() && !Compare(*this, _string);
+            return StringView<T>(*this) == StringView<T>(_string);
         }
 
-        bool operator!=(const String<T>& _string) const noexcept
+        bool operator!=(const String& _string) const noexcept
         {
             return !(*this == _string);
         }
 
-        bool operator>(const String<T>& _string) const noexcept
+        bool operator>(const String& _string) const noexcept
         {
             return Compare(*this, _string) > 0;
         }
 
-        bool operator<=(const String<T>& _string) const noexcept
+        bool operator<=(const String& _string) const noexcept
         {
             return !(*this > _string);
         }
 
-        bool operator<(const String<T>& _string) const noexcept
+        bool operator<(const String& _string) const noexcept
         {
             return Compare(*this, _string) < 0;
         }
 
-        bool operator>=(const String<T>& _string) const noexcept
+        bool operator>=(const String& _string) const noexcept
         {
             return !(*this < _string);
         }
@@ -541,64 +910,136 @@ namespace Ytc
         }
 
     private:
+        friend class StringBuilder<T>;
+        template<typename, typename, typename>
+        friend class ConcatExpression;
+        template<typename, typename>
+        friend class String;
 
-        struct VariableBuffer
+        /// <summary>
+        /// Placed right before the characters of a heap buffer, in the same allocation.
+        /// </summary>
+        struct BufferHeader
         {
-            using RefCounter = std::atomic_uint32_t;
-            mutable RefCounter* refCount; // COW for long string
-            T* ptr;
-
-            bool IsRefCountBased() const noexcept
+            BufferHeader(uint32_t capacity, MemoryResource* resource) noexcept : refCount(1), capacity(capacity), hash(0), resource(resource)
             {
-                return refCount != nullptr;
             }
 
-            void IncRef() const
+            size_t BlockSize() const noexcept
             {
-                if (!IsRefCountBased())
-                {
-                    refCount = CreateRefCounter();
-                }
-
-                ++(*refCount);
+                return sizeof(BufferHeader) + size_t(capacity) * sizeof(T);
             }
 
-            void DecRef() const
+            std::atomic_uint32_t refCount; // COW for long string
+            uint32_t capacity; // count of elements including the terminator
+            std::atomic<uint64_t> hash; // 0 until computed
+            MemoryResource* resource; // where the block comes from, null for the global heap
+        };
+
+        struct VariableBuffer
+        {
+            T* ptr;
+            /// <summary>
+            /// Allocate the header and the characters as one block, nobody else owns it yet.
+            /// </summary>
+            /// <param name="bufferSize">count of elements including the terminator</param>
+            /// <param name="resource">where to allocate, null for the global heap</param>
+            /// <returns>the characters</returns>
+            static T* Allocate(uint32_t bufferSize, MemoryResource* resource)
+            {
+                if (bufferSize > (size_t(-1) - sizeof(BufferHeader)) / sizeof(T))
+                {
+                    throw Exception(L"The string is too long!");
+                }
+                const size_t blockSize = sizeof(BufferHeader) + size_t(bufferSize) * sizeof(T);
+                void* block = resource ? resource->Allocate(blockSize, alignof(BufferHeader)) : ::operator new(blockSize);
+                return reinterpret_cast<T*>(new (block) BufferHeader(bufferSize, resource) + 1);
+            }
+
+            BufferHeader* Header() const noexcept
+            {
+                return reinterpret_cast<BufferHeader*>(ptr) - 1;
+            }
+
+            uint32_t Capacity() const noexcept
+            {
+                return Header()->capacity;
+            }
+
+            MemoryResource* Resource() const noexcept
             {
-                --(*refCount);
+                return Header()->resource;
             }
 
-            void CheckRefCount()
+            void IncRef() const noexcept
             {
-                if (*refCount == 0)
+                RefCountPolicy::Increment(Header()->refCount);
+            }
+            /// <summary>
+            /// Give up this owner's reference, the last owner frees the block.
+            /// </summary>
+            void Release() noexcept
+            {
+                BufferHeader* header = Header();
+                if (RefCountPolicy::Decrement(header->refCount))
                 {
-                    DestroyRefCounter(refCount);
-                    delete[] ptr;
+                    MemoryResource* resource = header->resource;
+                    const size_t blockSize = header->BlockSize();
+                    header->~BufferHeader();
+                    if (resource)
+                    {
+                        resource->Deallocate(header, blockSize, alignof(BufferHeader));
+                    }
+                    else
+                    {
+                        ::operator delete(header);
+                    }
                 }
             }
 
             bool Sharing() const noexcept
             {
-                return IsRefCountBased() && RefCount() > 1;
+                return RefCount() > 1;
             }
 
-            uint32_t RefCount() const
+            uint32_t RefCount() const noexcept
             {
-                return *refCount;
+                return Header()->refCount.load(std::memory_order_acquire);
             }
-        private:
-            static auto* CreateRefCounter()
+            /// <summary>
+            /// Hash the characters once for all the copies.
+            /// </summary>
+            uint64_t CachedHash(uint32_t length) const noexcept
             {
-                return new RefCounter(1);
+                BufferHeader* header = Header();
+                uint64_t hash = header->hash.load(std::memory_order_relaxed);
+                if (!hash)
+                {
+                    hash = Hash::Bytes(ptr, length * sizeof(T));
+                    header->hash.store(hash, std::memory_order_relaxed);
+                }
+                return hash;
             }
-
-            static void DestroyRefCounter(RefCounter* counter)
+            /// <summary>
+            /// Forget the cached hash before the characters are modified in place.
+            /// </summary>
+            void InvalidateHash() noexcept
             {
-                delete counter;
+                Header()->hash.store(0, std::memory_order_relaxed);
             }
         };
         
-        static constexpr uint32_t StaticBufferSize = 16;
+        /// <summary>
+        /// Bytes of characters stored inside the object, so the object has the same size whatever the character type.
+        /// </summary>
+        static constexpr uint32_t InlineBufferBytes = YTC_STRING_INLINE_BYTES;
+        static constexpr uint32_t StaticBufferSize = InlineBufferBytes / sizeof(T);
+        static_assert(StaticBufferSize >= 2 && InlineBufferBytes >= sizeof(T*), "YTC_STRING_INLINE_BYTES is too small");
+        /// <summary>
+        /// Bits of flags_.
+        /// </summary>
+        static constexpr uint32_t HeapAllocated = 1;
+        static constexpr uint32_t Mapped = 2;
         static constexpr uint32_t MinLongStringLength = 256;
 
         static T* UninitializedCopy(const T* source, uint32_t count, T* dest)
@@ -609,138 +1050,172 @@ namespace Ytc
 
         bool IsHeapAllocated() const noexcept
         {
-            return bufferSize_ > StaticBufferSize;
+            return (flags_ & HeapAllocated) != 0;
+        }
+
+        bool IsMapped() const noexcept
+        {
+            return (flags_ & Mapped) != 0;
         }
 
         bool IsLong() const noexcept
         {
             return Length() >= MinLongStringLength;
         }
+        /// <summary>
+        /// The resource a new buffer of this instance comes from: the one of its current buffer, so a string stays where it was
+        /// created, otherwise the current resource of the thread.
+        /// </summary>
+        MemoryResource* Resource() const noexcept
+        {
+            return IsHeapAllocated() ? storage_.variableBuffer.Resource() : MemoryResource::Current();
+        }
+
+        static uint32_t IndexOf(const T* buffer, uint32_t length, uint32_t start, StringView<T> value) noexcept
+        {
+            const uint32_t index = StringSearcher<T>::Find(buffer + start, length - start, value.Buffer(), value.Length());
+            return index == InvalidIndex ? InvalidIndex : start + index;
+        }
+        /// <summary>
+        /// Whether a view refers to characters of this instance.
+        /// </summary>
+        bool Overlaps(StringView<T> value) const noexcept
+        {
+            const std::less<const T*> less;
+            return less(value.Buffer(), Buffer() + length_) && less(Buffer(), value.Buffer() + value.Length());
+        }
+
+        static String FromInteger(int64_t value)
+        {
+            const uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            const uint32_t length = (value < 0) + Number::CountDigits(magnitude);
+            String result;
+            T* buffer = result.InitializeCapacity(length);
+            buffer[0] = T('-');
+            Number::WriteDigits(magnitude, buffer + length);
+            buffer[length] = 0;
+            return result;
+        }
+
+        static String FromInteger(uint64_t value)
+        {
+            const uint32_t length = Number::CountDigits(value);
+            String result;
+            T* buffer = result.InitializeCapacity(length);
+            Number::WriteDigits(value, buffer + length);
+            buffer[length] = 0;
+            return result;
+        }
 
         T* InitializeCapacity(uint32_t length)
         {
             length_ = length;
             if (length < StaticBufferSize)
             {
-                bufferSize_ = StaticBufferSize;
+                flags_ = 0;
                 return storage_.staticBuffer;
             }
-            bufferSize_ = length + 1;
-            auto* ptr = new T[bufferSize_];
-            storage_.variableBuffer.ptr = ptr;
-            storage_.variableBuffer.refCount = nullptr;
-            length_ = length;
-            return ptr;
+            storage_.variableBuffer.ptr = VariableBuffer::Allocate(length + 1, MemoryResource::Current());
+            flags_ = HeapAllocated;
+            return storage_.variableBuffer.ptr;
         }
 
         T* Reserve(uint32_t n)
         {
             uint32_t bufferSizeRequired = n + 1;
+            MemoryResource* resource = Resource();
             if (IsHeapAllocated())
             {
-                if (storage_.variableBuffer.Sharing())
+                if (!storage_.variableBuffer.Sharing() && bufferSizeRequired <= storage_.variableBuffer.Capacity())
                 {
-                    storage_.variableBuffer.DecRef();
-                    if (n < StaticBufferSize)
-                    {
-                        bufferSize_ = StaticBufferSize;
-                        return storage_.staticBuffer;
-                    }
-                    storage_.variableBuffer.ptr = new T[bufferSizeRequired];
-                    storage_.variableBuffer.refCount = nullptr;
-                    bufferSize_ = bufferSizeRequired;
-                    return storage_.variableBuffer.ptr;
-                }
-                else
-                {
-                    if (bufferSize_ < bufferSizeRequired) 
-                    {
-                        delete[] storage_.variableBuffer.ptr;
-                        storage_.variableBuffer.ptr = new T[bufferSizeRequired];
-                        bufferSize_ = bufferSizeRequired;
-                    }
-                    return storage_.variableBuffer.ptr;
+                    return MutableBuffer();
                 }
+                Destroy();
+                storage_.staticBuffer[0] = 0;
             }
             
             if (n < StaticBufferSize)
             {
                 return storage_.staticBuffer;
             }
-            storage_.variableBuffer.ptr = new T[bufferSizeRequired];
-            storage_.variableBuffer.refCount = nullptr;
-            bufferSize_ = bufferSizeRequired;
+            storage_.variableBuffer.ptr = VariableBuffer::Allocate(bufferSizeRequired, resource);
+            flags_ |= HeapAllocated;
             return storage_.variableBuffer.ptr;
         }
 
+        /// <summary>
+        /// Grow by a half so that appending repeatedly costs amortized constant time per character.
+        /// </summary>
+        static uint32_t GrowBufferSize(uint32_t minBufferSize) noexcept
+        {
+            uint32_t bufferSize = minBufferSize + (minBufferSize >> 1);
+            return bufferSize < minBufferSize ? MaxSize : bufferSize;
+        }
+
+        bool CanAppendInPlace(uint32_t extraLength) const noexcept
+        {
+            uint32_t minBufferSize = length_ + extraLength + 1;
+            return IsHeapAllocated()
+                ? !storage_.variableBuffer.Sharing() && minBufferSize <= storage_.variableBuffer.Capacity()
+                : minBufferSize <= StaticBufferSize;
+        }
+
         T* Expand(uint32_t extraLength)
         {
             uint32_t newLength = length_ + extraLength;
-            uint32_t minBufferSize = newLength + 1;
-            T* buffer = nullptr;
-            if (IsHeapAllocated())
-            {
-                if (storage_.variableBuffer.Sharing())
-                {
-                    assert(newLength >= StaticBufferSize);
-                    buffer = new T[minBufferSize];
-                    T* tail = UninitializedCopy(storage_.variableBuffer.ptr, length_, buffer);
-                    storage_.variableBuffer.DecRef();
-                    storage_.variableBuffer.ptr = buffer;
-                    storage_.variableBuffer.refCount = nullptr;
-                    bufferSize_ = minBufferSize;
-                    buffer = tail;
-                }
-                else
-                {
-                    if (bufferSize_ < minBufferSize)
-                    {
-                        buffer = new T[minBufferSize];
-                        T* tail = UninitializedCopy(storage_.variableBuffer.ptr, length_, buffer);
-                        delete[] storage_.variableBuffer.ptr;
-                        storage_.variableBuffer.ptr = buffer;
-                        bufferSize_ = minBufferSize;
-                        buffer = tail;
-                    }
-                    else
-                    {
-                        buffer = storage_.variableBuffer.ptr + length_;
-                    }
-                }
-            }
-            else if (StaticBufferSize < minBufferSize)
-            {
-                buffer = new T[minBufferSize];
-                T* tail = UninitializedCopy(storage_.staticBuffer, length_, buffer);
-                storage_.variableBuffer.ptr = buffer;
-                storage_.variableBuffer.refCount = nullptr;
-                bufferSize_ = minBufferSize;
-                buffer = tail;
-            }
-            else 
+            if (!CanAppendInPlace(extraLength))
             {
-                buffer = storage_.staticBuffer + length_;
+                Reallocate(GrowBufferSize(newLength + 1), Resource());
             }
+            T* buffer = MutableBuffer() + length_;
             length_ = newLength;
             return buffer;
         }
+        /// <summary>
+        /// Move the characters into a new heap buffer owned by this instance alone.
+        /// </summary>
+        /// <param name="bufferSize">count of elements including the terminator, it must exceed both the length and StaticBufferSize</param>
+        /// <param name="resource">where to allocate, null for the global heap</param>
+        void Reallocate(uint32_t bufferSize, MemoryResource* resource)
+        {
+            assert(bufferSize > length_ && bufferSize > StaticBufferSize);
+            T* buffer = VariableBuffer::Allocate(bufferSize, resource);
+            UninitializedCopy(Buffer(), length_, buffer)[0] = 0;
+            ReleaseBuffer();
+            storage_.variableBuffer.ptr = buffer;
+            flags_ = HeapAllocated;
+        }
+
+        T* MutableBuffer() noexcept
+        {
+            if (!IsHeapAllocated()) return storage_.staticBuffer;
+            storage_.variableBuffer.InvalidateHash();
+            return storage_.variableBuffer.ptr;
+        }
 
-        void ShallowCopyFrom(const String<T>& other)
+        void ShallowCopyFrom(const String& other)
         {
             memcpy(this, &other, sizeof(other));
         }
 
-        void MoveImpl(String<T>&& other)
+        void MoveImpl(String&& other)
         {
             ShallowCopyFrom(other);
             other.storage_.staticBuffer[0] = 0;
             other.length_ = 0;
-            other.bufferSize_ = StaticBufferSize;
+            other.flags_ = 0;
         }
 
-        void GetSharedFrom(const String<T>& other)
+        void GetSharedFrom(const String& other)
         {
-            other.storage_.variableBuffer.IncRef();
+            if (other.IsMapped())
+            {
+                other.storage_.mappedBuffer.region->AddRef();
+            }
+            else
+            {
+                other.storage_.variableBuffer.IncRef();
+            }
             ShallowCopyFrom(other);
         }
 
@@ -750,76 +1225,1211 @@ namespace Ytc
             *ptr = 0;
         }
 
-        void Destroy()
+        void ReleaseBuffer()
         {
             if (IsHeapAllocated())
             {
-                if (storage_.variableBuffer.IsRefCountBased())
-                {
-                    storage_.variableBuffer.DecRef();
-                    storage_.variableBuffer.CheckRefCount();
-                }
-                else
-                {
-                    delete[] storage_.variableBuffer.ptr;
-                }
-                bufferSize_ = StaticBufferSize;
+                storage_.variableBuffer.Release();
+            }
+            else if (IsMapped())
+            {
+                storage_.mappedBuffer.region->Release();
             }
-            length_ = 0;
         }
 
-        static String<T> ConstructByConcat(const T* s1, uint32_t len1, 
-                                           const T* s2, uint32_t len2)
+        void Destroy()
         {
-            String<T> newString;
-            T* buffer = newString.InitializeCapacity(len1 + len2);
-            buffer = UninitializedCopy(s1, len1, buffer);
-            buffer = UninitializedCopy(s2, len2, buffer);
-            *buffer = 0;
-            return newString;
+            ReleaseBuffer();
+            flags_ = 0;
+            length_ = 0;
         }
 
+        /// <summary>
+        /// Characters of a MappedRegion, the pointer comes first as in VariableBuffer.
+        /// </summary>
+        struct MappedBuffer
+        {
+            T* ptr;
+            MappedRegion* region;
+        };
+
         union Storage
         {
             VariableBuffer variableBuffer;
+            MappedBuffer mappedBuffer;
             T staticBuffer[StaticBufferSize];
         };
         Storage storage_;
         uint32_t length_;
-        uint32_t bufferSize_;
+        uint32_t flags_;
     };
 
-    template<typename T>
-    bool operator==(const T* s1, const String<T>& s2) noexcept
+    template<typename T, typename RefCountPolicy>
+    bool operator==(const T* s1, const String<T, RefCountPolicy>& s2) noexcept
     {
         return s2 == s1;
     }
-    template<typename T>
-    bool operator!=(const T* s1, const String<T>& s2) noexcept
+    template<typename T, typename RefCountPolicy>
+    bool operator!=(const T* s1, const String<T, RefCountPolicy>& s2) noexcept
     {
         return s2 != s1;
     }
-    template<typename T>
-    bool operator<(const T* s1, const String<T>& s2) noexcept
+    template<typename T, typename RefCountPolicy>
+    bool operator<(const T* s1, const String<T, RefCountPolicy>& s2) noexcept
     {
         return s2 > s1;
     }
-    template<typename T>
-    bool operator>=(const T* s1, const String<T>& s2) noexcept
+    template<typename T, typename RefCountPolicy>
+    bool operator>=(const T* s1, const String<T, RefCountPolicy>& s2) noexcept
     {
         return s2 <= s1;
     }
-    template<typename T>
-    bool operator>(const T* s1, const String<T>& s2) noexcept
+    template<typename T, typename RefCountPolicy>
+    bool operator>(const T* s1, const String<T, RefCountPolicy>& s2) noexcept
     {
         return s2 < s1;
     }
-    template<typename T>
-    bool operator<=(const T* s1, const String<T>& s2) noexcept
+    template<typename T, typename RefCountPolicy>
+    bool operator<=(const T* s1, const String<T, RefCountPolicy>& s2) noexcept
     {
         return s2 >= s1;
     }
 
-    using AString = String<char>;
-    using WString = String<wchar_t>;
+    /// <summary>
+    /// A read-only slice of characters which does not own them, it is not zero-terminated.
+    /// It must not outlive the string it refers to, nor be used after that string is modified.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class StringView
+    {
+    public:
+        static constexpr uint32_t MaxSize = String<T>::MaxSize;
+        static constexpr uint32_t InvalidIndex = String<T>::InvalidIndex;
+        /// <summary>
+        /// Compare two views and returns an integer that indicates their relative position in the sort order.
+        /// </summary>
+        /// <param name="s1"></param>
+        /// <param name="s2"></param>
+        /// <returns></returns>
+        static int Compare(StringView<T> s1, StringView<T> s2) noexcept
+        {
+            const T* buffer1 = s1.buffer_;
+            const T* buffer2 = s2.buffer_;
+            const uint32_t length = s1.length_ < s2.length_ ? s1.length_ : s2.length_;
+            // copies of a long string share the buffer
+            if (buffer1 != buffer2)
+            {
+                const uint32_t i = Simd::Mismatch(buffer1, buffer2, length);
+                if (i != Simd::NotFound) return Simd::Difference(buffer1[i], buffer2[i]);
+            }
+            return (s1.length_ > s2.length_) - (s1.length_ < s2.length_);
+        }
+        /// <summary>
+        /// Compare with a zero-terminated string, the characters are read once without counting them first.
+        /// A null pointer is taken as an empty string.
+        /// </summary>
+        static int Compare(StringView<T> s1, const T* s2) noexcept
+        {
+            if (!s2) return s1.length_ ? 1 : 0;
+            const T* buffer1 = s1.buffer_;
+            for (uint32_t i = 0; i < s1.length_; ++i)
+            {
+                const T c = s2[i];
+                if (!c) return 1;
+                if (buffer1[i] != c) return Simd::Difference(buffer1[i], c);
+            }
+            return s2[s1.length_] ? -1 : 0;
+        }
+        /// <summary>
+        /// Compare two views ignoring the case of ASCII letters, which are compared as lowercase.
+        /// </summary>
+        static int CompareIgnoreCase(StringView<T> s1, StringView<T> s2) noexcept
+        {
+            const uint32_t length = s1.length_ < s2.length_ ? s1.length_ : s2.length_;
+            const uint32_t i = Simd::MismatchIgnoreCase(s1.buffer_, s2.buffer_, length);
+            if (i != Simd::NotFound)
+            {
+                return Simd::Difference(Simd::ToLowerAscii(s1.buffer_[i]), Simd::ToLowerAscii(s2.buffer_[i]));
+            }
+            return (s1.length_ > s2.length_) - (s1.length_ < s2.length_);
+        }
+
+        StringView() noexcept : buffer_(EmptyBuffer()), length_(0)
+        {
+        }
+
+        StringView(const T* buffer, uint32_t length) : buffer_(buffer), length_(length)
+        {
+            if (!buffer) throw Exception(L"Null pointer is not a string!");
+        }
+
+        StringView(const T* buffer) : StringView(buffer, buffer ? String<T>::CountChar(buffer) : 0)
+        {
+        }
+
+        template<typename RefCountPolicy>
+        StringView(const String<T, RefCountPolicy>& value) noexcept : buffer_(value.Buffer()), length_(value.Length())
+        {
+        }
+
+        const T* Buffer() const noexcept
+        {
+            return buffer_;
+        }
+
+        uint32_t Length() const noexcept
+        {
+            return length_;
+        }
+
+        bool IsEmpty() const noexcept
+        {
+            return length_ == 0;
+        }
+
+        size_t GetHashCode() const noexcept
+        {
+            return static_cast<size_t>(Hash::Bytes(buffer_, length_ * sizeof(T)));
+        }
+        /// <summary>
+        /// Retrieves a narrower view, no character is copied.
+        /// </summary>
+        /// <param name="start">The zero-based starting character position, it may equal the length for an empty view.</param>
+        /// <param name="length">The number of characters in the view.</param>
+        /// <returns></returns>
+        StringView<T> View(uint32_t start, uint32_t length = MaxSize) const
+        {
+            if (start <= length_)
+            {
+                const uint32_t maxLength = length_ - start;
+                return StringView<T>(buffer_ + start, length <= maxLength ? length : maxLength);
+            }
+            throw Exception(L"The argument<start> is out of range!");
+        }
+        /// <summary>
+        /// Copy the characters into a new string instance.
+        /// </summary>
+        String<T> ToString() const
+        {
+            return String<T>(buffer_, length_);
+        }
+
+        uint32_t IndexOf(T c) const noexcept
+        {
+            return Simd::FindChar(buffer_, length_, c);
+        }
+
+        uint32_t IndexOf(StringView<T> value) const noexcept
+        {
+            return StringSearcher<T>::Find(buffer_, length_, value.buffer_, value.length_);
+        }
+
+        uint32_t LastIndexOf(T c) const noexcept
+        {
+            return Simd::FindLastChar(buffer_, length_, c);
+        }
+
+        uint32_t LastIndexOf(StringView<T> value) const noexcept
+        {
+            return StringSearcher<T>::FindLast(buffer_, length_, value.buffer_, value.length_);
+        }
+
+        StringSplitter<T, CharDelimiter<T>> Split(T delimiter, SplitOptions options = SplitOptions::None, uint32_t maxCount = MaxSize) const noexcept
+        {
+            return StringSplitter<T, CharDelimiter<T>>(*this, CharDelimiter<T>{ delimiter }, options, maxCount);
+        }
+
+        StringSplitter<T, SeparatorDelimiter<T>> Split(StringView<T> separator, SplitOptions options = SplitOptions::None, uint32_t maxCount = MaxSize) const noexcept
+        {
+            return StringSplitter<T, SeparatorDelimiter<T>>(*this, SeparatorDelimiter<T>{ separator }, options, maxCount);
+        }
+
+        StringSplitter<T, AnyCharDelimiter<T>> SplitAny(StringView<T> delimiters, SplitOptions options = SplitOptions::None, uint32_t maxCount = MaxSize) const noexcept
+        {
+            return StringSplitter<T, AnyCharDelimiter<T>>(*this, AnyCharDelimiter<T>{ delimiters }, options, maxCount);
+        }
+
+        bool Contains(T c) const noexcept
+        {
+            return IndexOf(c) != InvalidIndex;
+        }
+
+        bool Contains(StringView<T> value) const noexcept
+        {
+            return IndexOf(value) != InvalidIndex;
+        }
+
+        bool EqualsIgnoreCase(StringView<T> value) const noexcept
+        {
+            return length_ == value.length_ && Simd::MismatchIgnoreCase(buffer_, value.buffer_, length_) == Simd::NotFound;
+        }
+
+        uint32_t IndexOfIgnoreCase(StringView<T> value) const noexcept
+        {
+            return value.length_ ? Simd::FindIgnoreCase(buffer_, length_, value.buffer_, value.length_) : 0;
+        }
+        /// <summary>
+        /// The Levenshtein distance of two strings: the least count of characters to insert, delete or substitute to
+        /// turn one into the other. The work stops as soon as the distance is known to be larger than maxDistance.
+        /// </summary>
+        /// <param name="maxDistance">the largest distance of interest</param>
+        /// <returns>the distance, or maxDistance + 1 if it is larger than maxDistance</returns>
+        static uint32_t EditDistance(StringView<T> s1, StringView<T> s2, uint32_t maxDistance = MaxSize)
+        {
+            return Levenshtein::Distance(s1.buffer_, s1.length_, s2.buffer_, s2.length_, maxDistance);
+        }
+
+        static bool IsWithinEditDistance(StringView<T> s1, StringView<T> s2, uint32_t maxDistance)
+        {
+            return EditDistance(s1, s2, maxDistance) <= maxDistance;
+        }
+        /// <summary>
+        /// Reports the zero-based index of the first part of this string within an edit distance of a specified string.
+        /// </summary>
+        /// <param name="value">The string to seek.</param>
+        /// <param name="maxDistance">The largest edit distance of a match.</param>
+        /// <returns>index of the match</returns>
+        uint32_t FuzzyIndexOf(StringView<T> value, uint32_t maxDistance) const
+        {
+            uint32_t matchLength;
+            return FuzzyIndexOf(value, maxDistance, matchLength);
+        }
+        /// <summary>
+        /// Reports the zero-based index of the first part of this string within an edit distance of a specified string,
+        /// and how long that part is. The match ends where the distance first gets small enough, or further on while
+        /// it keeps dropping, and starts where the distance of what lies between gets small enough in the same way.
+        /// </summary>
+        /// <param name="value">The string to seek.</param>
+        /// <param name="maxDistance">The largest edit distance of a match.</param>
+        /// <param name="matchLength">The count of characters of the match.</param>
+        /// <returns>index of the match</returns>
+        uint32_t FuzzyIndexOf(StringView<T> value, uint32_t maxDistance, uint32_t& matchLength) const
+        {
+            return Levenshtein::Find(buffer_, length_, value.buffer_, value.length_, maxDistance, matchLength);
+        }
+
+        friend bool operator==(StringView<T> lhs, StringView<T> rhs) noexcept
+        {
+            return lhs.length_ == rhs.length_ && (lhs.buffer_ == rhs.buffer_ || Simd::Equals(lhs.buffer_, rhs.buffer_, lhs.length_));
+        }
+
+        friend bool operator!=(StringView<T> lhs, StringView<T> rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+        friend bool operator<(StringView<T> lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(lhs, rhs) < 0;
+        }
+
+        friend bool operator>(StringView<T> lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(lhs, rhs) > 0;
+        }
+
+        friend bool operator<=(StringView<T> lhs, StringView<T> rhs) noexcept
+        {
+            return !(lhs > rhs);
+        }
+
+        friend bool operator>=(StringView<T> lhs, StringView<T> rhs) noexcept
+        {
+            return !(lhs < rhs);
+        }
+
+        friend bool operator==(StringView<T> lhs, const T* rhs) noexcept
+        {
+            return !Compare(lhs, rhs);
+        }
+
+        friend bool operator!=(StringView<T> lhs, const T* rhs) noexcept
+        {
+            return Compare(lhs, rhs) != 0;
+        }
+
+        friend bool operator<(StringView<T> lhs, const T* rhs) noexcept
+        {
+            return Compare(lhs, rhs) < 0;
+        }
+
+        friend bool operator>(StringView<T> lhs, const T* rhs) noexcept
+        {
+            return Compare(lhs, rhs) > 0;
+        }
+
+        friend bool operator<=(StringView<T> lhs, const T* rhs) noexcept
+        {
+            return Compare(lhs, rhs) <= 0;
+        }
+
+        friend bool operator>=(StringView<T> lhs, const T* rhs) noexcept
+        {
+            return Compare(lhs, rhs) >= 0;
+        }
+
+        friend bool operator==(const T* lhs, StringView<T> rhs) noexcept
+        {
+            return !Compare(rhs, lhs);
+        }
+
+        friend bool operator!=(const T* lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(rhs, lhs) != 0;
+        }
+
+        friend bool operator<(const T* lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(rhs, lhs) > 0;
+        }
+
+        friend bool operator>(const T* lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(rhs, lhs) < 0;
+        }
+
+        friend bool operator<=(const T* lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(rhs, lhs) >= 0;
+        }
+
+        friend bool operator>=(const T* lhs, StringView<T> rhs) noexcept
+        {
+            return Compare(rhs, lhs) <= 0;
+        }
+
+    private:
+        static const T* EmptyBuffer() noexcept
+        {
+            static const T empty = 0;
+            return &empty;
+        }
+
+        const T* buffer_;
+        uint32_t length_;
+    };
+
+    /// <summary>
+    /// A lazy concatenation built by operator+, the characters are copied once when it is converted to a string
+    /// or appended to one, so a + b + c + ... makes a single allocation.
+    /// The operands other than temporary strings are referenced, the expression must not outlive them.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    /// <typeparam name="Left">The operand on the left</typeparam>
+    /// <typeparam name="Right">The operand on the right</typeparam>
+    template<typename T, typename Left, typename Right>
+    class ConcatExpression
+    {
+    public:
+        ConcatExpression(Left left, Right right)
+            : left_(std::move(left)), right_(std::move(right)), length_(left_.Length() + right_.Length())
+        {
+            if (length_ < left_.Length()) throw Exception(L"The string is too long!");
+        }
+
+        uint32_t Length() const noexcept
+        {
+            return length_;
+        }
+        /// <summary>
+        /// Copy the characters of all the operands, no terminator is written.
+        /// </summary>
+        /// <returns>the end of the characters written</returns>
+        T* WriteTo(T* buffer) const noexcept
+        {
+            return right_.WriteTo(left_.WriteTo(buffer));
+        }
+
+        String<T> ToString() const
+        {
+            return *this;
+        }
+
+        template<typename RefCountPolicy>
+        operator String<T, RefCountPolicy>() const
+        {
+            String<T, RefCountPolicy> newString;
+            *WriteTo(newString.InitializeCapacity(length_)) = 0;
+            return newString;
+        }
+
+        friend bool operator==(const ConcatExpression& lhs, StringView<T> rhs)
+        {
+            return lhs.length_ == rhs.Length() && StringView<T>(lhs.ToString()) == rhs;
+        }
+
+        friend bool operator!=(const ConcatExpression& lhs, StringView<T> rhs)
+        {
+            return !(lhs == rhs);
+        }
+
+    private:
+        Left left_;
+        Right right_;
+        uint32_t length_;
+    };
+
+    /// <summary>
+    /// An operand referring to characters owned by someone else, their count is taken once.
+    /// </summary>
+    template<typename T>
+    struct ConcatSlice
+    {
+        const T* buffer;
+        uint32_t length;
+
+        uint32_t Length() const noexcept
+        {
+            return length;
+        }
+
+        T* WriteTo(T* destination) const noexcept
+        {
+            memcpy(destination, buffer, length * sizeof(T));
+            return destination + length;
+        }
+    };
+    /// <summary>
+    /// A temporary string moved into the expression so that it lives as long as the expression.
+    /// </summary>
+    template<typename T, typename RefCountPolicy>
+    struct ConcatTemporary
+    {
+        String<T, RefCountPolicy> value;
+
+        uint32_t Length() const noexcept
+        {
+            return value.Length();
+        }
+
+        T* WriteTo(T* destination) const noexcept
+        {
+            memcpy(destination, value.Buffer(), value.Length() * sizeof(T));
+            return destination + value.Length();
+        }
+    };
+
+    template<typename T>
+    struct ConcatCharacter
+    {
+        T value;
+
+        uint32_t Length() const noexcept
+        {
+            return value ? 1 : 0;
+        }
+
+        T* WriteTo(T* destination) const noexcept
+        {
+            if (value) *destination++ = value;
+            return destination;
+        }
+    };
+
+    template<typename...>
+    struct ConcatVoid
+    {
+        using Type = void;
+    };
+    /// <summary>
+    /// The character type of a string-like operand, absent for anything else.
+    /// </summary>
+    template<typename D>
+    struct ConcatCharOf
+    {
+    };
+
+    template<typename T, typename RefCountPolicy>
+    struct ConcatCharOf<String<T, RefCountPolicy>>
+    {
+        using Type = T;
+    };
+
+    template<typename T>
+    struct ConcatCharOf<StringView<T>>
+    {
+        using Type = T;
+    };
+
+    template<typename T, typename Left, typename Right>
+    struct ConcatCharOf<ConcatExpression<T, Left, Right>>
+    {
+        using Type = T;
+    };
+    /// <summary>
+    /// The character type of a concatenation, taken from whichever side is string-like.
+    /// </summary>
+    template<typename L, typename R, typename Enable = void>
+    struct ConcatCharType : ConcatCharOf<typename std::decay<R>::type>
+    {
+    };
+
+    template<typename L, typename R>
+    struct ConcatCharType<L, R, typename ConcatVoid<typename ConcatCharOf<typename std::decay<L>::type>::Type>::Type>
+        : ConcatCharOf<typename std::decay<L>::type>
+    {
+    };
+    /// <summary>
+    /// Maps an argument of operator+ to the operand stored in the expression: Type and Make(argument).
+    /// </summary>
+    template<typename T, typename D, typename Enable = void>
+    struct ConcatOperandOfDecayed
+    {
+    };
+
+    template<typename T>
+    struct ConcatOperandOfDecayed<T, StringView<T>>
+    {
+        using Type = ConcatSlice<T>;
+
+        static Type Make(StringView<T> value) noexcept
+        {
+            return Type{ value.Buffer(), value.Length() };
+        }
+    };
+
+    template<typename T, typename D>
+    struct ConcatOperandOfDecayed<T, D, typename std::enable_if<
+        std::is_same<D, const T*>::value || std::is_same<D, T*>::value>::type>
+    {
+        using Type = ConcatSlice<T>;
+
+        static Type Make(const T* buffer)
+        {
+            if (!buffer) throw Exception(L"Null pointer is not a string!");
+            return Type{ buffer, String<T>::CountChar(buffer) };
+        }
+    };
+
+    template<typename T, typename D>
+    struct ConcatOperandOfDecayed<T, D, typename std::enable_if<
+        std::is_integral<D>::value && !std::is_same<D, bool>::value>::type>
+    {
+        using Type = ConcatCharacter<T>;
+
+        static Type Make(D value) noexcept
+        {
+            return Type{ static_cast<T>(value) };
+        }
+    };
+
+    template<typename T, typename Left, typename Right>
+    struct ConcatOperandOfDecayed<T, ConcatExpression<T, Left, Right>>
+    {
+        using Type = ConcatExpression<T, Left, Right>;
+
+        template<typename X>
+        static Type Make(X&& expression)
+        {
+            return std::forward<X>(expression);
+        }
+    };
+
+    template<typename T, typename X, typename D = typename std::decay<X>::type>
+    struct ConcatOperandOf : ConcatOperandOfDecayed<T, D>
+    {
+    };
+    // string lvalues are referenced, temporaries are moved into the expression
+    template<typename T, typename X, typename RefCountPolicy>
+    struct ConcatOperandOf<T, X, String<T, RefCountPolicy>>
+    {
+        using Temporary = ConcatTemporary<T, RefCountPolicy>;
+        using Type = typename std::conditional<std::is_lvalue_reference<X>::value, ConcatSlice<T>, Temporary>::type;
+
+        static ConcatSlice<T> Make(const String<T, RefCountPolicy>& value) noexcept
+        {
+            return ConcatSlice<T>{ value.Buffer(), value.Length() };
+        }
+
+        static Temporary Make(String<T, RefCountPolicy>&& value) noexcept
+        {
+            return Temporary{ std::move(value) };
+        }
+
+        static Temporary Make(const String<T, RefCountPolicy>&& value)
+        {
+            return Temporary{ value };
+        }
+    };
+    /// <summary>
+    /// Concatenate strings, views, zero-terminated buffers and characters in any combination,
+    /// as long as one side is a string, a view or a concatenation.
+    /// </summary>
+    /// <returns>a lazy concatenation, see ConcatExpression</returns>
+    template<typename L, typename R,
+             typename T = typename ConcatCharType<L, R>::Type,
+             typename Left = typename ConcatOperandOf<T, L>::Type,
+             typename Right = typename ConcatOperandOf<T, R>::Type>
+    ConcatExpression<T, Left, Right> operator+(L&& lhs, R&& rhs)
+    {
+        return ConcatExpression<T, Left, Right>(ConcatOperandOf<T, L>::Make(std::forward<L>(lhs)),
+                                                ConcatOperandOf<T, R>::Make(std::forward<R>(rhs)));
+    }
+
+    /// <summary>
+    /// Searches for a needle which is preprocessed once and reused for any number of haystacks.
+    /// Candidates are first filtered by the needle's first and last characters a vector at a time; once they keep failing
+    /// verification the search falls back to the Two-Way algorithm, which keeps the worst case linear and constant in space,
+    /// with a bad-character shift table to skip ahead.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class StringSearcher
+    {
+    public:
+        static constexpr uint32_t InvalidIndex = String<T>::InvalidIndex;
+
+        explicit StringSearcher(const String<T>& needle) : needle_(needle)
+        {
+            const T* buffer = needle_.Buffer();
+            const uint32_t length = needle_.Length();
+            forward_ = Factorize(Forward{ buffer }, length);
+            backward_ = Factorize(Backward{ buffer + length }, length);
+            BuildShiftTable(Forward{ buffer }, length, forwardShift_);
+            BuildShiftTable(Backward{ buffer + length }, length, backwardShift_);
+        }
+
+        const String<T>& Needle() const noexcept
+        {
+            return needle_;
+        }
+        /// <summary>
+        /// Reports the zero-based index of the first occurrence of the needle.
+        /// </summary>
+        /// <param name="haystack">characters to search</param>
+        /// <param name="length">count of characters</param>
+        /// <returns>index of the needle, or InvalidIndex</returns>
+        uint32_t IndexOf(const T* haystack, uint32_t length) const noexcept
+        {
+            const T* needle = needle_.Buffer();
+            const uint32_t needleLength = needle_.Length();
+            if (needleLength == 0) return 0;
+            if (needleLength > length) return InvalidIndex;
+            if (needleLength == 1) return Simd::FindChar(haystack, length, needle[0]);
+            uint32_t start = 0;
+            uint32_t result = Simd::FindNeedle(haystack, length, needle, needleLength, start);
+            if (result != InvalidIndex || length - start < needleLength) return result;
+            result = TwoWay(Forward{ haystack + start }, length - start, Forward{ needle }, needleLength, forward_, forwardShift_);
+            return result == InvalidIndex ? InvalidIndex : start + result;
+        }
+
+        uint32_t IndexOf(StringView<T> haystack) const noexcept
+        {
+            return IndexOf(haystack.Buffer(), haystack.Length());
+        }
+        /// <summary>
+        /// Reports the zero-based index of the last occurrence of the needle.
+        /// </summary>
+        /// <param name="haystack">characters to search</param>
+        /// <param name="length">count of characters</param>
+        /// <returns>index of the needle, or InvalidIndex</returns>
+        uint32_t LastIndexOf(const T* haystack, uint32_t length) const noexcept
+        {
+            const T* needle = needle_.Buffer();
+            const uint32_t needleLength = needle_.Length();
+            if (needleLength == 0) return length - 1;
+            if (needleLength > length) return InvalidIndex;
+            if (needleLength == 1) return Simd::FindLastChar(haystack, length, needle[0]);
+            uint32_t windows = 0;
+            uint32_t result = Simd::FindLastNeedle(haystack, length, needle, needleLength, windows);
+            if (result != InvalidIndex || windows == 0) return result;
+            const uint32_t prefix = windows + needleLength - 1;
+            result = TwoWay(Backward{ haystack + prefix }, prefix, Backward{ needle + needleLength }, needleLength, backward_, backwardShift_);
+            return result == InvalidIndex ? InvalidIndex : prefix - result - needleLength;
+        }
+
+        uint32_t LastIndexOf(StringView<T> haystack) const noexcept
+        {
+            return LastIndexOf(haystack.Buffer(), haystack.Length());
+        }
+
+        bool Contains(StringView<T> haystack) const noexcept
+        {
+            return IndexOf(haystack) != InvalidIndex;
+        }
+        /// <summary>
+        /// One-shot search without keeping the preprocessing, it does not allocate.
+        /// </summary>
+        /// <returns>index of the first occurrence, 0 for an empty needle, or InvalidIndex</returns>
+        static uint32_t Find(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength) noexcept
+        {
+            if (needleLength == 0) return 0;
+            if (needleLength > length) return InvalidIndex;
+            if (needleLength == 1) return Simd::FindChar(haystack, length, needle[0]);
+            uint32_t start = 0;
+            uint32_t result = Simd::FindNeedle(haystack, length, needle, needleLength, start);
+            if (result != InvalidIndex || length - start < needleLength) return result;
+            Factorization factorization = Factorize(Forward{ needle }, needleLength);
+            result = TwoWay(Forward{ haystack + start }, length - start, Forward{ needle }, needleLength, factorization, nullptr);
+            return result == InvalidIndex ? InvalidIndex : start + result;
+        }
+        /// <summary>
+        /// One-shot backward search without keeping the preprocessing, it does not allocate.
+        /// </summary>
+        /// <returns>index of the last occurrence, length - 1 for an empty needle, or InvalidIndex</returns>
+        static uint32_t FindLast(const T* haystack, uint32_t length, const T* needle, uint32_t needleLength) noexcept
+        {
+            if (needleLength == 0) return length - 1;
+            if (needleLength > length) return InvalidIndex;
+            if (needleLength == 1) return Simd::FindLastChar(haystack, length, needle[0]);
+            uint32_t windows = 0;
+            uint32_t result = Simd::FindLastNeedle(haystack, length, needle, needleLength, windows);
+            if (result != InvalidIndex || windows == 0) return result;
+            const uint32_t prefix = windows + needleLength - 1;
+            Factorization factorization = Factorize(Backward{ needle + needleLength }, needleLength);
+            result = TwoWay(Backward{ haystack + prefix }, prefix, Backward{ needle + needleLength }, needleLength, factorization, nullptr);
+            return result == InvalidIndex ? InvalidIndex : prefix - result - needleLength;
+        }
+
+    private:
+        static constexpr uint32_t ShiftTableSize = 256;
+
+        struct Forward
+        {
+            const T* ptr;
+            T operator[](uint32_t i) const noexcept { return ptr[i]; }
+        };
+
+        struct Backward
+        {
+            const T* end;
+            T operator[](uint32_t i) const noexcept { return *(end - 1 - i); }
+        };
+
+        struct Factorization
+        {
+            uint32_t suffix;
+            uint32_t period;
+            bool periodic;
+        };
+
+        static uint32_t Bucket(T c) noexcept
+        {
+            return static_cast<Simd::Unit<T>>(c) & (ShiftTableSize - 1);
+        }
+
+        template<typename Access>
+        static void BuildShiftTable(Access needle, uint32_t length, uint32_t* table) noexcept
+        {
+            for (uint32_t i = 0; i < ShiftTableSize; ++i) table[i] = length;
+            for (uint32_t i = 0; i < length; ++i) table[Bucket(needle[i])] = length - i - 1;
+        }
+
+        template<typename Access>
+        static uint32_t MaximalSuffix(Access needle, uint32_t length, bool reversed, uint32_t& period) noexcept
+        {
+            uint32_t maxSuffix = InvalidIndex;
+            uint32_t j = 0, k = 1, p = 1;
+            while (j + k < length)
+            {
+                const T a = needle[j + k];
+                const T b = needle[maxSuffix + k];
+                if (reversed ? b < a : a < b)
+                {
+                    j += k;
+                    k = 1;
+                    p = j - maxSuffix;
+                }
+                else if (a == b)
+                {
+                    if (k != p)
+                    {
+                        ++k;
+                    }
+                    else
+                    {
+                        j += p;
+                        k = 1;
+                    }
+                }
+                else
+                {
+                    maxSuffix = j++;
+                    k = p = 1;
+                }
+            }
+            period = p;
+            return maxSuffix;
+        }
+        /// <summary>
+        /// Critical factorization of the needle, the right half starts at suffix.
+        /// </summary>
+        template<typename Access>
+        static Factorization Factorize(Access needle, uint32_t length) noexcept
+        {
+            Factorization result = { 0, 1, false };
+            if (length < 3)
+            {
+                result.suffix = length ? length - 1 : 0;
+            }
+            else
+            {
+                uint32_t period, reversedPeriod;
+                const uint32_t suffix = MaximalSuffix(needle, length, false, period);
+                const uint32_t reversedSuffix = MaximalSuffix(needle, length, true, reversedPeriod);
+                if (reversedSuffix + 1 < suffix + 1)
+                {
+                    result.suffix = suffix + 1;
+                    result.period = period;
+                }
+                else
+                {
+                    result.suffix = reversedSuffix + 1;
+                    result.period = reversedPeriod;
+                }
+            }
+            if (result.suffix + result.period <= length)
+            {
+                uint32_t i = 0;
+                while (i < result.suffix && needle[i] == needle[i + result.period]) ++i;
+                result.periodic = i == result.suffix;
+            }
+            return result;
+        }
+
+        template<typename Access>
+        static uint32_t TwoWay(Access haystack, uint32_t length, Access needle, uint32_t needleLength,
+                               const Factorization& factorization, const uint32_t* shiftTable) noexcept
+        {
+            const uint32_t suffix = factorization.suffix;
+            const uint32_t lastWindow = length - needleLength;
+            uint32_t j = 0;
+            if (factorization.periodic)
+            {
+                const uint32_t period = factorization.period;
+                uint32_t memory = 0;
+                while (j <= lastWindow)
+                {
+                    if (shiftTable)
+                    {
+                        uint32_t shift = shiftTable[Bucket(haystack[j + needleLength - 1])];
+                        if (shift)
+                        {
+                            if (memory && shift < period) shift = needleLength - period;
+                            memory = 0;
+                            j += shift;
+                            continue;
+                        }
+                    }
+                    uint32_t i = suffix > memory ? suffix : memory;
+                    while (i < needleLength && needle[i] == haystack[i + j]) ++i;
+                    if (i >= needleLength)
+                    {
+                        i = suffix - 1;
+                        while (memory < i + 1 && needle[i] == haystack[i + j]) --i;
+                        if (i + 1 < memory + 1) return j;
+                        j += period;
+                        memory = needleLength - period;
+                    }
+                    else
+                    {
+                        j += i - suffix + 1;
+                        memory = 0;
+                    }
+                }
+            }
+            else
+            {
+                const uint32_t period = (suffix > needleLength - suffix ? suffix : needleLength - suffix) + 1;
+                while (j <= lastWindow)
+                {
+                    if (shiftTable)
+                    {
+                        uint32_t shift = shiftTable[Bucket(haystack[j + needleLength - 1])];
+                        if (shift)
+                        {
+                            j += shift;
+                            continue;
+                        }
+                    }
+                    uint32_t i = suffix;
+                    while (i < needleLength && needle[i] == haystack[i + j]) ++i;
+                    if (i >= needleLength)
+                    {
+                        i = suffix - 1;
+                        while (i != InvalidIndex && needle[i] == haystack[i + j]) --i;
+                        if (i == InvalidIndex) return j;
+                        j += period;
+                    }
+                    else
+                    {
+                        j += i - suffix + 1;
+                    }
+                }
+            }
+            return InvalidIndex;
+        }
+
+        String<T> needle_;
+        Factorization forward_;
+        Factorization backward_;
+        uint32_t forwardShift_[ShiftTableSize];
+        uint32_t backwardShift_[ShiftTableSize];
+    };
+
+    /// <summary>
+    /// Finds a single delimiting character for StringSplitter.
+    /// </summary>
+    template<typename T>
+    struct CharDelimiter
+    {
+        T c;
+
+        uint32_t Find(const T* text, uint32_t length, uint32_t& delimiterLength) const noexcept
+        {
+            delimiterLength = 1;
+            return Simd::FindChar(text, length, c);
+        }
+    };
+    /// <summary>
+    /// Finds a delimiting string for StringSplitter, an empty one is never found.
+    /// </summary>
+    template<typename T>
+    struct SeparatorDelimiter
+    {
+        StringView<T> separator;
+
+        uint32_t Find(const T* text, uint32_t length, uint32_t& delimiterLength) const noexcept
+        {
+            delimiterLength = separator.Length();
+            if (!delimiterLength) return StringView<T>::InvalidIndex;
+            return StringSearcher<T>::Find(text, length, separator.Buffer(), delimiterLength);
+        }
+    };
+    /// <summary>
+    /// Finds any character of a set for StringSplitter.
+    /// </summary>
+    template<typename T>
+    struct AnyCharDelimiter
+    {
+        StringView<T> set;
+
+        uint32_t Find(const T* text, uint32_t length, uint32_t& delimiterLength) const noexcept
+        {
+            delimiterLength = 1;
+            return Simd::FindAnyChar(text, length, set.Buffer(), set.Length());
+        }
+    };
+    /// <summary>
+    /// Enumerates the tokens of a text between delimiters as views, each is found when it is reached so nothing is allocated
+    /// nor copied; only GetEnumerator allocates, the enumerator itself. The text and the delimiters are referred to,
+    /// they must outlive the splitter and the iterators got from it.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    /// <typeparam name="Delimiter">How the next delimiter is found: CharDelimiter, SeparatorDelimiter or AnyCharDelimiter</typeparam>
+    template<typename T, typename Delimiter>
+    class StringSplitter : public IEnumerable<StringView<T>>
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = StringView<T>;
+            using difference_type = ptrdiff_t;
+            using pointer = const StringView<T>*;
+            using reference = const StringView<T>&;
+
+            Iterator() noexcept : splitter_(nullptr), position_(0), count_(0)
+            {
+            }
+
+            explicit Iterator(const StringSplitter* splitter) noexcept : splitter_(splitter), position_(0), count_(0)
+            {
+                ++*this;
+            }
+
+            const StringView<T>& operator*() const noexcept
+            {
+                return token_;
+            }
+
+            const StringView<T>* operator->() const noexcept
+            {
+                return &token_;
+            }
+
+            Iterator& operator++() noexcept
+            {
+                if (!splitter_->Next(position_, count_, token_))
+                {
+                    splitter_ = nullptr;
+                    count_ = 0;
+                }
+                return *this;
+            }
+
+            Iterator operator++(int) noexcept
+            {
+                Iterator old = *this;
+                ++*this;
+                return old;
+            }
+            // the count of tokens passed tells apart two positions of one enumeration
+            friend bool operator==(const Iterator& lhs, const Iterator& rhs) noexcept
+            {
+                return lhs.splitter_ == rhs.splitter_ && lhs.count_ == rhs.count_;
+            }
+
+            friend bool operator!=(const Iterator& lhs, const Iterator& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+        private:
+            const StringSplitter* splitter_;
+            uint32_t position_;
+            uint32_t count_;
+            StringView<T> token_;
+        };
+
+        class Enumerator : public IEnumerator<StringView<T>>
+        {
+        public:
+            explicit Enumerator(const StringSplitter& splitter) noexcept : splitter_(splitter), position_(0), count_(0)
+            {
+            }
+
+            bool MoveNext() override
+            {
+                return splitter_.Next(position_, count_, current_);
+            }
+
+            StringView<T>& Current() override
+            {
+                return current_;
+            }
+
+            void Reset() override
+            {
+                position_ = 0;
+                count_ = 0;
+                current_ = StringView<T>();
+            }
+
+        private:
+            StringSplitter splitter_;
+            uint32_t position_;
+            uint32_t count_;
+            StringView<T> current_;
+        };
+
+        StringSplitter(StringView<T> text, Delimiter delimiter, SplitOptions options, uint32_t maxCount) noexcept
+            : text_(text), delimiter_(delimiter), options_(options), maxCount_(maxCount)
+        {
+        }
+
+        Iterator begin() const noexcept
+        {
+            return Iterator(this);
+        }
+
+        Iterator end() const noexcept
+        {
+            return Iterator();
+        }
+
+        Ref<IEnumerator<StringView<T>>> GetEnumerator() override
+        {
+            return MakeRef<Enumerator>(*this);
+        }
+        /// <summary>
+        /// Count the tokens without keeping them, for example to reserve room before collecting them.
+        /// </summary>
+        uint32_t Count() const noexcept
+        {
+            uint32_t position = 0;
+            uint32_t count = 0;
+            StringView<T> token;
+            while (Next(position, count, token))
+            {
+            }
+            return count;
+        }
+
+    private:
+        // the position after the last token, texts are shorter than MaxSize
+        static constexpr uint32_t Finished = StringView<T>::MaxSize;
+        static constexpr uint32_t NotFound = StringView<T>::InvalidIndex;
+        /// <summary>
+        /// Find the token starting at position, then move position past the delimiter which ends it.
+        /// </summary>
+        /// <param name="count">tokens enumerated so far</param>
+        /// <returns>false when there is no more token</returns>
+        bool Next(uint32_t& position, uint32_t& count, StringView<T>& token) const noexcept
+        {
+            const bool removeEmpty = options_ == SplitOptions::RemoveEmpty;
+            while (position != Finished && count < maxCount_)
+            {
+                const T* start = text_.Buffer() + position;
+                const uint32_t rest = text_.Length() - position;
+                const bool last = count + 1 == maxCount_;
+                uint32_t delimiterLength = 0;
+                // the last token needs no search unless empty tokens before it are skipped
+                const uint32_t end = !last || removeEmpty ? delimiter_.Find(start, rest, delimiterLength) : NotFound;
+                if (end == 0 && removeEmpty)
+                {
+                    position += delimiterLength;
+                    continue;
+                }
+                if (end == NotFound || last)
+                {
+                    position = Finished;
+                    if (rest == 0 && removeEmpty) return false;
+                    token = StringView<T>(start, rest);
+                }
+                else
+                {
+                    token = StringView<T>(start, end);
+                    position += end + delimiterLength;
+                }
+                ++count;
+                return true;
+            }
+            return false;
+        }
+
+        StringView<T> text_;
+        Delimiter delimiter_;
+        SplitOptions options_;
+        uint32_t maxCount_;
+    };
+
+    // the characters of a short string are found from its address, never through a pointer to itself
+    template<typename T, typename RefCountPolicy>
+    struct IsTriviallyRelocatable<String<T, RefCountPolicy>> : std::true_type
+    {
+    };
+
+    using AString = String<char>;
+    using WString = String<wchar_t>;
+    /// <summary>
+    /// A string confined to one thread, copies share buffers without atomic operations.
+    /// </summary>
+    template<typename T>
+    using LocalString = String<T, LocalRefCount>;
+    using LocalAString = LocalString<char>;
+    using LocalWString = LocalString<wchar_t>;
+}
+
+namespace std
+{
+    template<typename T, typename RefCountPolicy>
+    struct hash<Ytc::String<T, RefCountPolicy>>
+    {
+        size_t operator()(const Ytc::String<T, RefCountPolicy>& value) const noexcept
+        {
+            return value.GetHashCode();
+        }
+    };
+
+    template<typename T>
+    struct hash<Ytc::StringView<T>>
+    {
+        size_t operator()(Ytc::StringView<T> value) const noexcept
+        {
+            return value.GetHashCode();
+        }
+    };
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "YtcString.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace Ytc
+{
+    /// <summary>
+    /// Builds a string piece by piece, the buffer grows geometrically so each append costs amortized constant time per character.
+    /// </summary>
+    /// <typeparam name="T">The type of character</typeparam>
+    template<typename T>
+    class StringBuilder
+    {
+    public:
+        StringBuilder() noexcept
+        {
+        }
+
+        explicit StringBuilder(uint32_t capacity)
+        {
+            Reserve(capacity);
+        }
+
+        uint32_t Length() const noexcept
+        {
+            return value_.Length();
+        }
+        /// <summary>
+        /// Count of characters which fit without reallocation.
+        /// </summary>
+        uint32_t Capacity() const noexcept
+        {
+            return (value_.IsHeapAllocated() ? value_.storage_.variableBuffer.Capacity() : String<T>::StaticBufferSize) - 1;
+        }
+
+        const T* Buffer() const noexcept
+        {
+            return value_.Buffer();
+        }
+
+        StringView<T> View() const noexcept
+        {
+            return value_;
+        }
+        /// <summary>
+        /// Make room for at least the specified count of characters.
+        /// </summary>
+        /// <param name="capacity">count of characters</param>
+        void Reserve(uint32_t capacity)
+        {
+            if (capacity > Capacity())
+            {
+                value_.Reallocate(capacity + 1, value_.Resource());
+            }
+        }
+        /// <summary>
+        /// Remove all characters, the capacity is kept.
+        /// </summary>
+        void Clear() noexcept
+        {
+            value_.length_ = 0;
+            value_.MutableBuffer()[0] = 0;
+        }
+
+        StringBuilder<T>& Append(const T* buffer, uint32_t length)
+        {
+            value_.Append(buffer, length);
+            return *this;
+        }
+
+        StringBuilder<T>& Append(StringView<T> value)
+        {
+            return Append(value.Buffer(), value.Length());
+        }
+
+        StringBuilder<T>& Append(T value, uint32_t count = 1)
+        {
+            value_.Append(value, count);
+            return *this;
+        }
+        /// <summary>
+        /// Append a count of characters which the caller writes right away, the terminator is already in place.
+        /// </summary>
+        /// <param name="count">count of characters</param>
+        /// <returns>the first character to write</returns>
+        T* AppendUninitialized(uint32_t count)
+        {
+            T* tail = value_.Expand(count);
+            tail[count] = 0;
+            return tail;
+        }
+        /// <summary>
+        /// Append the decimal representation of an integer.
+        /// </summary>
+        /// <param name="value">the integer</param>
+        /// <param name="minimumDigits">pad with leading zeros up to this count of digits</param>
+        template<typename Integer>
+        typename std::enable_if<std::is_integral<Integer>::value, StringBuilder<T>&>::type
+            AppendNumber(Integer value, uint32_t minimumDigits = 0)
+        {
+            const bool negative = value < 0;
+            const uint64_t magnitude = negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            const uint32_t count = Number::CountDigits(magnitude);
+            const uint32_t width = minimumDigits > count ? minimumDigits : count;
+            const uint32_t length = width + (negative ? 1 : 0);
+            T* tail = value_.Expand(length);
+            tail[length] = 0;
+            if (negative) *tail++ = T('-');
+            for (uint32_t i = count; i < width; ++i) *tail++ = T('0');
+            Number::WriteDigits(magnitude, tail + count);
+            return *this;
+        }
+        /// <summary>
+        /// Append a floating-point number in fixed-point notation.
+        /// </summary>
+        /// <param name="value">the number</param>
+        /// <param name="precision">count of digits after the decimal point, at most MaxPrecision</param>
+        StringBuilder<T>& AppendNumber(double value, uint32_t precision = 6)
+        {
+            // the longest fixed-point double has 309 integral digits
+            char text[320 + MaxPrecision];
+            const uint32_t length = Number::FormatFixed(value, static_cast<int>(precision < MaxPrecision ? precision : uint32_t(MaxPrecision)), text, sizeof(text));
+            if (length)
+            {
+                T* tail = value_.Expand(length);
+                for (uint32_t i = 0; i < length; ++i) tail[i] = static_cast<T>(text[i]);
+                tail[length] = 0;
+            }
+            return *this;
+        }
+        /// <summary>
+        /// Hand the buffer over to a string without copying it, the builder is empty afterward.
+        /// </summary>
+        /// <returns>the built string</returns>
+        String<T> ToString() noexcept
+        {
+            return std::move(value_);
+        }
+
+        static constexpr uint32_t MaxPrecision = 64;
+
+    private:
+        String<T> value_;
+    };
+}
@@ -0,0 +1,633 @@
+#pragma once
+
+#include "YtcString.hpp"
+#include "YtcStringBuilder.hpp"
+
+#include <cstdint>
+
+namespace Ytc
+{
+    /// <summary>
+    /// Validated transcoding between UTF-8 and the wide encodings: UTF-16 for 2-byte characters, UTF-32 for 4-byte characters.
+    /// Each conversion measures the exact output first and writes it into one buffer, runs of ASCII are copied a vector at a time.
+    /// </summary>
+    namespace Unicode
+    {
+        constexpr uint32_t MaxCodePoint = 0x10FFFF;
+        /// <summary>
+        /// Returned by DecodeUtf8 for a sequence which is valid so far but cut by the end of the input.
+        /// </summary>
+        constexpr uint32_t Incomplete = uint32_t(-1);
+
+        template<typename T>
+        struct IsWideUnit
+        {
+            static constexpr bool value = sizeof(T) == 2 || sizeof(T) == 4;
+        };
+
+        template<typename T>
+        inline uint32_t AsciiPrefixScalar(const T* text, uint32_t length) noexcept
+        {
+            for (uint32_t i = 0; i < length; ++i)
+            {
+                if (static_cast<Simd::Unit<T>>(text[i]) >= 0x80) return i;
+            }
+            return length;
+        }
+
+        template<typename Source, typename Dest>
+        inline Dest* CopyAsciiScalar(const Source* source, uint32_t length, Dest* dest) noexcept
+        {
+            for (uint32_t i = 0; i < length; ++i) dest[i] = static_cast<Dest>(source[i]);
+            return dest + length;
+        }
+
+#ifdef YTC_SIMD_X86
+        template<typename T>
+        YTC_TARGET_SSE2 uint32_t AsciiPrefixSse2(const T* text, uint32_t length) noexcept
+        {
+            constexpr uint32_t Lanes = 16 / sizeof(T);
+            const __m128i high = Simd::Broadcast128(static_cast<Simd::Unit<T>>(~0x7Fu));
+            const __m128i zero = _mm_setzero_si128();
+            uint32_t i = 0;
+            for (; i + Lanes <= length; i += Lanes)
+            {
+                __m128i chunk = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i)), high);
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(Simd::CompareEqual128(chunk, zero, Simd::Unit<T>()))) ^ 0xFFFFu;
+                if (mask) return i + Simd::LowestBit(mask) / sizeof(T);
+            }
+            return i + AsciiPrefixScalar(text + i, length - i);
+        }
+        /// <summary>
+        /// Zero-extend ASCII bytes into wide characters.
+        /// </summary>
+        template<typename T>
+        YTC_TARGET_SSE2 T* WidenAsciiSse2(const char* source, uint32_t length, T* dest) noexcept
+        {
+            const __m128i zero = _mm_setzero_si128();
+            uint32_t i = 0;
+            for (; i + 16 <= length; i += 16)
+            {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+                __m128i low = _mm_unpacklo_epi8(bytes, zero);
+                __m128i high = _mm_unpackhi_epi8(bytes, zero);
+                __m128i* out = reinterpret_cast<__m128i*>(dest + i);
+                if (sizeof(T) == 2)
+                {
+                    _mm_storeu_si128(out, low);
+                    _mm_storeu_si128(out + 1, high);
+                }
+                else
+                {
+                    _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+                    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+                    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+                    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+                }
+            }
+            return CopyAsciiScalar(source + i, length - i, dest + i);
+        }
+        /// <summary>
+        /// Narrow wide characters known to be ASCII into bytes.
+        /// </summary>
+        template<typename T>
+        YTC_TARGET_SSE2 char* NarrowAsciiSse2(const T* source, uint32_t length, char* dest) noexcept
+        {
+            uint32_t i = 0;
+            for (; i + 16 <= length; i += 16)
+            {
+                const __m128i* in = reinterpret_cast<const __m128i*>(source + i);
+                __m128i low, high;
+                if (sizeof(T) == 2)
+                {
+                    low = _mm_loadu_si128(in);
+                    high = _mm_loadu_si128(in + 1);
+                }
+                else
+                {
+                    low = _mm_packs_epi32(_mm_loadu_si128(in), _mm_loadu_si128(in + 1));
+                    high = _mm_packs_epi32(_mm_loadu_si128(in + 2), _mm_loadu_si128(in + 3));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(low, high));
+            }
+            return CopyAsciiScalar(source + i, length - i, dest + i);
+        }
+
+        template<int N>
+        YTC_TARGET_AVX2 inline __m256i PreviousBytes(__m256i input, __m256i previous) noexcept
+        {
+            return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+        }
+
+        YTC_TARGET_AVX2 inline __m256i Lookup16(const uint8_t (&table)[16], __m256i nibbles) noexcept
+        {
+            return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table))), nibbles);
+        }
+        /// <summary>
+        /// Validate whole blocks of 32 bytes and count the wide characters they decode to, after Keiser and Lemire,
+        /// "Validating UTF-8 in less than one instruction per byte": three table lookups indexed by the nibbles of each byte
+        /// and of the byte before classify every pair of bytes, the continuations required by 3 and 4-byte leads are checked apart.
+        /// </summary>
+        /// <param name="examined">receives where the caller must go on, the start of the sequence holding the last byte of the blocks</param>
+        /// <param name="count">receives the count of wide characters before examined</param>
+        /// <returns>whether the bytes are valid UTF-8</returns>
+        template<typename T>
+        YTC_TARGET_AVX2 bool MeasureUtf8Avx2(const uint8_t* text, uint32_t length, uint32_t& examined, uint32_t& count) noexcept
+        {
+            constexpr uint8_t TooShort = 1 << 0, TooLong = 1 << 1, Overlong3 = 1 << 2, TooLarge = 1 << 3, Surrogate = 1 << 4,
+                Overlong2 = 1 << 5, TooLarge1000 = 1 << 6, Overlong4 = 1 << 6, TwoContinuations = 1 << 7;
+            constexpr uint8_t Carry = TooShort | TooLong | TwoContinuations;
+            static const uint8_t firstHigh[16] =
+            {
+                TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong, TooLong,
+                TwoContinuations, TwoContinuations, TwoContinuations, TwoContinuations,
+                TooShort | Overlong2, TooShort, TooShort | Overlong3 | Surrogate, TooShort | TooLarge | TooLarge1000 | Overlong4
+            };
+            static const uint8_t firstLow[16] =
+            {
+                Carry | Overlong3 | Overlong2 | Overlong4, Carry | Overlong2, Carry, Carry,
+                Carry | TooLarge, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000,
+                Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000 | Surrogate, Carry | TooLarge | TooLarge1000, Carry | TooLarge | TooLarge1000
+            };
+            static const uint8_t secondHigh[16] =
+            {
+                TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort, TooShort,
+                TooLong | Overlong2 | TwoContinuations | Overlong3 | TooLarge1000 | Overlong4,
+                TooLong | Overlong2 | TwoContinuations | Overlong3 | TooLarge,
+                TooLong | Overlong2 | TwoContinuations | Surrogate | TooLarge,
+                TooLong | Overlong2 | TwoContinuations | Surrogate | TooLarge,
+                TooShort, TooShort, TooShort, TooShort
+            };
+            // a lead byte in the last 3 positions of a block needs bytes of the next block
+            static const uint8_t incompleteBelow[32] =
+            {
+                255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+                255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+            };
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            const __m256i maxIncomplete = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(incompleteBelow));
+            __m256i previous = zero, previousIncomplete = zero, error = zero;
+            __m256i continuations = zero, fourByteLeads = zero, continuationTotal = zero, fourByteTotal = zero;
+            uint32_t blocks = 0;
+            uint32_t i = 0;
+            for (; i + 32 <= length; i += 32)
+            {
+                const __m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+                if (!_mm256_movemask_epi8(input))
+                {
+                    error = _mm256_or_si256(error, previousIncomplete);
+                    previousIncomplete = zero;
+                }
+                else
+                {
+                    const __m256i previous1 = PreviousBytes<1>(input, previous);
+                    const __m256i special = _mm256_and_si256(_mm256_and_si256(
+                        Lookup16(firstHigh, _mm256_and_si256(_mm256_srli_epi16(previous1, 4), nibble)),
+                        Lookup16(firstLow, _mm256_and_si256(previous1, nibble))),
+                        Lookup16(secondHigh, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+                    const __m256i third = _mm256_subs_epu8(PreviousBytes<2>(input, previous), _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+                    const __m256i fourth = _mm256_subs_epu8(PreviousBytes<3>(input, previous), _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+                    const __m256i required = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+                    error = _mm256_or_si256(error, _mm256_xor_si256(required, special));
+                    previousIncomplete = _mm256_subs_epu8(input, maxIncomplete);
+                    // continuation bytes are the signed values below -64, each lane counts at most 255 blocks
+                    continuations = _mm256_sub_epi8(continuations, _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), input));
+                    if (sizeof(T) == 2)
+                    {
+                        const __m256i lead4 = _mm256_set1_epi8(static_cast<char>(0xF0));
+                        fourByteLeads = _mm256_sub_epi8(fourByteLeads, _mm256_cmpeq_epi8(_mm256_max_epu8(input, lead4), input));
+                    }
+                }
+                previous = input;
+                if (++blocks == 255)
+                {
+                    continuationTotal = _mm256_add_epi64(continuationTotal, _mm256_sad_epu8(continuations, zero));
+                    fourByteTotal = _mm256_add_epi64(fourByteTotal, _mm256_sad_epu8(fourByteLeads, zero));
+                    continuations = fourByteLeads = zero;
+                    blocks = 0;
+                }
+            }
+            continuationTotal = _mm256_add_epi64(continuationTotal, _mm256_sad_epu8(continuations, zero));
+            fourByteTotal = _mm256_add_epi64(fourByteTotal, _mm256_sad_epu8(fourByteLeads, zero));
+            if (!_mm256_testz_si256(error, error)) return false;
+
+            uint64_t totals[8];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(totals), continuationTotal);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(totals + 4), fourByteTotal);
+            uint64_t wide = i - (totals[0] + totals[1] + totals[2] + totals[3]) + (totals[4] + totals[5] + totals[6] + totals[7]);
+            // the scalar decoder takes over from the lead of the last sequence, which may go on after the blocks
+            uint32_t restart = i;
+            while (restart > 0 && restart + 3 > i && (text[restart - 1] & 0xC0) == 0x80) --restart;
+            if (restart > 0 && text[restart - 1] >= 0xC0)
+            {
+                --restart;
+                wide -= sizeof(T) == 2 && text[restart] >= 0xF0 ? 2 : 1;
+            }
+            else
+            {
+                restart = i;
+            }
+            examined = restart;
+            count = static_cast<uint32_t>(wide);
+            return true;
+        }
+#endif
+        /// <summary>
+        /// Count of leading ASCII characters.
+        /// </summary>
+        template<typename T>
+        inline uint32_t AsciiPrefix(const T* text, uint32_t length) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            if (length * sizeof(T) >= 16 && Simd::CpuFeatures::Current().sse2) return AsciiPrefixSse2(text, length);
+#endif
+            return AsciiPrefixScalar(text, length);
+        }
+
+        /// <summary>
+        /// Count of leading ASCII characters of a run starting at an ASCII character, a lone one is not worth a vector scan.
+        /// </summary>
+        template<typename T>
+        inline uint32_t AsciiRun(const T* text, uint32_t length) noexcept
+        {
+            constexpr uint32_t WordLanes = sizeof(uint64_t) / sizeof(T);
+            constexpr uint64_t HighBits = sizeof(T) == 1 ? 0x8080808080808080ull : sizeof(T) == 2 ? 0xFF80FF80FF80FF80ull : 0xFFFFFF80FFFFFF80ull;
+            uint64_t word;
+            if (length < WordLanes) return 1;
+            memcpy(&word, text, sizeof(word));
+            word &= HighBits;
+            if (word)
+            {
+#ifdef YTC_LITTLE_ENDIAN
+                return Simd::LowestBit64(word) / (8 * sizeof(T));
+#else
+                return 1;
+#endif
+            }
+            return WordLanes + AsciiPrefix(text + WordLanes, length - WordLanes);
+        }
+
+        template<typename T>
+        inline T* WidenAscii(const char* source, uint32_t length, T* dest) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            if (length >= 16 && Simd::CpuFeatures::Current().sse2) return WidenAsciiSse2(source, length, dest);
+#endif
+            return CopyAsciiScalar(source, length, dest);
+        }
+
+        template<typename T>
+        inline char* NarrowAscii(const T* source, uint32_t length, char* dest) noexcept
+        {
+#ifdef YTC_SIMD_X86
+            if (length >= 16 && Simd::CpuFeatures::Current().sse2) return NarrowAsciiSse2(source, length, dest);
+#endif
+            return CopyAsciiScalar(source, length, dest);
+        }
+        /// <summary>
+        /// Decode one UTF-8 sequence, overlong forms, surrogates and code points above MaxCodePoint are rejected.
+        /// </summary>
+        /// <param name="codePoint">receives the decoded code point</param>
+        /// <returns>count of bytes of the sequence, 0 if it is invalid, or Incomplete if the input ends in the middle of it</returns>
+        inline uint32_t DecodeUtf8(const uint8_t* text, const uint8_t* end, uint32_t& codePoint) noexcept
+        {
+            const uint8_t lead = text[0];
+            const size_t available = static_cast<size_t>(end - text);
+            if (lead < 0x80)
+            {
+                codePoint = lead;
+                return 1;
+            }
+            if (lead < 0xE0)
+            {
+                if (lead < 0xC2) return 0;
+                if (available < 2) return Incomplete;
+                if ((text[1] & 0xC0) != 0x80) return 0;
+                codePoint = ((lead & 0x1Fu) << 6) | (text[1] & 0x3Fu);
+                return 2;
+            }
+            if (lead < 0xF0)
+            {
+                // the second byte excludes overlong forms after E0 and surrogates after ED
+                const uint8_t low = lead == 0xE0 ? 0xA0 : 0x80, high = lead == 0xED ? 0x9F : 0xBF;
+                if (available < 2) return Incomplete;
+                if (text[1] < low || text[1] > high) return 0;
+                if (available < 3) return Incomplete;
+                if ((text[2] & 0xC0) != 0x80) return 0;
+                codePoint = ((lead & 0x0Fu) << 12) | ((text[1] & 0x3Fu) << 6) | (text[2] & 0x3Fu);
+                return 3;
+            }
+            if (lead < 0xF5)
+            {
+                // the second byte excludes overlong forms after F0 and code points above MaxCodePoint after F4
+                const uint8_t low = lead == 0xF0 ? 0x90 : 0x80, high = lead == 0xF4 ? 0x8F : 0xBF;
+                if (available < 2) return Incomplete;
+                if (text[1] < low || text[1] > high) return 0;
+                if (available < 3) return Incomplete;
+                if ((text[2] & 0xC0) != 0x80) return 0;
+                if (available < 4) return Incomplete;
+                if ((text[3] & 0xC0) != 0x80) return 0;
+                codePoint = ((lead & 0x07u) << 18) | ((text[1] & 0x3Fu) << 12) | ((text[2] & 0x3Fu) << 6) | (text[3] & 0x3Fu);
+                return 4;
+            }
+            return 0;
+        }
+        /// <summary>
+        /// Decode one multi-byte sequence already validated by DecodeUtf8.
+        /// </summary>
+        /// <returns>count of bytes of the sequence</returns>
+        inline uint32_t DecodeValidSequence(const uint8_t* text, uint32_t& codePoint) noexcept
+        {
+            const uint8_t lead = text[0];
+            if (lead < 0xE0)
+            {
+                codePoint = ((lead & 0x1Fu) << 6) | (text[1] & 0x3Fu);
+                return 2;
+            }
+            if (lead < 0xF0)
+            {
+                codePoint = ((lead & 0x0Fu) << 12) | ((text[1] & 0x3Fu) << 6) | (text[2] & 0x3Fu);
+                return 3;
+            }
+            codePoint = ((lead & 0x07u) << 18) | ((text[1] & 0x3Fu) << 12) | ((text[2] & 0x3Fu) << 6) | (text[3] & 0x3Fu);
+            return 4;
+        }
+        /// <summary>
+        /// Decode one code point of UTF-16 or UTF-32, unpaired surrogates and code points above MaxCodePoint are rejected.
+        /// </summary>
+        /// <returns>count of units of the code point, or 0 if it is invalid</returns>
+        template<typename T>
+        inline uint32_t DecodeWide(const T* text, const T* end, uint32_t& codePoint) noexcept
+        {
+            codePoint = static_cast<Simd::Unit<T>>(*text);
+            if (codePoint < 0xD800) return 1;
+            if (sizeof(T) == 2 && codePoint < 0xDC00)
+            {
+                if (text + 1 == end) return 0;
+                const uint32_t trail = static_cast<Simd::Unit<T>>(text[1]);
+                if (trail < 0xDC00 || trail > 0xDFFF) return 0;
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (trail - 0xDC00);
+                return 2;
+            }
+            return codePoint > 0xDFFF && codePoint <= MaxCodePoint ? 1 : 0;
+        }
+
+        template<typename T>
+        inline uint32_t WideLength(uint32_t codePoint) noexcept
+        {
+            return sizeof(T) == 2 && codePoint > 0xFFFF ? 2 : 1;
+        }
+
+        inline uint32_t Utf8Length(uint32_t codePoint) noexcept
+        {
+            return codePoint < 0x80 ? 1 : codePoint < 0x800 ? 2 : codePoint < 0x10000 ? 3 : 4;
+        }
+
+        template<typename T>
+        inline T* WriteWide(T* dest, uint32_t codePoint) noexcept
+        {
+            if (sizeof(T) == 2 && codePoint > 0xFFFF)
+            {
+                codePoint -= 0x10000;
+                dest[0] = static_cast<T>(0xD800 + (codePoint >> 10));
+                dest[1] = static_cast<T>(0xDC00 + (codePoint & 0x3FF));
+                return dest + 2;
+            }
+            *dest = static_cast<T>(codePoint);
+            return dest + 1;
+        }
+
+        inline char* WriteUtf8(char* dest, uint32_t codePoint) noexcept
+        {
+            if (codePoint < 0x80)
+            {
+                *dest++ = static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                *dest++ = static_cast<char>(0xC0 | (codePoint >> 6));
+                *dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                *dest++ = static_cast<char>(0xE0 | (codePoint >> 12));
+                *dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                *dest++ = static_cast<char>(0xF0 | (codePoint >> 18));
+                *dest++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                *dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                *dest++ = static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            return dest;
+        }
+        /// <summary>
+        /// Validate UTF-8 and count the wide characters it decodes to.
+        /// </summary>
+        /// <param name="consumed">receives the count of bytes before a sequence cut by the end of the input, or the length</param>
+        /// <returns>count of wide characters</returns>
+        template<typename T>
+        uint32_t MeasureUtf8(const char* text, uint32_t length, uint32_t& consumed)
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text);
+            uint32_t count = 0;
+            uint32_t i = 0;
+#ifdef YTC_SIMD_X86
+            if (length >= 64 && Simd::CpuFeatures::Current().avx2 && !MeasureUtf8Avx2<T>(bytes, length, i, count))
+            {
+                throw Exception(L"Invalid UTF-8 sequence!");
+            }
+#endif
+            while (i < length)
+            {
+                if (bytes[i] < 0x80)
+                {
+                    const uint32_t ascii = AsciiRun(text + i, length - i);
+                    count += ascii;
+                    i += ascii;
+                    continue;
+                }
+                uint32_t codePoint;
+                const uint32_t sequence = DecodeUtf8(bytes + i, bytes + length, codePoint);
+                if (sequence == Incomplete) break;
+                if (!sequence) throw Exception(L"Invalid UTF-8 sequence!");
+                count += WideLength<T>(codePoint);
+                i += sequence;
+            }
+            consumed = i;
+            return count;
+        }
+        /// <summary>
+        /// Decode UTF-8 already validated by MeasureUtf8.
+        /// </summary>
+        /// <returns>the end of the destination</returns>
+        template<typename T>
+        T* DecodeValidUtf8(const char* text, uint32_t length, T* dest) noexcept
+        {
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text);
+            uint32_t i = 0;
+            while (i < length)
+            {
+                if (bytes[i] < 0x80)
+                {
+                    const uint32_t ascii = AsciiRun(text + i, length - i);
+                    dest = WidenAscii(text + i, ascii, dest);
+                    i += ascii;
+                    continue;
+                }
+                uint32_t codePoint;
+                i += DecodeValidSequence(bytes + i, codePoint);
+                dest = WriteWide(dest, codePoint);
+            }
+            return dest;
+        }
+        /// <summary>
+        /// Validate wide characters and count the UTF-8 bytes they encode to.
+        /// </summary>
+        template<typename T>
+        uint32_t MeasureWide(const T* text, uint32_t length)
+        {
+            uint64_t count = 0;
+            uint32_t i = 0;
+            while (i < length)
+            {
+                if (static_cast<Simd::Unit<T>>(text[i]) < 0x80)
+                {
+                    const uint32_t ascii = AsciiRun(text + i, length - i);
+                    count += ascii;
+                    i += ascii;
+                    continue;
+                }
+                uint32_t codePoint;
+                const uint32_t units = DecodeWide(text + i, text + length, codePoint);
+                if (!units) throw Exception(sizeof(T) == 2 ? L"Unpaired UTF-16 surrogate!" : L"Invalid code point!");
+                count += Utf8Length(codePoint);
+                i += units;
+            }
+            if (count >= String<char>::MaxSize) throw Exception(L"The string is too long!");
+            return static_cast<uint32_t>(count);
+        }
+
+        template<typename T>
+        char* EncodeValidWide(const T* text, uint32_t length, char* dest) noexcept
+        {
+            uint32_t i = 0;
+            while (i < length)
+            {
+                if (static_cast<Simd::Unit<T>>(text[i]) < 0x80)
+                {
+                    const uint32_t ascii = AsciiRun(text + i, length - i);
+                    dest = NarrowAscii(text + i, ascii, dest);
+                    i += ascii;
+                    continue;
+                }
+                uint32_t codePoint;
+                i += DecodeWide(text + i, text + length, codePoint);
+                dest = WriteUtf8(dest, codePoint);
+            }
+            return dest;
+        }
+        /// <summary>
+        /// Convert UTF-8 into UTF-16 or UTF-32 according to the size of T.
+        /// </summary>
+        template<typename T>
+        String<T> FromUtf8(StringView<char> text)
+        {
+            static_assert(IsWideUnit<T>::value, "The characters must be UTF-16 or UTF-32 units");
+            uint32_t consumed;
+            const uint32_t count = MeasureUtf8<T>(text.Buffer(), text.Length(), consumed);
+            if (consumed != text.Length()) throw Exception(L"Truncated UTF-8 sequence!");
+            StringBuilder<T> builder(count);
+            DecodeValidUtf8(text.Buffer(), text.Length(), builder.AppendUninitialized(count));
+            return builder.ToString();
+        }
+        /// <summary>
+        /// Convert UTF-16 or UTF-32, according to the size of T, into UTF-8.
+        /// </summary>
+        template<typename T>
+        String<char> ToUtf8(StringView<T> text)
+        {
+            static_assert(IsWideUnit<T>::value, "The characters must be UTF-16 or UTF-32 units");
+            const uint32_t count = MeasureWide(text.Buffer(), text.Length());
+            StringBuilder<char> builder(count);
+            EncodeValidWide(text.Buffer(), text.Length(), builder.AppendUninitialized(count));
+            return builder.ToString();
+        }
+    }
+    /// <summary>
+    /// Convert UTF-8 into a wide string, invalid or truncated sequences throw an Exception.
+    /// </summary>
+    inline WString ToWide(StringView<char> text)
+    {
+        return Unicode::FromUtf8<wchar_t>(text);
+    }
+    /// <summary>
+    /// Convert a wide string into UTF-8, unpaired surrogates or invalid code points throw an Exception.
+    /// </summary>
+    inline AString ToUtf8(StringView<wchar_t> text)
+    {
+        return Unicode::ToUtf8(text);
+    }
+    /// <summary>
+    /// Decodes UTF-8 which arrives in chunks, a sequence cut by the end of a chunk is completed by the next one.
+    /// </summary>
+    /// <typeparam name="T">The type of wide character</typeparam>
+    template<typename T = wchar_t>
+    class Utf8Decoder
+    {
+    public:
+        Utf8Decoder() noexcept : pendingLength_(0)
+        {
+        }
+        /// <summary>
+        /// Decode a chunk and append the characters to the output.
+        /// </summary>
+        void Decode(StringView<char> chunk, StringBuilder<T>& output)
+        {
+            const char* text = chunk.Buffer();
+            uint32_t length = chunk.Length();
+            while (pendingLength_ && length)
+            {
+                pending_[pendingLength_++] = static_cast<uint8_t>(*text++);
+                --length;
+                uint32_t codePoint;
+                const uint32_t sequence = Unicode::DecodeUtf8(pending_, pending_ + pendingLength_, codePoint);
+                if (sequence == Unicode::Incomplete) continue;
+                pendingLength_ = 0;
+                if (!sequence) throw Exception(L"Invalid UTF-8 sequence!");
+                T units[2];
+                output.Append(units, static_cast<uint32_t>(Unicode::WriteWide(units, codePoint) - units));
+            }
+            uint32_t consumed;
+            const uint32_t count = Unicode::MeasureUtf8<T>(text, length, consumed);
+            Unicode::DecodeValidUtf8(text, consumed, output.AppendUninitialized(count));
+            while (consumed < length) pending_[pendingLength_++] = static_cast<uint8_t>(text[consumed++]);
+        }
+        /// <summary>
+        /// Whether the input so far ends on a sequence boundary.
+        /// </summary>
+        bool IsComplete() const noexcept
+        {
+            return pendingLength_ == 0;
+        }
+        /// <summary>
+        /// Check that the input does not end in the middle of a sequence, the decoder may be reused afterwards.
+        /// </summary>
+        void Finish()
+        {
+            if (pendingLength_)
+            {
+                pendingLength_ = 0;
+                throw Exception(L"Truncated UTF-8 sequence!");
+            }
+        }
+
+    private:
+        uint8_t pending_[4];
+        uint32_t pendingLength_;
+    };
+}
@@ -0,0 +1,856 @@
+#include <iostream>
+#include <chrono>
+#include <cstdint>
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include "YtcString.hpp"
+#include "YtcCollection.hpp"
+#include "YtcMultiPatternMatcher.hpp"
+#include "YtcStringBuilder.hpp"
+#include "YtcInternPool.hpp"
+#include "YtcUnicode.hpp"
+#include "YtcFormat.hpp"
+#include "YtcMappedFile.hpp"
+#include "YtcRope.hpp"
+#include "YtcFuzzyMatcher.hpp"
+#include "YtcGlob.hpp"
+
+
+using namespace Ytc;
+using Clock = std::chrono::steady_clock;
+
+static volatile uint32_t sink;
+
+template<typename Function>
+static double MeasureSeconds(uint32_t iterations, Function&& function)
+{
+    auto start = Clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template<typename T>
+static void BenchmarkFindChar(const char* name)
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>FindChar<" << name << ">: (bytes, scalar GB/s, dispatched GB/s)\n";
+    for (uint32_t bytes = 16; bytes <= (1u << 20); bytes <<= 2)
+    {
+        const uint32_t length = bytes / sizeof(T);
+        String<T> haystack(T('a'), length - 1);
+        haystack += T('b');
+        const T* buffer = haystack.Buffer();
+        const uint32_t iterations = (256u << 20) / bytes;
+
+        double scalar = MeasureSeconds(iterations, [&] { sink = Simd::FindCharScalar(buffer, length, T('b')); });
+        double simd = MeasureSeconds(iterations, [&] { sink = haystack.IndexOf(T('b')); });
+        double scalarLast = MeasureSeconds(iterations, [&] { sink = Simd::FindLastCharScalar(buffer, length, T('c')); });
+        double simdLast = MeasureSeconds(iterations, [&] { sink = haystack.LastIndexOf(T('c')); });
+
+        const double total = static_cast<double>(bytes) * iterations / 1e9;
+        std::cout << "IndexOf     " << bytes << ", " << total / scalar << ", " << total / simd << "\n";
+        std::cout << "LastIndexOf " << bytes << ", " << total / scalarLast << ", " << total / simdLast << "\n";
+    }
+}
+
+template<typename T>
+static uint32_t NaiveIndexOf(const String<T>& haystack, const String<T>& needle)
+{
+    const T* h = haystack.Buffer();
+    const T* p = needle.Buffer();
+    const uint32_t n = haystack.Length(), m = needle.Length();
+    for (uint32_t start = 0; m <= n - start; ++start)
+    {
+        uint32_t i = 0;
+        while (i < m && h[start + i] == p[i]) ++i;
+        if (i == m) return start;
+    }
+    return String<T>::InvalidIndex;
+}
+
+static void BenchmarkStringSearcher()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>StringSearcher: (case, naive GB/s, IndexOf GB/s, precompiled GB/s)\n";
+    struct Case
+    {
+        const char* name;
+        AString haystack;
+        AString needle;
+    };
+    AString text;
+    for (uint32_t i = 0; text.Length() < (1u << 20); ++i)
+    {
+        text += "GET /index.html HTTP/1.1 Host: example.com User-Agent: bench ";
+    }
+    Case cases[] =
+    {
+        { "short needle", text, "Content-Type" },
+        { "long needle", text, "User-Agent: bench GET /index.html HTTP/1.1 Host: example.org" },
+        { "adversarial", AString('a', 1u << 20), AString('a', 256) + 'b' + AString('a', 255) },
+    };
+    for (auto& c : cases)
+    {
+        const uint32_t iterations = c.needle.Length() > 256 ? 4 : 64;
+        StringSearcher<char> searcher(c.needle);
+        double naive = MeasureSeconds(iterations, [&] { sink = NaiveIndexOf(c.haystack, c.needle); });
+        double oneShot = MeasureSeconds(iterations, [&] { sink = c.haystack.IndexOf(c.needle); });
+        double precompiled = MeasureSeconds(iterations, [&] { sink = searcher.IndexOf(c.haystack); });
+        const double total = static_cast<double>(c.haystack.Length()) * iterations / 1e9;
+        std::cout << c.name << ", " << total / naive << ", " << total / oneShot << ", " << total / precompiled << "\n";
+    }
+}
+
+static void BenchmarkMultiPatternMatcher()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>MultiPatternMatcher: (keywords, Contains per keyword MB/s, matcher MB/s)\n";
+    AString message;
+    while (message.Length() < 4096)
+    {
+        message += "2024-01-01 12:00:00 INFO request served path=/api/v1/items status=200 latency=12ms ";
+    }
+    for (uint32_t count = 10; count <= 1000; count *= 10)
+    {
+        List<AString> keywords;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            AString keyword = "keyword";
+            keyword += static_cast<char>('a' + i % 26);
+            keyword += static_cast<char>('a' + i / 26 % 26);
+            keywords.Add(keyword);
+        }
+        MultiPatternMatcher<char> matcher(keywords);
+        const uint32_t iterations = 200;
+        double perKeyword = MeasureSeconds(iterations, [&]
+        {
+            uint32_t found = 0;
+            for (uint32_t i = 0; i < keywords.Count(); ++i) found += message.Contains(keywords[i]);
+            sink = found;
+        });
+        double automaton = MeasureSeconds(iterations, [&] { sink = matcher.FindAll(message).Count(); });
+        const double total = static_cast<double>(message.Length()) * iterations / 1e6;
+        std::cout << count << ", " << total / perKeyword << ", " << total / automaton << "\n";
+    }
+}
+
+static void BenchmarkGlob()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Routing 10000 paths through 2000 glob rules: (each GlobPattern us, GlobSet us per path)\n";
+    uint32_t random = 2024;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    const char* extensions[] = { "json", "xml", "html", "png", "css" };
+    List<AString> rules;
+    for (uint32_t i = 0; i < 2000; ++i)
+    {
+        const AString id = AString::From(i);
+        switch (i % 4)
+        {
+        case 0: rules.Add("/api/v?/resource" + id + "/*"); break;
+        case 1: rules.Add("/static/*/asset" + id + ".*"); break;
+        case 2: rules.Add("*/report" + id + "_[0-9][0-9].pdf"); break;
+        default: rules.Add("/users/*/item" + id + "/*." + AString(extensions[i % 5])); break;
+        }
+    }
+    List<AString> paths;
+    for (uint32_t i = 0; i < 10000; ++i)
+    {
+        const AString id = AString::From(next() % 2500);
+        switch (next() % 4)
+        {
+        case 0: paths.Add("/api/v2/resource" + id + "/details"); break;
+        case 1: paths.Add("/static/css/asset" + id + ".css"); break;
+        case 2: paths.Add("/home/reports/report" + id + "_17.pdf"); break;
+        default: paths.Add("/users/alice/item" + id + "/photo.png"); break;
+        }
+    }
+    List<GlobPattern<char>> patterns;
+    for (uint32_t i = 0; i < rules.Count(); ++i) patterns.Add(GlobPattern<char>(rules[i]));
+    const uint32_t sample = 500;
+    double each = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < sample; ++i)
+        {
+            for (uint32_t j = 0; j < patterns.Count(); ++j) sink += patterns[j].IsMatch(paths[i]);
+        }
+    });
+    const GlobSet<char> set(rules);
+    double combined = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < paths.Count(); ++i) sink += set.Matches(paths[i]).Count();
+    });
+    std::cout << each * 1e6 / sample << ", " << combined * 1e6 / paths.Count() << "\n";
+}
+
+static void BenchmarkStringBuilder()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Build 1 MB char by char: (method, ms)\n";
+    const uint32_t length = 1u << 20;
+    double appended = MeasureSeconds(10, []
+    {
+        AString s;
+        for (uint32_t i = 0; i < length; ++i) s += static_cast<char>('a' + i % 26);
+        sink = s.Length();
+    });
+    double built = MeasureSeconds(10, []
+    {
+        StringBuilder<char> builder;
+        for (uint32_t i = 0; i < length; ++i) builder.Append(static_cast<char>('a' + i % 26));
+        sink = builder.ToString().Length();
+    });
+    double numbers = MeasureSeconds(10, []
+    {
+        StringBuilder<char> builder;
+        for (uint32_t i = 0; builder.Length() < length; ++i) builder.AppendNumber(i).Append(',');
+        sink = builder.ToString().Length();
+    });
+    std::cout << "String::operator+=, " << appended * 100 << "\n";
+    std::cout << "StringBuilder::Append, " << built * 100 << "\n";
+    std::cout << "StringBuilder::AppendNumber, " << numbers * 100 << "\n";
+}
+
+static void BenchmarkConcat()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Concat 7 pieces: (method, ns per string)\n";
+    const WString host = L"api.example.com", path = L"/v1/items/123456", query = L"fields=name,price";
+    const uint32_t iterations = 1000000;
+    double pairwise = MeasureSeconds(iterations, [&]
+    {
+        // what each operator+ cost before concatenations were lazy: a string per step
+        WString url = WString(WString(WString(WString(WString(WString(L"https://") + host) + path) + L'?') + query) + L'#') + L"top";
+        sink = url.Length();
+    });
+    double lazy = MeasureSeconds(iterations, [&]
+    {
+        WString url = L"https://" + host + path + L'?' + query + L'#' + L"top";
+        sink = url.Length();
+    });
+    double appended = MeasureSeconds(iterations, [&]
+    {
+        WString url = L"https://";
+        url += host + path + L'?' + query + L'#' + L"top";
+        sink = url.Length();
+    });
+    std::cout << "one string per operator+, " << pairwise * 1e9 / iterations << "\n";
+    std::cout << "ConcatExpression, " << lazy * 1e9 / iterations << "\n";
+    std::cout << "operator+=(ConcatExpression), " << appended * 1e9 / iterations << "\n";
+}
+
+static void BenchmarkHash()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Hash: (characters, std::hash over a std::wstring copy ns, GetHashCode ns)\n";
+    for (uint32_t length = 8; length <= 4096; length *= 8)
+    {
+        WString key(L'k', length);
+        const WString copy = key;
+        const uint32_t iterations = (64u << 20) / length;
+        double viaStd = MeasureSeconds(iterations, [&]
+        {
+            sink = static_cast<uint32_t>(std::hash<std::wstring>()(std::wstring(key.Buffer(), key.Length())));
+        });
+        double direct = MeasureSeconds(iterations, [&] { sink = static_cast<uint32_t>(key.View().GetHashCode()); });
+        double cached = MeasureSeconds(iterations, [&] { sink = static_cast<uint32_t>(copy.GetHashCode()); });
+        std::cout << length << ", " << viaStd * 1e9 / iterations << ", " << direct * 1e9 / iterations;
+        if (copy.Length() >= 256) std::cout << ", cached " << cached * 1e9 / iterations;
+        std::cout << "\n";
+    }
+}
+
+static void BenchmarkInternPool()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>InternPool: 4096 labels\n";
+    List<AString> labels;
+    for (uint32_t i = 0; i < 4096; ++i)
+    {
+        StringBuilder<char> label;
+        label.Append("service.http.requests.").AppendNumber(i % 64).Append(".latency.bucket.").AppendNumber(i);
+        labels.Add(label.ToString());
+    }
+    InternPool<char> pool;
+    List<InternPool<char>::Atom> atoms;
+    List<AString> copies;
+    for (uint32_t i = 0; i < labels.Count(); ++i)
+    {
+        atoms.Add(pool.Intern(labels[i]));
+        copies.Add(AString(labels[i].Buffer(), labels[i].Length()));
+    }
+    // compare each label with its equal copy and a neighbour sharing a long prefix
+    const uint32_t iterations = 1000;
+    double strings = MeasureSeconds(iterations, [&]
+    {
+        uint32_t equal = 0;
+        for (uint32_t i = 0; i < labels.Count(); ++i) equal += (labels[i] == copies[i]) + (labels[i] == copies[i ^ 1]);
+        sink = equal;
+    });
+    double interned = MeasureSeconds(iterations, [&]
+    {
+        uint32_t equal = 0;
+        for (uint32_t i = 0; i < atoms.Count(); ++i) equal += (atoms[i] == atoms[i]) + (atoms[i] == atoms[i ^ 1]);
+        sink = equal;
+    });
+    const double comparisons = 2.0 * labels.Count() * iterations;
+    std::cout << "String::operator== ns, " << strings * 1e9 / comparisons << "\n";
+    std::cout << "Atom::operator== ns, " << interned * 1e9 / comparisons << "\n";
+
+    std::cout << "(threads, Intern lookups per second in millions)\n";
+    for (uint32_t threadCount = 1; threadCount <= 8; threadCount *= 2)
+    {
+        const uint32_t rounds = 100;
+        std::vector<std::thread> threads;
+        auto start = Clock::now();
+        for (uint32_t t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]
+            {
+                uint32_t found = 0;
+                for (uint32_t r = 0; r < rounds; ++r)
+                {
+                    for (uint32_t i = 0; i < labels.Count(); ++i) found += !pool.Intern(labels[(i + t * 512) % labels.Count()]).IsNull();
+                }
+                sink = found;
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << threadCount << ", " << static_cast<double>(rounds) * labels.Count() * threadCount / seconds / 1e6 << "\n";
+    }
+}
+
+template<typename RefCountPolicy>
+static void BenchmarkCopy(const char* name)
+{
+    using WString = String<wchar_t, RefCountPolicy>;
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Long string copies with " << name << ": (characters, copy ns, create and share once ns)\n";
+    for (uint32_t length = 256; length <= 4096; length *= 16)
+    {
+        const WString original(L'c', length);
+        const uint32_t iterations = 1u << 20;
+        double copied = MeasureSeconds(iterations, [&]
+        {
+            WString copy = original;
+            sink = copy.Length();
+        });
+        double shared = MeasureSeconds(iterations, [&]
+        {
+            WString created(original.Buffer(), length);
+            WString copy = created;
+            sink = copy.Length();
+        });
+        std::cout << length << ", " << copied * 1e9 / iterations << ", " << shared * 1e9 / iterations << "\n";
+    }
+}
+
+static void BenchmarkMappedFile()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Dictionary of 64 MB: (fread into AString ms, MappedFile ms, first search after fread ms, first search after mapping ms)\n";
+    const char* path = "ytc_benchmark_dictionary.txt";
+    {
+        AString line("abcdefghijklmnopqrstuvwxyz0123456789 dictionary entry\n");
+        AString chunk;
+        while (chunk.Length() < (1u << 20)) chunk += line;
+        std::FILE* file = std::fopen(path, "wb");
+        if (!file) return;
+        for (uint32_t i = 0; i < 64; ++i) std::fwrite(chunk.Buffer(), 1, chunk.Length(), file);
+        std::fclose(file);
+    }
+    AString loaded, mapped;
+    double read = MeasureSeconds(1, [&] {
+        std::FILE* file = std::fopen(path, "rb");
+        std::fseek(file, 0, SEEK_END);
+        const long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+        StringBuilder<char> builder(static_cast<uint32_t>(size));
+        sink = static_cast<uint32_t>(std::fread(builder.AppendUninitialized(static_cast<uint32_t>(size)), 1, static_cast<size_t>(size), file));
+        std::fclose(file);
+        loaded = builder.ToString();
+    });
+    double map = MeasureSeconds(1, [&] { mapped = MappedFile(path).ToString<char>(); });
+    double searchLoaded = MeasureSeconds(1, [&] { sink = loaded.IndexOf("missing entry"); });
+    double searchMapped = MeasureSeconds(1, [&] { sink = mapped.IndexOf("missing entry"); });
+    std::cout << read * 1e3 << ", " << map * 1e3 << ", " << searchLoaded * 1e3 << ", " << searchMapped * 1e3 << "\n";
+    std::remove(path);
+}
+
+static void BenchmarkArena()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Requests building 64 strings of 300 to 600 characters: (resource, ns per request)\n";
+    auto handle = []
+    {
+        uint32_t total = 0;
+        WString header(L'h', 256);
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            WString line = header + L": " + WString(L'v', i * 5);
+            line += L"\r\n";
+            WString copy = line;
+            total += copy.Length();
+        }
+        sink = total;
+    };
+    const uint32_t iterations = 1u << 14;
+    double heap = MeasureSeconds(iterations, handle);
+    MonotonicArena arena(64 * 1024);
+    double arenaSeconds = MeasureSeconds(iterations, [&]
+    {
+        {
+            MemoryResourceScope scope(&arena);
+            handle();
+        }
+        arena.Reset();
+    });
+    std::cout << "global heap, " << heap * 1e9 / iterations << "\n";
+    std::cout << "MonotonicArena, " << arenaSeconds * 1e9 / iterations << "\n";
+}
+
+template<typename T>
+static void BenchmarkIgnoreCase(const char* name)
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Case folding of " << name << ": (characters, ToLower ns, ToLowerInPlace ns, CompareIgnoreCase ns, "
+        "ToLower then IndexOf ns, IndexOfIgnoreCase ns)\n";
+    for (uint32_t length = 64; length <= 16384; length *= 16)
+    {
+        String<T> text;
+        const char* words = "Content-Type: Text/HTML; Charset=UTF-8 ";
+        for (uint32_t i = 0; text.Length() < length; ++i) text += T(words[i % 40]);
+        String<T> needle;
+        for (const char* p = "X-REQUEST-ID"; *p; ++p) needle += T(*p);
+        text += needle;
+        const String<T> upper = text.ToUpper();
+        const uint32_t iterations = (1u << 24) / length;
+        double lower = MeasureSeconds(iterations, [&] { sink = text.ToLower().Length(); });
+        String<T> scratch = text;
+        double inPlace = MeasureSeconds(iterations, [&] { sink = scratch.ToLowerInPlace().Length(); });
+        double compare = MeasureSeconds(iterations, [&] { sink = String<T>::CompareIgnoreCase(text, upper); });
+        const String<T> lowerNeedle = needle.ToLower();
+        double lowerThenFind = MeasureSeconds(iterations, [&] { sink = text.ToLower().IndexOf(lowerNeedle); });
+        double find = MeasureSeconds(iterations, [&] { sink = text.IndexOfIgnoreCase(needle); });
+        std::cout << text.Length() << ", " << lower * 1e9 / iterations << ", " << inPlace * 1e9 / iterations << ", " << compare * 1e9 / iterations
+            << ", " << lowerThenFind * 1e9 / iterations << ", " << find * 1e9 / iterations << "\n";
+    }
+}
+
+template<typename T>
+static void BenchmarkCompare(const char* name)
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Compare " << name << " strings differing in the last character: (characters, == ns, < ns, == const T* ns)\n";
+    for (uint32_t length = 8; length <= 4096; length *= 8)
+    {
+        const String<T> s1(T('k'), length);
+        String<T> s2(T('k'), length - 1);
+        s2 += T('l');
+        const uint32_t iterations = (1u << 26) / (length + 32);
+        double equal = MeasureSeconds(iterations, [&] { sink = s1 == s2; });
+        double less = MeasureSeconds(iterations, [&] { sink = s1 < s2; });
+        double pointer = MeasureSeconds(iterations, [&] { sink = s1 == s2.Buffer(); });
+        std::cout << length << ", " << equal * 1e9 / iterations << ", " << less * 1e9 / iterations << ", " << pointer * 1e9 / iterations << "\n";
+    }
+    const uint32_t count = 1u << 18;
+    std::vector<String<T>> keys;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // keys with a long common prefix, like paths or header names
+        String<T> key(T('/'), 24);
+        for (uint32_t value = i * 2654435761u; value; value /= 26) key += T('a' + value % 26);
+        keys.push_back(key);
+    }
+    std::map<String<T>, uint32_t> map;
+    for (uint32_t i = 0; i < count; ++i) map[keys[i]] = i;
+    auto start = Clock::now();
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; ++i) found += map.find(keys[(i * 7919) % count])->second;
+    double lookups = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(keys.begin(), keys.end(), [](const String<T>& a, const String<T>& b) { return b < a; });
+    start = Clock::now();
+    std::sort(keys.begin(), keys.end());
+    double sorted = std::chrono::duration<double>(Clock::now() - start).count();
+    sink = found;
+    std::cout << "std::map lookup ns, " << lookups * 1e9 / count << "\n";
+    std::cout << "sort " << count << " keys ms, " << sorted * 1e3 << "\n";
+}
+
+static void BenchmarkSplit()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Split: (field characters, IndexOf and SubString ns, Split ns, SplitAny ns per line of 64 fields)\n";
+    for (uint32_t fieldLength = 4; fieldLength <= 64; fieldLength *= 4)
+    {
+        AString line;
+        for (uint32_t field = 0; field < 64; ++field)
+        {
+            for (uint32_t i = 0; i < fieldLength; ++i) line += char('a' + (field + i) % 26);
+            line += field % 8 == 7 ? ';' : ',';
+        }
+        const uint32_t iterations = (1u << 22) / line.Length();
+        double substrings = MeasureSeconds(iterations, [&] {
+            uint32_t total = 0;
+            uint32_t start = 0;
+            for (uint32_t end; (end = line.View(start).IndexOf(',')) != AString::InvalidIndex; start += end + 1)
+            {
+                total += line.SubString(start, end).Length();
+            }
+            sink = total;
+        });
+        double split = MeasureSeconds(iterations, [&] {
+            uint32_t total = 0;
+            for (StringView<char> field : line.Split(',')) total += field.Length();
+            sink = total;
+        });
+        double splitAny = MeasureSeconds(iterations, [&] {
+            uint32_t total = 0;
+            for (StringView<char> field : line.SplitAny(",;")) total += field.Length();
+            sink = total;
+        });
+        std::cout << fieldLength << ", " << substrings * 1e9 / iterations << ", " << split * 1e9 / iterations << ", " << splitAny * 1e9 / iterations << "\n";
+    }
+}
+
+static void BenchmarkReplace()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Replace in 16 KB: (characters between matches, IndexOf and concatenation us, Replace us, same length Replace us, ReplaceInPlace us)\n";
+    for (uint32_t gap = 16; gap <= 1024; gap *= 8)
+    {
+        AString text;
+        while (text.Length() < 16384)
+        {
+            for (uint32_t i = 0; i < gap; ++i) text += char('a' + i % 26);
+            text += "{name}";
+        }
+        const uint32_t iterations = 32768 / gap;
+        double concat = MeasureSeconds(iterations, [&] {
+            AString result = text;
+            for (uint32_t i = result.IndexOf("{name}"); i != AString::InvalidIndex;)
+            {
+                result = result.SubString(0, i) + "yutuocheng" + result.View(i + 6).ToString();
+                const uint32_t next = result.View(i + 10).IndexOf("{name}");
+                i = next == AString::InvalidIndex ? next : i + 10 + next;
+            }
+            sink = result.Length();
+        });
+        double replace = MeasureSeconds(iterations, [&] { sink = text.Replace("{name}", "yutuocheng").Length(); });
+        double sameLength = MeasureSeconds(iterations, [&] { sink = text.Replace("{name}", "[user]").Length(); });
+        AString unique = text.SubString(0);
+        double inPlace = MeasureSeconds(iterations, [&] {
+            sink = unique.ReplaceInPlace("{name}", "[user]").ReplaceInPlace("[user]", "{name}").Length();
+        });
+        std::cout << gap << ", " << concat * 1e6 / iterations << ", " << replace * 1e6 / iterations << ", " << sameLength * 1e6 / iterations
+            << ", " << inPlace * 1e6 / iterations / 2 << "\n";
+    }
+
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>ReplaceAll of \"a\" in 200 KB of 'a' beside a pattern which never matches: (its length, ms)\n";
+    const AString run('a', 200 * 1024);
+    for (uint32_t longLength = 2; longLength <= 4096; longLength *= 8)
+    {
+        List<AString> patterns;
+        patterns.Add("a");
+        patterns.Add(AString(AString('a', longLength - 1) + "b"));
+        List<AString> replacements;
+        replacements.Add("x");
+        replacements.Add("y");
+        MultiPatternMatcher<char> matcher(patterns);
+        double replaceAll = MeasureSeconds(4, [&] { sink = matcher.ReplaceAll(run, replacements).Length(); });
+        std::cout << longLength << ", " << replaceAll * 1e3 / 4 << "\n";
+    }
+}
+
+static void BenchmarkRope()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Editing 10 MB in the middle: (String::Remove us, Rope::Remove us, Rope::Insert us per edit, Flatten ms)\n";
+    AString text;
+    while (text.Length() < 10u * 1024 * 1024) text += "the quick brown fox jumps over the lazy dog\n";
+    uint32_t random = 12345;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    const uint32_t stringEdits = 64, ropeEdits = 1 << 14;
+    AString edited = text;
+    double removeString = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < stringEdits; ++i) edited = edited.Remove(next() % (edited.Length() - 16), 16);
+    });
+    Rope<char> rope(text);
+    double removeRope = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < ropeEdits; ++i) rope.Remove(next() % (rope.Length() - 16), 16);
+    });
+    const AString word("jumps");
+    double insertRope = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < ropeEdits; ++i) rope.Insert(next() % rope.Length(), word);
+    });
+    double flatten = MeasureSeconds(1, [&] { sink = rope.Flatten().Length(); });
+    std::cout << removeString * 1e6 / stringEdits << ", " << removeRope * 1e6 / ropeEdits << ", " << insertRope * 1e6 / ropeEdits
+        << ", " << flatten * 1e3 << "\n";
+}
+
+static uint32_t EditDistanceByTable(const AString& s1, const AString& s2)
+{
+    std::vector<uint32_t> row(s2.Length() + 1);
+    for (uint32_t j = 0; j <= s2.Length(); ++j) row[j] = j;
+    for (uint32_t i = 1; i <= s1.Length(); ++i)
+    {
+        uint32_t diagonal = row[0];
+        row[0] = i;
+        for (uint32_t j = 1; j <= s2.Length(); ++j)
+        {
+            const uint32_t substitution = diagonal + (s1.Buffer()[i - 1] != s2.Buffer()[j - 1]);
+            diagonal = row[j];
+            row[j] = std::min(substitution, std::min(row[j], row[j - 1]) + 1);
+        }
+    }
+    return row[s2.Length()];
+}
+
+static void BenchmarkEditDistance()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Edit distance of a query to 100000 words: (table ns, EditDistance ns, within 2 ns per word, FuzzyMatcher 1 thread ms, all threads ms, FuzzyIndexOf MB/s)\n";
+    uint32_t random = 4711;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    List<AString> words;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        AString word;
+        for (uint32_t length = 6 + next() % 15; length; --length) word += char('a' + next() % 26);
+        words.Add(word);
+    }
+    const AString query("internationalization");
+    double table = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < words.Count(); i += 10) sink += EditDistanceByTable(query, words[i]);
+    });
+    double distance = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < words.Count(); ++i) sink += AString::EditDistance(query, words[i]);
+    });
+    double within = MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < words.Count(); ++i) sink += AString::IsWithinEditDistance(query, words[i], 2);
+    });
+    const FuzzyMatcher<char> matcher(query);
+    double single = MeasureSeconds(1, [&] { sink += matcher.Distances(words, AString::MaxSize, 1).Count(); });
+    double threaded = MeasureSeconds(1, [&] { sink += matcher.Distances(words).Count(); });
+    AString text;
+    while (text.Length() < 1024 * 1024) text += "the quick brown fox jumps over the lazy dog\n";
+    double search = MeasureSeconds(1, [&] { sink += text.FuzzyIndexOf("quick brown fax jumped", 2); });
+    std::cout << table * 1e9 / (words.Count() / 10) << ", " << distance * 1e9 / words.Count() << ", " << within * 1e9 / words.Count()
+        << ", " << single * 1e3 << ", " << threaded * 1e3 << ", " << text.Length() / search / 1e6 << "\n";
+}
+
+static void BenchmarkNumbers()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Numbers: (ns per number, From, snprintf, TryParse, strtoll or strtod)\n";
+    const uint32_t count = 1 << 16;
+    std::vector<int64_t> integers(count);
+    std::vector<double> doubles(count);
+    uint64_t random = 88172645463325252ull;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        integers[i] = static_cast<int64_t>(random) >> (random % 48);
+        doubles[i] = static_cast<double>(random >> 11) / (1ull << (random % 40));
+    }
+    std::vector<AString> integerTexts, doubleTexts;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        integerTexts.push_back(AString::From(integers[i]));
+        doubleTexts.push_back(AString::From(doubles[i]));
+    }
+    const uint32_t iterations = 4;
+    auto perNumber = [&](double seconds) { return seconds * 1e9 / iterations / count; };
+    double fromInteger = MeasureSeconds(iterations, [&] { for (int64_t value : integers) sink = AString::From(value).Length(); });
+    double printInteger = MeasureSeconds(iterations, [&] {
+        char buffer[32];
+        for (int64_t value : integers) sink = AString(buffer, std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value))).Length();
+    });
+    double parseInteger = MeasureSeconds(iterations, [&] {
+        int64_t value = 0;
+        for (const AString& text : integerTexts) sink = AString::TryParse(text, value) + static_cast<uint32_t>(value);
+    });
+    double strtollInteger = MeasureSeconds(iterations, [&] {
+        for (const AString& text : integerTexts) sink = static_cast<uint32_t>(std::strtoll(text.Buffer(), nullptr, 10));
+    });
+    std::cout << "int64, " << perNumber(fromInteger) << ", " << perNumber(printInteger) << ", " << perNumber(parseInteger) << ", " << perNumber(strtollInteger) << "\n";
+    double fromDouble = MeasureSeconds(iterations, [&] { for (double value : doubles) sink = AString::From(value).Length(); });
+    double printDouble = MeasureSeconds(iterations, [&] {
+        char buffer[32];
+        for (double value : doubles) sink = AString(buffer, std::snprintf(buffer, sizeof(buffer), "%.17g", value)).Length();
+    });
+    double parseDouble = MeasureSeconds(iterations, [&] {
+        double value = 0;
+        for (const AString& text : doubleTexts) sink = AString::TryParse(text, value) + static_cast<uint32_t>(value);
+    });
+    double strtodDouble = MeasureSeconds(iterations, [&] {
+        for (const AString& text : doubleTexts) sink = static_cast<uint32_t>(std::strtod(text.Buffer(), nullptr));
+    });
+    std::cout << "double, " << perNumber(fromDouble) << ", " << perNumber(printDouble) << ", " << perNumber(parseDouble) << ", " << perNumber(strtodDouble) << "\n";
+}
+
+static void BenchmarkFormat()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Format of a log line: (ns per line, Format, operator+ with From, snprintf)\n";
+    const uint32_t count = 1 << 14;
+    std::vector<AString> users;
+    for (uint32_t i = 0; i < 64; ++i) users.push_back(AString("user") + AString::From(i * 7919));
+    const AString address("192.168.100.27");
+    const uint32_t iterations = 8;
+    auto perLine = [&](double seconds) { return seconds * 1e9 / iterations / count; };
+    double format = MeasureSeconds(iterations, [&] {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sink = Format(YTC_PATTERN("user {} logged in from {} after {:.3} ms, request {}"), users[i & 63], address, i * 0.125, i).Length();
+        }
+    });
+    double concat = MeasureSeconds(iterations, [&] {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            AString line = AString("user ") + users[i & 63] + " logged in from " + address + " after " + AString::From(i * 0.125) + " ms, request " + AString::From(i);
+            sink = line.Length();
+        }
+    });
+    double print = MeasureSeconds(iterations, [&] {
+        char buffer[256];
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const int length = std::snprintf(buffer, sizeof(buffer), "user %s logged in from %s after %.3f ms, request %u", users[i & 63].Buffer(), address.Buffer(), i * 0.125, i);
+            sink = AString(buffer, static_cast<uint32_t>(length)).Length();
+        }
+    });
+    std::cout << perLine(format) << ", " << perLine(concat) << ", " << perLine(print) << "\n";
+}
+
+static void BenchmarkUnicode()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>UTF-8 transcoding of 64 KB: (text, ToWide MB/s, ToUtf8 MB/s, mbstowcs MB/s)\n";
+    const bool locale = setlocale(LC_ALL, "C.UTF-8") || setlocale(LC_ALL, "en_US.UTF-8");
+    const char* samples[][2] = { { "ascii", "GET /index.html HTTP/1.1 " }, { "latin", "caf\xC3\xA9 cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e " },
+        { "cjk", "\xE4\xBD\xA0\xE5\xA5\xBD\xE4\xB8\x96\xE7\x95\x8C" } };
+    for (auto& sample : samples)
+    {
+        AString text;
+        while (text.Length() < 65536) text += sample[1];
+        const WString wide = ToWide(text);
+        const uint32_t iterations = 2000;
+        double decode = MeasureSeconds(iterations, [&] { sink = ToWide(text).Length(); });
+        double encode = MeasureSeconds(iterations, [&] { sink = ToUtf8(wide).Length(); });
+        std::vector<wchar_t> buffer(text.Length() + 1);
+        double platform = locale ? MeasureSeconds(iterations, [&] { sink = static_cast<uint32_t>(mbstowcs(buffer.data(), text.Buffer(), buffer.size())); }) : 0;
+        auto throughput = [&](double seconds) { return seconds ? text.Length() * double(iterations) / seconds / 1e6 : 0; };
+        std::cout << sample[0] << ", " << throughput(decode) << ", " << throughput(encode) << ", " << throughput(platform) << "\n";
+    }
+    setlocale(LC_ALL, "C");
+}
+
+// the same string without the opt-in to relocation, shifted one element at a time
+struct UnmarkedString
+{
+    UnmarkedString(const AString& value) : value(value)
+    {
+    }
+
+    AString value;
+};
+
+template<typename Item>
+static double MeasureMiddleEdits(uint32_t size, uint32_t edits)
+{
+    List<Item> items;
+    for (uint32_t i = 0; i < size; ++i) items.Add(Item(AString(i % 4 ? "short" : "a string long enough to be on the heap")));
+    return MeasureSeconds(1, [&] {
+        for (uint32_t i = 0; i < edits; ++i)
+        {
+            items.Insert(items.Count() / 2, Item(AString("inserted")));
+            items.RemoveAt(items.Count() / 3);
+        }
+    });
+}
+
+static void BenchmarkListMiddleInsert()
+{
+    const uint32_t size = 100000, edits = 2000;
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>Insert and remove in the middle of a List<AString> of " << size << ": (moved one by one us, relocated with memmove us per edit)\n";
+    const double unmarked = MeasureMiddleEdits<UnmarkedString>(size, edits);
+    const double relocated = MeasureMiddleEdits<AString>(size, edits);
+    std::cout << unmarked * 1e6 / edits << ", " << relocated * 1e6 / edits << "\n";
+}
+
+static void BenchmarkListOfStrings()
+{
+    const uint32_t count = 10000000;
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>>List<WString> of " << count << " words, sizeof(WString) = " << sizeof(WString) << ": (step, ms)\n";
+    auto milliseconds = [](Clock::time_point from, Clock::time_point to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    // add the words the same way to a fresh list, copied, moved in or constructed in place
+    auto build = [&](List<WString>& words, int how) {
+        uint64_t random = 88172645463325252ull;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // xorshift, words of 1 to 12 letters
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            wchar_t word[12];
+            const uint32_t length = 1 + random % 12;
+            for (uint32_t j = 0; j < length; ++j) word[j] = static_cast<wchar_t>(L'a' + (random >> (5 * j + 4)) % 26);
+            if (how == 2)
+            {
+                words.Emplace(word, length);
+                continue;
+            }
+            WString value(word, length);
+            if (how == 0) words.Add(value);
+            else words.Add(Move(value));
+        }
+    };
+    const char* ways[] = { "build with Add(const T&), ", "build with Add(T&&), " };
+    for (int how = 0; how < 2; ++how)
+    {
+        List<WString> words;
+        auto start = Clock::now();
+        build(words, how);
+        std::cout << ways[how] << milliseconds(start, Clock::now()) << "\n";
+    }
+    List<WString> words;
+    auto start = Clock::now();
+    build(words, 2);
+    auto built = Clock::now();
+    uint64_t characters = 0;
+    for (uint32_t i = 0; i < words.Count(); ++i) characters += words[i].Length();
+    auto lengths = Clock::now();
+    uint32_t initials = 0;
+    for (uint32_t i = 0; i < words.Count(); ++i) initials += words[i].Buffer()[0] == L'q';
+    auto scanned = Clock::now();
+    std::sort(&words[0], &words[0] + words.Count());
+    auto sorted = Clock::now();
+    sink = static_cast<uint32_t>(characters) + initials;
+
+    std::cout << "build with Emplace, " << milliseconds(start, built) << "\n";
+    std::cout << "scan lengths, " << milliseconds(built, lengths) << "\n";
+    std::cout << "scan first characters, " << milliseconds(lengths, scanned) << "\n";
+    std::cout << "sort, " << milliseconds(scanned, sorted) << "\n";
+}
+
+int main()
+{
+    BenchmarkFindChar<char>("char");
+    BenchmarkFindChar<wchar_t>("wchar_t");
+    BenchmarkStringSearcher();
+    BenchmarkMultiPatternMatcher();
+    BenchmarkGlob();
+    BenchmarkStringBuilder();
+    BenchmarkConcat();
+    BenchmarkHash();
+    BenchmarkIgnoreCase<char>("char");
+    BenchmarkIgnoreCase<wchar_t>("wchar_t");
+    BenchmarkCompare<char>("char");
+    BenchmarkCompare<wchar_t>("wchar_t");
+    BenchmarkSplit();
+    BenchmarkReplace();
+    BenchmarkRope();
+    BenchmarkEditDistance();
+    BenchmarkNumbers();
+    BenchmarkFormat();
+    BenchmarkUnicode();
+    BenchmarkInternPool();
+    BenchmarkCopy<AtomicRefCount>("AtomicRefCount");
+    BenchmarkCopy<LocalRefCount>("LocalRefCount");
+    BenchmarkArena();
+    BenchmarkMappedFile();
+    BenchmarkListMiddleInsert();
+    BenchmarkListOfStrings();
+    return 0;
+}
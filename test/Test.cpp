@@ -2,16 +2,30 @@
 #include <cassert>
 #include <vector>
 #include <algorithm>
+#include <unordered_map>
+#include <limits>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
 #include "YtcString.hpp"
 #include "YtcCollection.hpp"
+#include "YtcMultiPatternMatcher.hpp"
+#include "YtcStringBuilder.hpp"
+#include "YtcInternPool.hpp"
+#include "YtcUnicode.hpp"
+#include "YtcFormat.hpp"
+#include "YtcMappedFile.hpp"
+#include "YtcRope.hpp"
+#include "YtcFuzzyMatcher.hpp"
+#include "YtcGlob.hpp"
 #define VAR(v) ","#v"="<<(v)
 
 
 using namespace Ytc;
 std::wostream& operator<<(std::wostream& stream, const WString& s)
 {
-    stream << s.Buffer();
-    return stream;
+    return stream.write(s.Buffer(), s.Length());
 }
 
 
@@ -63,6 +77,22 @@ static void TestYtcStringConcat()
     name += L"yutuocheng";
     assert(name == L"yutuochengabcyutuocheng");
 
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>Test Concat Expression:\n";
+    WString first = L"yu", last = L"tuocheng";
+    WString full = first + L' ' + last + L" is " + WString(L"excellent") + L'!' + name.View(0, 2);
+    assert(full == L"yu tuocheng is excellent!yu");
+    assert(L"<" + first + L'>' == L"<yu>");
+    assert((first + L'\0' + last).Length() == 10);
+    assert(first + last + first != L"yutuocheng");
+    WString longName = WString(L'a', 300) + last;
+    assert(longName.Length() == 308 && longName.LastIndexOf(L"tuocheng") == 300);
+    // the operands may refer to the string appended to, both in place and on reallocation
+    first += first + L'!';
+    assert(first == L"yuyu!");
+    WString shared = longName;
+    longName += longName.View(300) + L'.' + shared;
+    assert(longName.Length() == 308 * 2 + 9 && longName.View(308, 9) == L"tuocheng." && shared.Length() == 308);
+    std::wcout << VAR(full) << L'\n';
 }
 
 static void TestYtStringRemove()
@@ -98,11 +128,1201 @@ static void TestYtcStringCOW()
     std::wcout << VAR(b) << VAR(a) << std::endl;
     a = L'a';
     std::wcout << VAR(a) << std::endl;
+
+    // copies of a long string share one buffer until either is modified
+    WString c(L'C', 300);
+    WString d = c, e = d;
+    assert(d.Buffer() == c.Buffer() && e.Buffer() == c.Buffer());
+    e += L'E';
+    assert(e.Buffer() != c.Buffer() && e.Length() == 301 && c.Length() == 300);
+    c = L"short";
+    assert(d.Length() == 300 && d.LastIndexOf(L'C') == 299);
+    d.Assign(L"reused", 6);
+    assert(d == L"reused");
+
+    // every character type gets the same compact object, the short strings live inside it
+    static_assert(sizeof(AString) == sizeof(WString), "String should not grow with the character type");
+    const uint32_t inlineLength = YTC_STRING_INLINE_BYTES / sizeof(wchar_t) - 1;
+    WString inlined(L'i', inlineLength), spilled(L's', inlineLength + 1);
+    const char* object = reinterpret_cast<const char*>(&inlined);
+    assert(reinterpret_cast<const char*>(inlined.Buffer()) >= object && reinterpret_cast<const char*>(inlined.Buffer()) < object + sizeof(inlined));
+    inlined += L'i';
+    assert(inlined.Length() == inlineLength + 1 && inlined.LastIndexOf(L'i') == inlineLength && spilled.IndexOf(L"ss") == 0);
+}
+
+static void TestLocalString()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    LocalWString local(L'L', 300);
+    LocalWString copy = local;
+    assert(copy.Buffer() == local.Buffer());
+    copy += L'!';
+    assert(copy.Buffer() != local.Buffer() && copy.Length() == 301 && local.Length() == 300);
+    LocalWString joined = local + L"|" + copy.View(290);
+    assert(joined.Length() == 312 && joined.IndexOf(L'|') == 300);
+    assert(StringView<wchar_t>(joined) == joined.View() && joined.GetHashCode() == std::hash<LocalWString>()(joined));
+
+    // Detach() leaves the instance as the only owner, Share() hands a sole owner's buffer over without copying
+    LocalWString other = local;
+    other.Detach();
+    assert(other.Buffer() != local.Buffer() && other.View() == local.View());
+    const wchar_t* buffer = other.Buffer();
+    WString shared = std::move(other).Share();
+    assert(shared.Buffer() == buffer && other.IsEmpty());
+    WString copied = local.Share();
+    assert(copied.Buffer() != local.Buffer() && copied.View() == local.View());
+    LocalWString back(shared);
+    assert(back.Buffer() != shared.Buffer() && back.View() == shared.View());
+}
+
+class CountingResource : public MemoryResource
+{
+public:
+    void* Allocate(size_t size, size_t alignment) override
+    {
+        ++allocations;
+        return arena.Allocate(size, alignment);
+    }
+
+    void Deallocate(void* block, size_t size, size_t alignment) noexcept override
+    {
+        ++deallocations;
+        arena.Deallocate(block, size, alignment);
+    }
+
+    MonotonicArena arena{ 256 };
+    int allocations = 0;
+    int deallocations = 0;
+};
+
+static void TestMemoryResource()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    CountingResource resource;
+    WString outside(L'o', 300);
+    {
+        MemoryResourceScope scope(&resource);
+        WString small = L"short";
+        assert(resource.allocations == 0);
+        WString long1(L'x', 300);
+        assert(resource.allocations == 1);
+        // copies share the buffer inside the arena until one of them is modified
+        WString copy = long1;
+        assert(copy.Buffer() == long1.Buffer() && resource.allocations == 1);
+        copy += L'!';
+        assert(copy.Buffer() != long1.Buffer() && resource.allocations == 2 && copy.Length() == 301);
+        WString joined = long1 + L"|" + small;
+        assert(resource.allocations == 3 && joined.Length() == 306);
+        {
+            MemoryResourceScope heap(nullptr);
+            WString global(L'g', 300);
+            assert(resource.allocations == 3);
+            // a string keeps its resource when it grows outside the scope
+            for (int i = 0; i < 1000; ++i) joined += L'+';
+            assert(resource.allocations > 3 && joined.Length() == 1306);
+        }
+        const int allocations = resource.allocations;
+        outside += L'!';
+        assert(resource.allocations == allocations);
+        MonotonicArena arena(64);
+        MemoryResourceScope nested(&arena);
+        for (int i = 0; i < 100; ++i)
+        {
+            WString s(L'a', 100 + i * 10);
+            assert(s.Length() == uint32_t(100 + i * 10) && s.Buffer()[s.Length() - 1] == L'a');
+        }
+        arena.Reset();
+        WString reused(L'r', 300);
+        assert(reused.Length() == 300 && resource.allocations == allocations);
+        // the chunk of an oversized block is kept rather than the more recent small one
+        MonotonicArena oversized(64);
+        void* large = oversized.Allocate(100000, 8);
+        oversized.Allocate(200, 8);
+        oversized.Reset();
+        assert(oversized.Allocate(50000, 8) == large);
+    }
+    assert(resource.deallocations == resource.allocations);
+    WString after(L'y', 300);
+    assert(resource.deallocations == resource.allocations);
+    assert(outside.Length() == 301);
+}
+
+static void TestMappedFile()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    const char* path = "ytc_mapped_file_test.txt";
+    AString content;
+    for (uint32_t i = 0; i < 1000; ++i) content += AString("word") + AString::From(i) + "\n";
+    std::FILE* file = std::fopen(path, "wb");
+    assert(file);
+    std::fwrite(content.Buffer(), 1, content.Length(), file);
+    std::fclose(file);
+
+    AString whole, copy, terminated;
+    {
+        MappedFile mapped(path);
+        assert(mapped.Size() == content.Length());
+        whole = mapped.ToString<char>();
+        // the characters are those of the mapping, not a copy
+        assert(whole.Buffer() == mapped.Data() && whole == content && whole.GetHashCode() == content.GetHashCode());
+        assert(!whole.IsZeroTerminated() && content.IsZeroTerminated() && mapped.ToString<char>(0, 4).IsZeroTerminated());
+        assert(whole.IndexOf("word999\n") == content.Length() - 8 && whole.Split('\n', SplitOptions::RemoveEmpty).Count() == 1000);
+        const AString middle = mapped.ToString<char>(6, 200);
+        assert(middle.Buffer() == mapped.Data() + 6 && middle == content.View(6, 200));
+        // too short to be worth referring to
+        assert(mapped.ToString<char>(0, 4).Buffer() != mapped.Data() && mapped.ToString<char>(0, 4) == "word");
+        copy = whole;
+        terminated = whole;
+        assert(copy.Buffer() == whole.Buffer());
+        const MappedFile other = mapped;
+        assert(other.Data() == mapped.Data());
+        bool thrown = false;
+        try
+        {
+            mapped.ToString<char>(content.Length() + 1);
+        }
+        catch (const Exception&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try
+        {
+            mapped.ToString<wchar_t>(1);
+        }
+        catch (const Exception&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    // the strings keep the mapping alive after the handle is gone
+    assert(whole == content && copy == content);
+    // modifications copy the characters onto the heap first
+    const char* mappedBuffer = whole.Buffer();
+    copy += "end";
+    assert(copy.Buffer() != mappedBuffer && copy.Length() == content.Length() + 3 && whole == content);
+    whole.ToUpperInPlace();
+    assert(whole.Buffer() != mappedBuffer && whole.View(0, 6) == "WORD0\n" && whole.Buffer()[whole.Length()] == 0);
+    // a terminated copy for the C functions
+    const char* text = terminated.CString();
+    assert(text != mappedBuffer && terminated.IsZeroTerminated() && std::strlen(text) == content.Length());
+
+    bool thrown = false;
+    try
+    {
+        MappedFile missing("ytc_missing_file.txt");
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(path);
+}
+
+template<typename T>
+static void TestYtcStringIndexOfChar()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    for (uint32_t length = 0; length < 300; ++length)
+    {
+        String<T> s(T('x'), length);
+        assert(s.IndexOf(T('y')) == String<T>::InvalidIndex);
+        assert(s.LastIndexOf(T('y')) == String<T>::InvalidIndex);
+        for (uint32_t pos = 0; pos < length; pos += 7)
+        {
+            String<T> left(T('x'), pos);
+            String<T> right(T('x'), length - pos - 1);
+            String<T> hit = left + T('y') + right;
+            assert(hit.IndexOf(T('y')) == pos);
+            assert(hit.LastIndexOf(T('y')) == pos);
+            assert(hit.Contains(T('y')));
+            String<T> twice = hit + T('y');
+            assert(twice.IndexOf(T('y')) == pos);
+            assert(twice.LastIndexOf(T('y')) == length);
+        }
+    }
+}
+
+template<typename T>
+static T LowerAscii(T c)
+{
+    return c >= T('A') && c <= T('Z') ? T(c + ('a' - 'A')) : c;
+}
+
+template<typename T>
+static void TestYtcStringIgnoreCase()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    // letters, the characters around both letter ranges and characters which agree with letters in their low byte
+    const T alphabet[] = { T('a'), T('z'), T('A'), T('Z'), T('m'), T('M'), T('@'), T('['), T('`'), T('{'), T('0'),
+        T(sizeof(T) > 1 ? 0x141 : 0xC1), T(sizeof(T) > 1 ? 0x161 : 0xE1) };
+    const uint32_t letters = sizeof(alphabet) / sizeof(alphabet[0]);
+    uint32_t random = 12345;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    for (uint32_t length = 0; length < 100; ++length)
+    {
+        String<T> s(T('x'), length + 1);
+        T* buffer = const_cast<T*>(s.Buffer());
+        for (uint32_t i = 0; i < length; ++i) buffer[i] = alphabet[next() % letters];
+        s = String<T>(buffer, length);
+        String<T> upper = s.ToUpper();
+        String<T> lower = s.ToLower();
+        assert(upper.Length() == length && lower.Length() == length);
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            assert(lower.Buffer()[i] == LowerAscii(s.Buffer()[i]));
+            assert(LowerAscii(upper.Buffer()[i]) == lower.Buffer()[i] && !(upper.Buffer()[i] >= T('a') && upper.Buffer()[i] <= T('z')));
+        }
+        String<T> inPlace = s;
+        assert(inPlace.ToUpperInPlace() == upper && inPlace.ToLowerInPlace() == lower);
+        assert(s.EqualsIgnoreCase(upper) && String<T>::CompareIgnoreCase(upper, lower) == 0);
+        if (length)
+        {
+            String<T> changed = lower;
+            const uint32_t at = next() % length;
+            const_cast<T*>(changed.Buffer())[at] = T('~');
+            assert(!changed.EqualsIgnoreCase(upper));
+            assert((String<T>::CompareIgnoreCase(changed, upper) > 0) == (T('~') > lower.Buffer()[at]));
+            assert(String<T>::CompareIgnoreCase(upper.View(0, length - 1), lower) < 0);
+
+            const uint32_t start = next() % length;
+            const uint32_t count = 1 + next() % (length - start);
+            const uint32_t found = lower.IndexOfIgnoreCase(upper.View(start, count));
+            assert(found <= start && lower.View(found, count) == lower.View(start, count));
+        }
+    }
+    // the shared buffer of a long string is copied before it is modified
+    String<T> original(T('q'), 300);
+    String<T> copy = original;
+    copy.ToUpperInPlace();
+    assert(original.Buffer()[0] == T('q') && copy.Buffer()[299] == T('Q'));
+    String<T> text(T('-'), 200);
+    text += String<T>(T('k'), 40);
+    text += T('!');
+    String<T> needle(T('K'), 40);
+    assert(text.IndexOfIgnoreCase(needle) == 200 && text.IndexOfIgnoreCase(String<T>(needle + T('!'))) == 200);
+    assert(text.IndexOfIgnoreCase(String<T>(needle + T('?'))) == String<T>::InvalidIndex && text.IndexOfIgnoreCase(String<T>()) == 0);
+    assert(needle.IndexOfIgnoreCase(text) == String<T>::InvalidIndex);
+}
+
+static int Sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+template<typename T>
+static void TestYtcStringCompare()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    // the extreme characters make a difference which overflows when the character type is as wide as int
+    const T alphabet[] = { T('a'), T('b'), T(sizeof(T) > 1 ? 0x141 : 0xC1), std::numeric_limits<T>::max(), std::numeric_limits<T>::min() + 1 };
+    uint32_t random = 54321;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    for (uint32_t round = 0; round < 3000; ++round)
+    {
+        const uint32_t length1 = next() % 80;
+        const uint32_t length2 = next() % 4 ? length1 : next() % 80;
+        std::vector<T> buffer1(length1 + 1), buffer2(length2 + 1);
+        for (uint32_t i = 0; i < length1; ++i) buffer1[i] = alphabet[next() % 2];
+        for (uint32_t i = 0; i < length2; ++i) buffer2[i] = i < length1 && next() % 16 ? buffer1[i] : alphabet[next() % 5];
+        const String<T> s1(buffer1.data(), length1), s2(buffer2.data(), length2);
+        const int expected = std::lexicographical_compare(buffer1.begin(), buffer1.end() - 1, buffer2.begin(), buffer2.end() - 1) ? -1
+            : std::lexicographical_compare(buffer2.begin(), buffer2.end() - 1, buffer1.begin(), buffer1.end() - 1) ? 1 : 0;
+        assert(Sign(String<T>::Compare(s1, s2)) == expected);
+        assert(Sign(String<T>::Compare(s1, s2.Buffer())) == expected);
+        assert(Sign(StringView<T>::Compare(s1, s2.Buffer())) == expected);
+        assert((s1 == s2) == (expected == 0) && (s1 < s2) == (expected < 0) && (s1 > s2) == (expected > 0));
+        assert((s1 == s2.Buffer()) == (expected == 0) && (s1 >= s2.Buffer()) == (expected >= 0));
+        assert((s1.View() == s2.Buffer()) == (expected == 0) && (s1.View() < s2.Buffer()) == (expected < 0));
+        assert((s1.Buffer() == s2.View()) == (expected == 0) && (s1.Buffer() > s2.View()) == (expected > 0));
+    }
+    const String<T> shared(T('s'), 300);
+    const String<T> copy = shared;
+    assert(copy.Buffer() == shared.Buffer() && copy == shared && String<T>::Compare(copy, shared) == 0);
+    const T* null = nullptr;
+    assert(String<T>::Compare(String<T>(), null) > 0 && StringView<T>() == null && shared.View() != null);
+}
+
+template<typename T>
+static std::vector<String<T>> SplitByIndexOf(const String<T>& text, StringView<T> delimiters, bool removeEmpty)
+{
+    std::vector<String<T>> tokens;
+    uint32_t start = 0;
+    for (uint32_t i = 0; i <= text.Length(); ++i)
+    {
+        if (i < text.Length() && !delimiters.Contains(text.Buffer()[i])) continue;
+        if (i > start || !removeEmpty) tokens.push_back(String<T>(text.Buffer() + start, i - start));
+        start = i + 1;
+    }
+    return tokens;
+}
+
+template<typename T>
+static void TestYtcStringSplit()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    const T comma[] = { T(','), 0 };
+    const T separators[] = { T(','), T(';'), 0 };
+    // more characters than a vector search takes
+    const T manySeparators[] = { T(','), T(';'), T('0'), T('1'), T('2'), T('3'), T('4'), T('5'), T('6'), T('7'), 0 };
+    const T alphabet[] = { T('a'), T('b'), T(','), T(';'), T('7') };
+    uint32_t random = 777;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    for (uint32_t round = 0; round < 2000; ++round)
+    {
+        const uint32_t length = next() % 100;
+        std::vector<T> buffer(length + 1);
+        for (uint32_t i = 0; i < length; ++i) buffer[i] = alphabet[next() % 5];
+        const String<T> text(buffer.data(), length);
+        const bool removeEmpty = next() % 2 != 0;
+        const SplitOptions options = removeEmpty ? SplitOptions::RemoveEmpty : SplitOptions::None;
+        const StringView<T> sets[] = { comma, separators, manySeparators };
+        for (const StringView<T>& set : sets)
+        {
+            const std::vector<String<T>> expected = SplitByIndexOf(text, set, removeEmpty);
+            std::vector<String<T>> actual;
+            if (set.Length() == 1)
+            {
+                for (StringView<T> token : text.Split(set.Buffer()[0], options)) actual.push_back(token.ToString());
+                assert(text.Split(set, options).Count() == expected.size());
+            }
+            else
+            {
+                for (StringView<T> token : text.SplitAny(set, options)) actual.push_back(token.ToString());
+            }
+            assert(actual == expected);
+            // the last token holds the rest of the text
+            const uint32_t maxCount = next() % 4;
+            uint32_t count = 0;
+            for (StringView<T> token : text.SplitAny(set, options, maxCount))
+            {
+                ++count;
+                if (count < maxCount) assert(token == expected[count - 1]);
+                else assert(token.Buffer() + token.Length() == text.Buffer() + text.Length() && token.Length() >= expected[count - 1].Length());
+            }
+            assert(count == (maxCount < expected.size() ? maxCount : expected.size()));
+        }
+    }
+
+    AString csv = "a,b,,c,";
+    std::vector<AString> tokens;
+    for (StringView<char> token : csv.Split(',')) tokens.push_back(token.ToString());
+    assert((tokens == std::vector<AString>{ "a", "b", "", "c", "" }));
+    assert(csv.Split(',', SplitOptions::RemoveEmpty).Count() == 3);
+    assert(csv.Split(',', SplitOptions::None, 0).Count() == 0);
+    assert(*csv.Split(',', SplitOptions::None, 1).begin() == "a,b,,c,");
+    assert(AString().Split(',').Count() == 1 && AString().Split(',', SplitOptions::RemoveEmpty).Count() == 0);
+
+    WString text = L"yu, tuo, cheng, , ";
+    auto splitter = text.Split(L", ");
+    auto it = splitter.begin();
+    assert(*it == L"yu" && *++it == L"tuo" && *++it == L"cheng" && *++it == L"" && *++it == L"" && ++it == splitter.end());
+    assert(text.Split(L"").Count() == 1 && *text.Split(L"").begin() == text.Buffer());
+    assert(text.Split(L", ", SplitOptions::RemoveEmpty).Count() == 3);
+
+    // enumerated through the interface of collections
+    IEnumerable<StringView<wchar_t>>& enumerable = splitter;
+    auto enumerator = enumerable.GetEnumerator();
+    uint32_t count = 0;
+    while (enumerator->MoveNext()) ++count;
+    enumerator->Reset();
+    assert(count == 5 && enumerator->MoveNext() && enumerator->Current() == L"yu");
+}
+
+template<typename T>
+static String<T> ReplaceByIndexOf(const String<T>& text, const String<T>& oldValue, const String<T>& newValue)
+{
+    String<T> result;
+    uint32_t start = 0;
+    for (;;)
+    {
+        const uint32_t index = text.View(start).IndexOf(oldValue);
+        if (index == String<T>::InvalidIndex) break;
+        result.Append(text.Buffer() + start, index);
+        result += newValue;
+        start += index + oldValue.Length();
+    }
+    result.Append(text.Buffer() + start, text.Length() - start);
+    return result;
+}
+
+template<typename T>
+static void TestYtcStringReplace()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    uint32_t random = 4242;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    auto randomString = [&](uint32_t length) {
+        String<T> value;
+        for (uint32_t i = 0; i < length; ++i) value += T('a' + next() % 3);
+        return value;
+    };
+    for (uint32_t round = 0; round < 3000; ++round)
+    {
+        const String<T> text = randomString(next() % 400);
+        const String<T> oldValue = randomString(1 + next() % 4);
+        const String<T> newValue = next() % 2 ? randomString(oldValue.Length()) : randomString(next() % 6);
+        const String<T> expected = ReplaceByIndexOf(text, oldValue, newValue);
+        assert(text.Replace(oldValue, newValue) == expected);
+        // a copy shares the buffer of a long text, which must not change
+        String<T> copy = text;
+        const String<T> original(text.Buffer(), text.Length());
+        assert(copy.ReplaceInPlace(oldValue, newValue) == expected && text == original);
+        const T c = T('a' + next() % 3);
+        const T d = T('x');
+        String<T> charExpected;
+        for (uint32_t i = 0; i < text.Length(); ++i) charExpected += text.Buffer()[i] == c ? d : text.Buffer()[i];
+        assert(text.Replace(c, d) == charExpected);
+        copy = text;
+        assert(copy.ReplaceInPlace(c, d) == charExpected && text == original);
+    }
+
+    const AString text = AString('-', 300) + "yutuocheng";
+    assert(text.Replace('#', '+').Buffer() == text.Buffer() && text.Replace("#", "+").Buffer() == text.Buffer());
+    assert(AString("aaaa").Replace("aa", "b") == "bb" && AString("aaa").Replace("aa", "") == "a");
+    assert(AString("a.b.c").Replace(".", "::") == "a::b::c" && AString("").Replace("a", "b") == "");
+    AString unique = AString('a', 300);
+    const char* buffer = unique.Buffer();
+    assert(unique.ReplaceInPlace("aa", "bb").Buffer() == buffer && unique == AString('b', 300));
+    assert(unique.ReplaceInPlace('b', 'c').Buffer() == buffer && unique == AString('c', 300));
+    // views into the string itself are read before they are overwritten
+    AString self = "abcabc";
+    assert(self.ReplaceInPlace(self.View(0, 3), self.View(3, 3).ToString().View()) == "abcabc");
+    assert(self.ReplaceInPlace(self.View(0, 1), self.View(1, 1)) == "bbcbbc");
+    bool thrown = false;
+    try
+    {
+        text.Replace("", "x");
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+template<typename T>
+static void TestRope()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    uint32_t random = 31337;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    auto randomString = [&](uint32_t length) {
+        String<T> value;
+        for (uint32_t i = 0; i < length; ++i) value += T('a' + next() % 26);
+        return value;
+    };
+    const String<T> base = randomString(3000);
+    Rope<T> rope(base);
+    String<T> expected = base;
+    assert(rope.Flatten().Buffer() == base.Buffer() && rope.ChunkCount() == 1);
+    for (uint32_t round = 0; round < 3000; ++round)
+    {
+        const uint32_t operation = next() % 4;
+        if (operation == 0 || expected.IsEmpty())
+        {
+            // short inserts are coalesced, long ones shared
+            const String<T> text = randomString(next() % 3 ? next() % 8 : 300 + next() % 300);
+            const uint32_t start = next() % (expected.Length() + 1);
+            rope.Insert(start, text);
+            expected = (start ? expected.SubString(0, start) : String<T>()) + text + expected.View(start).ToString();
+        }
+        else if (operation == 1)
+        {
+            const uint32_t start = next() % expected.Length();
+            const uint32_t count = next() % (expected.Length() - start + 1) % 64;
+            rope.Remove(start, count);
+            expected = expected.Remove(start, count);
+        }
+        else if (operation == 2)
+        {
+            // a cut pasted back elsewhere shares its nodes
+            const uint32_t start = next() % expected.Length();
+            const Rope<T> cut = rope.SubString(start, next() % 100);
+            assert(cut.Flatten() == expected.SubString(start, cut.Length()));
+            const uint32_t position = next() % (expected.Length() + 1);
+            rope.Insert(position, cut);
+            const String<T> pasted = cut.Flatten();
+            expected = (position ? expected.SubString(0, position) : String<T>()) + pasted + expected.View(position).ToString();
+        }
+        else
+        {
+            const uint32_t index = next() % expected.Length();
+            assert(rope[index] == expected.Buffer()[index]);
+        }
+        assert(rope.Length() == expected.Length());
+    }
+    assert(rope.Flatten() == expected);
+    String<T> joined;
+    uint32_t chunks = 0;
+    for (StringView<T> chunk : rope.GetChunks())
+    {
+        joined += chunk.ToString();
+        ++chunks;
+    }
+    assert(joined == expected && chunks == rope.ChunkCount());
+    // copies are independent
+    Rope<T> copy = rope;
+    copy.Remove(0, copy.Length());
+    assert(copy.IsEmpty() && copy.Flatten().IsEmpty() && rope.Flatten() == expected);
+    bool thrown = false;
+    try
+    {
+        rope.Remove(rope.Length(), 1);
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+template<typename T>
+static std::vector<uint32_t> EditDistanceRow(StringView<T> s1, StringView<T> s2, bool search)
+{
+    // the last row of the textbook dynamic programming, a search lets a match start anywhere in s2
+    std::vector<uint32_t> row(s2.Length() + 1);
+    for (uint32_t j = 0; j <= s2.Length(); ++j) row[j] = search ? 0 : j;
+    for (uint32_t i = 1; i <= s1.Length(); ++i)
+    {
+        uint32_t diagonal = row[0];
+        row[0] = i;
+        for (uint32_t j = 1; j <= s2.Length(); ++j)
+        {
+            const uint32_t substitution = diagonal + (s1.Buffer()[i - 1] != s2.Buffer()[j - 1]);
+            diagonal = row[j];
+            row[j] = std::min(substitution, std::min(row[j], row[j - 1]) + 1);
+        }
+    }
+    return row;
+}
+
+template<typename T>
+static uint32_t EditDistanceByTable(StringView<T> s1, StringView<T> s2)
+{
+    return EditDistanceRow(s1, s2, false).back();
+}
+
+template<typename T>
+static void TestEditDistance()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    uint32_t random = 2718;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    // characters beyond the byte table of the masks are included
+    const T alphabet[] = { T('a'), T('b'), T('c'), T(sizeof(T) > 1 ? 0x4E2D : 0xE4), T(sizeof(T) > 1 ? 0x6587 : 0x80) };
+    auto randomString = [&](uint32_t length) {
+        String<T> value;
+        for (uint32_t i = 0; i < length; ++i) value += alphabet[next() % (next() % 2 ? 3 : 5)];
+        return value;
+    };
+    auto mutate = [&](String<T> value) {
+        for (uint32_t edits = next() % 6; edits; --edits)
+        {
+            const uint32_t position = next() % (value.Length() + 1);
+            const String<T> c = randomString(1);
+            if (position == value.Length() || next() % 2) value = value.View(0, position).ToString() + c + value.View(position).ToString();
+            else value = value.Remove(position, 1);
+        }
+        return value;
+    };
+    for (uint32_t round = 0; round < 1500; ++round)
+    {
+        // lengths up to 200 take several blocks of 64
+        const String<T> s1 = randomString(next() % (round % 4 ? 40 : 200));
+        const String<T> s2 = next() % 2 ? mutate(s1) : randomString(next() % (round % 4 ? 40 : 200));
+        const uint32_t expected = EditDistanceByTable<T>(s1, s2);
+        assert(String<T>::EditDistance(s1, s2) == expected && String<T>::EditDistance(s2, s1) == expected);
+        const uint32_t maxDistance = next() % 8;
+        const uint32_t bounded = String<T>::EditDistance(s1, s2, maxDistance);
+        assert(expected <= maxDistance ? bounded == expected : bounded == maxDistance + 1);
+        assert(String<T>::IsWithinEditDistance(s1, s2, maxDistance) == (expected <= maxDistance));
+
+        const String<T> text = randomString(next() % 300);
+        const String<T> pattern = next() % 2 && text.Length() ? mutate(text.SubString(next() % text.Length(), 1 + next() % 70)) : randomString(1 + next() % 70);
+        uint32_t matchLength;
+        const uint32_t index = text.FuzzyIndexOf(pattern, maxDistance, matchLength);
+        assert(index == text.FuzzyIndexOf(pattern, maxDistance));
+        // the match ends at the first position within the distance, moved on while the distance drops
+        const std::vector<uint32_t> row = EditDistanceRow<T>(pattern, text, true);
+        uint32_t end = 0;
+        while (end < row.size() && row[end] > maxDistance) ++end;
+        if (end == row.size())
+        {
+            assert(index == String<T>::InvalidIndex);
+            continue;
+        }
+        while (end + 1 < row.size() && row[end + 1] < row[end]) ++end;
+        assert(index != String<T>::InvalidIndex && index + matchLength == end);
+        assert(EditDistanceByTable<T>(pattern, StringView<T>(text.Buffer() + index, matchLength)) <= maxDistance);
+    }
+
+    assert(AString::EditDistance("kitten", "sitting") == 3 && AString::EditDistance("", "abc") == 3 && AString::EditDistance("abc", "abc") == 0);
+    assert(AString::EditDistance("kitten", "sitting", 1) == 2 && !AString::IsWithinEditDistance("kitten", "sitting", 2));
+    uint32_t matchLength;
+    assert(AString("the quikc brown fox").FuzzyIndexOf("quick", 2, matchLength) == 4 && matchLength == 4);
+    assert(AString("the quick brown fox").FuzzyIndexOf("quick", 1, matchLength) == 4 && matchLength == 5);
+    assert(AString("the quick brown fox").FuzzyIndexOf("slow", 1) == AString::InvalidIndex);
+    assert(AString("abc").FuzzyIndexOf("xy", 2, matchLength) == 0 && matchLength == 0);
+    assert(WString(L"\x4E2D\x6587\x5B57\x7B26").FuzzyIndexOf(L"\x6587\x7B26", 1, matchLength) == 1 && matchLength == 1);
+
+    List<String<T>> candidates;
+    for (uint32_t i = 0; i < 5000; ++i) candidates.Add(randomString(next() % 90));
+    const String<T> query = randomString(60);
+    FuzzyMatcher<T> matcher(query);
+    const List<uint32_t> distances = matcher.Distances(candidates, String<T>::MaxSize, 4);
+    const List<typename FuzzyMatcher<T>::Match> matches = matcher.FindWithin(candidates, 40, 3);
+    uint32_t within = 0;
+    for (uint32_t i = 0; i < candidates.Count(); ++i)
+    {
+        const uint32_t expected = EditDistanceByTable<T>(query, candidates[i]);
+        assert(distances[i] == expected && matcher.Distance(candidates[i], 40) == std::min(expected, 41u));
+        within += expected <= 40;
+    }
+    assert(matches.Count() == within);
+    for (uint32_t i = 0; i < matches.Count(); ++i)
+    {
+        assert(matches[i].distance == distances[matches[i].index]);
+        assert(!i || matches[i - 1].distance < matches[i].distance || (matches[i - 1].distance == matches[i].distance && matches[i - 1].index < matches[i].index));
+    }
+    assert(FuzzyMatcher<T>(query).Distances(List<String<T>>()).Count() == 0);
+}
+
+template<typename T>
+static String<T> Widen(const char* text)
+{
+    String<T> result;
+    for (; *text; ++text) result += T(*text);
+    return result;
+}
+
+template<typename T>
+static void TestNumberConversion()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    uint64_t random = 88172645463325252ull;
+    auto next = [&random] { random ^= random << 13; random ^= random >> 7; random ^= random << 17; return random; };
+    for (uint32_t round = 0; round < 20000; ++round)
+    {
+        const int64_t signedValue = static_cast<int64_t>(next()) >> (next() % 64);
+        const uint64_t unsignedValue = next() >> (next() % 64);
+        assert(String<T>::From(signedValue) == Widen<T>(std::to_string(signedValue).c_str()));
+        assert(String<T>::From(unsignedValue) == Widen<T>(std::to_string(unsignedValue).c_str()));
+        int64_t parsedSigned = 0;
+        uint64_t parsedUnsigned = 0;
+        assert(String<T>::TryParse(String<T>::From(signedValue), parsedSigned) && parsedSigned == signedValue);
+        assert(String<T>::TryParse(String<T>::From(unsignedValue), parsedUnsigned) && parsedUnsigned == unsignedValue);
+
+        // any finite double reads back bit for bit
+        const uint64_t bits = next();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (value != value || value - value != 0) continue;
+        const String<T> text = String<T>::From(value);
+        double parsed = 0;
+        assert(String<T>::TryParse(text, parsed) && std::memcmp(&parsed, &value, sizeof(value)) == 0);
+        uint32_t digits = 0;
+        for (uint32_t i = 0; i < text.Length() && text.Buffer()[i] != T('e'); ++i) digits += text.Buffer()[i] >= T('1') && text.Buffer()[i] <= T('9');
+        assert(digits <= 17);
+
+        // correctly rounded like strtod, with and without the exact fast path
+        char decimal[48];
+        const int mantissaDigits = 1 + static_cast<int>(next() % 24);
+        const int point = static_cast<int>(next() % (mantissaDigits + 1));
+        int length = 0;
+        for (int i = 0; i < mantissaDigits; ++i)
+        {
+            if (i == point) decimal[length++] = '.';
+            decimal[length++] = static_cast<char>('0' + next() % 10);
+        }
+        length += std::sprintf(decimal + length, "e%d", static_cast<int>(next() % 700) - 350);
+        assert(String<T>::TryParse(Widen<T>(decimal), parsed) && parsed == std::strtod(decimal, nullptr));
+    }
+
+    assert(String<T>::From(0) == Widen<T>("0") && String<T>::From(-0.0) == Widen<T>("-0") && String<T>::From(0.1) == Widen<T>("0.1"));
+    assert(String<T>::From(1e21) == Widen<T>("1e+21") && String<T>::From(1e20) == Widen<T>("100000000000000000000"));
+    assert(String<T>::From(1.5e-7) == Widen<T>("1.5e-7") && String<T>::From(0.000001) == Widen<T>("0.000001"));
+    assert(String<T>::From(5e-324) == Widen<T>("5e-324") && String<T>::From(-1.7976931348623157e308) == Widen<T>("-1.7976931348623157e+308"));
+    assert(String<T>::From(std::numeric_limits<double>::infinity()) == Widen<T>("Infinity"));
+    assert(String<T>::From(std::numeric_limits<double>::quiet_NaN()) == Widen<T>("NaN"));
+    assert(String<T>::From(std::numeric_limits<int64_t>::min()) == Widen<T>("-9223372036854775808"));
+    assert(String<T>::From(static_cast<short>(-7)) == Widen<T>("-7") && String<T>::From(42u) == Widen<T>("42"));
+
+    int value = 7;
+    assert(String<T>::TryParse(Widen<T>("-2147483648"), value) && value == std::numeric_limits<int>::min());
+    assert(String<T>::TryParse(Widen<T>("+12"), value) && value == 12);
+    uint8_t byte = 7;
+    assert(String<T>::TryParse(Widen<T>("255"), byte) && byte == 255);
+    const char* badIntegers[] = { "", "-", "+", "2147483648", "-2147483649", "1 ", " 1", "0x10", "1.0", "--1", "-+1", "99999999999999999999" };
+    for (const char* bad : badIntegers) assert(!String<T>::TryParse(Widen<T>(bad), value) && value == 12);
+    assert(!String<T>::TryParse(Widen<T>("256"), byte) && !String<T>::TryParse(Widen<T>("-1"), byte));
+    uint64_t large = 0;
+    assert(String<T>::TryParse(Widen<T>("18446744073709551615"), large) && large == std::numeric_limits<uint64_t>::max());
+    assert(!String<T>::TryParse(Widen<T>("18446744073709551616"), large));
+
+    double real = 0;
+    assert(String<T>::TryParse(Widen<T>(".5"), real) && real == 0.5 && String<T>::TryParse(Widen<T>("-2."), real) && real == -2.0);
+    assert(String<T>::TryParse(Widen<T>("1E3"), real) && real == 1000.0 && String<T>::TryParse(Widen<T>("1e400"), real) && real > 1e308);
+    assert(String<T>::TryParse(Widen<T>("-Infinity"), real) && real < -1e308 && String<T>::TryParse(Widen<T>("NaN"), real) && real != real);
+    const char* badDoubles[] = { "", ".", "-", "e5", "1e", "1e+", "1.2.3", "1,5", " 1", "1 ", "inf", "0x1p3" };
+    for (const char* bad : badDoubles) assert(!String<T>::TryParse(Widen<T>(bad), real));
+}
+
+static void TestYtcStringSearcher()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    WString text = L"yutuocheng is an excellent person, yutuocheng is an excellent programmer!";
+    assert(text.IndexOf(L"excellent") == 17);
+    assert(text.LastIndexOf(L"excellent") == 52);
+    assert(text.IndexOf(L"excellent programmer") == 52);
+    assert(text.LastIndexOf(L"yutuocheng is") == 35);
+    assert(text.IndexOf(L"excellent persons") == WString::InvalidIndex);
+    assert(text.IndexOf(L"") == 0);
+    assert(text.LastIndexOf(L"") == text.Length() - 1);
+
+    StringSearcher<wchar_t> searcher(L"is an");
+    assert(searcher.IndexOf(text) == 11);
+    assert(searcher.LastIndexOf(text) == 46);
+    assert(!searcher.Contains(L"yutuocheng"));
+
+    // adversarial input for the naive double loop
+    AString haystack('a', 1 << 20);
+    AString needle = AString('a', 1000) + 'b';
+    assert(haystack.IndexOf(needle) == AString::InvalidIndex);
+    assert(haystack.LastIndexOf(needle) == AString::InvalidIndex);
+    haystack += needle;
+    assert(haystack.IndexOf(needle) == (1 << 20));
+    assert(StringSearcher<char>(needle).LastIndexOf(haystack) == (1 << 20));
+}
+
+static void TestYtcStringView()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    WString name = L"yutuocheng is an excellent person!";
+    StringView<wchar_t> view = name.View(17, 9);
+    assert(view.Buffer() == name.Buffer() + 17);
+    assert(view == L"excellent");
+    assert(view.ToString() == L"excellent");
+    assert(view.IndexOf(L"cell") == 2);
+    assert(view.LastIndexOf(L'e') == 6);
+    assert(view.Contains(L"lent") && !view.Contains(L"person"));
+    assert(view.View(9).IsEmpty());
+    assert(name.IndexOf(view) == 17);
+    assert(name.View(11) < name.View(0, 10));
+    assert(name.View(0, 3) < name.View(0, 4));
+    assert(StringView<wchar_t>(name) == name);
+    assert(WString(name, 11, 2) == L"is");
+
+    List<StringView<wchar_t>> fields;
+    uint32_t start = 0;
+    for (uint32_t end; (end = name.View(start).IndexOf(L' ')) != WString::InvalidIndex; start += end + 1)
+    {
+        fields.Add(name.View(start, end));
+    }
+    fields.Add(name.View(start));
+    assert(fields.Count() == 5);
+    assert(fields.IndexOf(L"excellent") == 3);
+}
+
+static void TestStringBuilder()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    StringBuilder<wchar_t> builder;
+    builder.Append(L"id=").AppendNumber(-42).Append(L',').AppendNumber(7u, 3).Append(L',').AppendNumber(2.5, 2);
+    assert(builder.View() == L"id=-42,007,2.50");
+    builder.Clear();
+    builder.AppendNumber(std::numeric_limits<int64_t>::min()).Append(L',').AppendNumber(std::numeric_limits<uint64_t>::max()).Append(L',').AppendNumber(-5, 3).Append(L',').AppendNumber(0, 2);
+    assert(builder.View() == L"-9223372036854775808,18446744073709551615,-005,00");
+    builder.Clear();
+    assert(builder.Length() == 0);
+
+    builder.Reserve(1000);
+    const uint32_t capacity = builder.Capacity();
+    assert(capacity >= 1000);
+    for (uint32_t i = 0; i < 1000; ++i) builder.Append(L'a' + i % 26);
+    assert(builder.Capacity() == capacity);
+    const wchar_t* buffer = builder.Buffer();
+    WString built = builder.ToString();
+    assert(built.Buffer() == buffer && built.Length() == 1000);
+    assert(builder.Length() == 0);
+
+    WString appended;
+    for (uint32_t i = 0; i < 100000; ++i) appended += L'a' + i % 26;
+    assert(appended.Length() == 100000 && appended.LastIndexOf(L"xyz") == 99993);
+}
+
+static void TestYtcStringHash()
+{
+    std::cout << ">>>>>>>>>>>>>>>>>>>>>>>>>>Test GetHashCode():\n";
+    WString name = L"yutuocheng is an excellent person!";
+    assert(name.GetHashCode() == WString(L"yutuocheng is an excellent person!").GetHashCode());
+    assert(name.GetHashCode() == name.View().GetHashCode());
+    assert(name.View(0, 10).GetHashCode() == WString(L"yutuocheng").GetHashCode());
+    assert(name.GetHashCode() != name.View(1).GetHashCode());
+    assert(WString().GetHashCode() == StringView<wchar_t>().GetHashCode());
+    assert(std::hash<WString>()(name) == std::hash<StringView<wchar_t>>()(name));
+
+    // a long string caches the hash for its copies, and forgets it when modified in place
+    WString text(L'a', 1000);
+    const size_t hash = text.GetHashCode();
+    WString copy = text;
+    assert(copy.GetHashCode() == hash && copy.GetHashCode() == StringView<wchar_t>(text).GetHashCode());
+    copy += L'b';
+    assert(copy.GetHashCode() == copy.View().GetHashCode() && copy.GetHashCode() != hash);
+    text += L'a';
+    assert(text.GetHashCode() == text.View().GetHashCode() && text.GetHashCode() != hash);
+    text = L'x';
+    assert(text.GetHashCode() == WString(L'x').GetHashCode());
+
+    std::unordered_map<AString, uint32_t> counts;
+    const char* words[] = { "apple", "banana", "apple", "cherry", "banana", "apple" };
+    for (auto word : words) ++counts[word];
+    assert(counts.size() == 3 && counts["apple"] == 3 && counts["banana"] == 2 && counts["cherry"] == 1);
+}
+
+template<typename T>
+static void TestUnicodeRoundTrip()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    // every code point, in pieces long enough for the vector paths
+    StringBuilder<T> wide;
+    for (uint32_t codePoint = 0x1; codePoint <= Unicode::MaxCodePoint; ++codePoint)
+    {
+        if (codePoint >= 0xD800 && codePoint <= 0xDFFF) continue;
+        T units[2];
+        wide.Append(units, static_cast<uint32_t>(Unicode::WriteWide(units, codePoint) - units));
+        if (codePoint % 37 == 0) wide.Append(T('a'), codePoint % 41);
+    }
+    const String<T> original = wide.ToString();
+    const AString utf8 = Unicode::ToUtf8(original.View());
+    const String<T> decoded = Unicode::FromUtf8<T>(utf8);
+    assert(decoded == original);
+    for (uint32_t chunk : { 1u, 2u, 3u, 7u, 1000u })
+    {
+        Utf8Decoder<T> decoder;
+        StringBuilder<T> builder;
+        for (uint32_t start = 0; start < utf8.Length(); start += chunk)
+        {
+            decoder.Decode(utf8.View(start, chunk), builder);
+        }
+        decoder.Finish();
+        assert(builder.View() == original.View());
+    }
+}
+
+static void TestFormat()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    const AString name = "yutuocheng";
+    assert(Format(YTC_PATTERN("plain")) == "plain" && Format(YTC_PATTERN("")) == "");
+    assert(Format(YTC_PATTERN("{}{}"), name, StringView<char>(name).View(0, 2)) == "yutuochengyu");
+    assert(Format(YTC_PATTERN("[{}] {} {} {} {}"), 42, -7LL, 18446744073709551615ull, true, 'x') == "[42] -7 18446744073709551615 true x");
+    assert(Format(YTC_PATTERN("{{{}}} {{}} }}{{"), 1) == "{1} {} }{");
+    // numbers align right and the rest left by default
+    assert(Format(YTC_PATTERN("|{:6}|{:6}|"), 123, "ab") == "|   123|ab    |");
+    assert(Format(YTC_PATTERN("|{:<6}|{:>6}|{:^6}|{:*^7}|{:0>4}|"), 123, "ab", "ab", "ab", 5) == "|123   |    ab|  ab  |**ab***|0005|");
+    assert(Format(YTC_PATTERN("|{:2}|{:.3}|{:>6.2}|"), "long", "truncated", name) == "|long|tru|    yu|");
+    assert(Format(YTC_PATTERN("{} {} {:.3} {:.0} {:8.2}"), 0.1, 1e21, 3.14159, 2.7, -1.0) == "0.1 1e+21 3.142 3    -1.00");
+    // fixed-point digits round exact halves to even, as printf does, and values from 2^53 on are still printed in full
+    assert(Format(YTC_PATTERN("{:.2} {:.0} {:.0} {:.1} {:.3} {:.1}"), 0.125, 2.5, 3.5, 0.05, -0.0001, 1e20) == "0.12 2 4 0.1 -0.000 100000000000000000000.0");
+    StringBuilder<char> fixed;
+    fixed.AppendNumber(0.125, 2).Append(' ').AppendNumber(1e300, 1).Append(' ').AppendNumber(0.1, 25);
+    assert(fixed.ToString() == Format(YTC_PATTERN("{:.2} {:.1} {:.25}"), 0.125, 1e300, 0.1));
+    const char* null = nullptr;
+    assert(Format(YTC_PATTERN("<{}>"), null) == "<>");
+
+    const WString files = L"files";
+    assert(Format(YTC_PATTERN(L"{} of {:>8} at {:.1}%"), 3u, files, 99.96) == L"3 of    files at 100.0%");
+    assert(Format(YTC_PATTERN(L"{}{}"), L'\x4E2D', files.View(0, 1)) == L"\x4E2D" L"f");
+
+    // one allocation of the exact length
+    const AString line = Format(YTC_PATTERN("user {} logged in from {} after {:.3} ms, request {}"), name, AString('h', 300), 12.5, 123456789);
+    assert(line.Length() == 366 && line.IndexOf("after 12.500 ms, request 123456789") == 332);
+}
+
+static void TestUnicode()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    // U+00E9, U+20AC and U+1D11E take 2, 3 and 4 bytes
+    const AString utf8 = "h\xC3\xA9llo \xE2\x82\xAC \xF0\x9D\x84\x9E";
+    const WString wide = ToWide(utf8);
+    const wchar_t expected[] = { L'h', 0xE9, L'l', L'l', L'o', L' ', 0x20AC, L' ' };
+    assert(wide.View(0, 8) == StringView<wchar_t>(expected, 8));
+    assert(wide.Length() == (sizeof(wchar_t) == 2 ? 10u : 9u) && ToUtf8(wide) == utf8);
+    const String<char16_t> utf16 = Unicode::FromUtf8<char16_t>(utf8);
+    assert(utf16.Length() == 10 && utf16.Buffer()[8] == 0xD834 && utf16.Buffer()[9] == 0xDD1E);
+
+    AString ascii;
+    for (int i = 0; i < 1000; ++i) ascii += static_cast<char>(1 + i % 127);
+    assert(ToUtf8(ToWide(ascii)) == ascii && ToWide(ascii).Length() == 1000 && ToWide("").IsEmpty());
+
+    // overlong forms, surrogates, code points above U+10FFFF, stray continuations and truncated sequences
+    const char* invalid[] = { "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xF0\x80\x80\x80",
+        "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\x80", "a\xBF", "\xE2\x82", "\xF0\x9D\x84", "\xE2\x28\xA1" };
+    for (const char* text : invalid)
+    {
+        bool thrown = false;
+        try
+        {
+            ToWide(text);
+        }
+        catch (const Exception&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    const char16_t unpaired[] = { u'a', 0xD800, u'b', 0 };
+    const char32_t outOfRange[] = { 0x110000, 0 };
+    bool thrown = false;
+    try
+    {
+        Unicode::ToUtf8(StringView<char16_t>(unpaired));
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try
+    {
+        Unicode::ToUtf8(StringView<char32_t>(outOfRange));
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // a sequence split between chunks is completed, one left unfinished is reported
+    Utf8Decoder<wchar_t> decoder;
+    StringBuilder<wchar_t> builder;
+    decoder.Decode("\xE2", builder);
+    decoder.Decode("\x82", builder);
+    assert(!decoder.IsComplete() && builder.Length() == 0);
+    decoder.Decode("\xAC!\xF0\x9D", builder);
+    assert(builder.Length() == 2 && builder.Buffer()[0] == 0x20AC);
+    thrown = false;
+    try
+    {
+        decoder.Finish();
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown && decoder.IsComplete());
+
+    TestUnicodeRoundTrip<char16_t>();
+    TestUnicodeRoundTrip<char32_t>();
+    TestUnicodeRoundTrip<wchar_t>();
+}
+
+static void TestInternPool()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    InternPool<wchar_t> pool;
+    auto name = pool.Intern(L"yutuocheng");
+    assert(name == pool.Intern(WString(L"yutuocheng")));
+    assert(name != pool.Intern(L"yutuo"));
+    assert(name.Value() == L"yutuocheng" && name.View().Buffer() == name.Value().Buffer());
+    assert(pool.Find(L"yutuo") == pool.Intern(L"yutuo"));
+    assert(pool.Find(L"excellent").IsNull() && InternPool<wchar_t>::Atom().Value().IsEmpty());
+    assert(pool.Intern(L"").Value().IsEmpty() && !pool.Intern(L"").IsNull());
+
+    // enough strings to grow the tables of every shard, long ones included
+    List<WString> labels;
+    for (uint32_t i = 0; i < 5000; ++i)
+    {
+        labels.Add(WString(L'x', i % 300) + L"label" + static_cast<wchar_t>(L'a' + i % 26) + static_cast<wchar_t>(L'a' + i / 26));
+    }
+    for (uint32_t i = 0; i < labels.Count(); ++i) pool.Intern(labels[i]);
+    assert(pool.Count() == 5000 + 3);
+    for (uint32_t i = 0; i < labels.Count(); ++i)
+    {
+        auto atom = pool.Find(labels[i]);
+        assert(!atom.IsNull() && atom.Value() == labels[i] && atom.GetHashCode() == labels[i].GetHashCode());
+    }
+}
+
+// the textbook dynamic programming over positions of the pattern and the string, for patterns without classes or escapes
+static bool GlobMatchByTable(const AString& pattern, const AString& value)
+{
+    std::vector<bool> row(value.Length() + 1, false);
+    row[0] = true;
+    for (uint32_t i = 0; i < pattern.Length(); ++i)
+    {
+        const char p = pattern.Buffer()[i];
+        std::vector<bool> next(value.Length() + 1, false);
+        for (uint32_t j = 0; j <= value.Length(); ++j)
+        {
+            if (p == '*') next[j] = row[j] || (j && next[j - 1]);
+            else if (j) next[j] = row[j - 1] && (p == '?' || p == value.Buffer()[j - 1]);
+        }
+        row.swap(next);
+    }
+    return row[value.Length()];
+}
+
+static void TestGlob()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    uint32_t random = 1618;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    for (uint32_t round = 0; round < 20000; ++round)
+    {
+        AString pattern;
+        for (uint32_t length = next() % 8; length; --length) pattern += "ab*?"[next() % 4];
+        AString value;
+        for (uint32_t length = next() % 12; length; --length) value += "ab"[next() % 2];
+        assert(GlobPattern<char>(pattern).IsMatch(value) == GlobMatchByTable(pattern, value));
+    }
+    // long runs of a literal whose hits keep failing, until the bit-parallel scan takes over
+    for (uint32_t round = 0; round < 300; ++round)
+    {
+        AString pattern;
+        for (uint32_t length = next() % 100; length; --length) pattern += "aaaaaaaab*?"[next() % 11];
+        AString value;
+        for (uint32_t length = next() % 2000; length; --length) value += "aaaaaaaaaaaaaab"[next() % 15];
+        assert(GlobPattern<char>(pattern).IsMatch(value) == GlobMatchByTable(pattern, value));
+    }
+
+    assert(GlobPattern<char>("*.cpp").IsMatch("src/Test.cpp") && !GlobPattern<char>("*.cpp").IsMatch("src/Test.hpp"));
+    assert(GlobPattern<char>("/api/v?/users/*").IsMatch("/api/v2/users/42") && !GlobPattern<char>("/api/v?/users/*").IsMatch("/api/v10/users/42"));
+    assert(GlobPattern<char>("*").IsMatch("") && GlobPattern<char>("").IsMatch("") && !GlobPattern<char>("").IsMatch("a"));
+    assert(GlobPattern<char>("a*b*c").IsMatch("abc") && !GlobPattern<char>("a*bc*bc").IsMatch("abcb") && GlobPattern<char>("a*bc*bc").IsMatch("abcxbc"));
+    assert(GlobPattern<char>("[a-c]x[!0-9]").IsMatch("bxy") && !GlobPattern<char>("[a-c]x[!0-9]").IsMatch("bx7") && !GlobPattern<char>("[a-c]x").IsMatch("dx"));
+    assert(GlobPattern<char>("[]]") .IsMatch("]") && GlobPattern<char>("[^]a]").IsMatch("b") && !GlobPattern<char>("[^]a]").IsMatch("]"));
+    assert(GlobPattern<char>("a\\*b").IsMatch("a*b") && !GlobPattern<char>("a\\*b").IsMatch("axb") && GlobPattern<char>("[\\]-]").IsMatch("-"));
+    assert(GlobPattern<char>("*x?z*").IsMatch("xxyz") && GlobPattern<char>("*[xy]a[xy]*").IsMatch("xxxxyya yax"));
+    assert(GlobPattern<char>("*/[a-z]*.txt").RequiredLiteral() == ".txt" && GlobPattern<char>("?*").RequiredLiteral().Length() == 0);
+    assert(GlobPattern<char>("a*b?c").MinLength() == 4);
+    // a pattern which makes a backtracking matcher exponential
+    const AString many = AString('a', 200);
+    assert(!GlobPattern<char>("a*a*a*a*a*a*a*a*a*a*b").IsMatch(many) && GlobPattern<char>("a*a*a*a*a*a*a*a*a*a*").IsMatch(many));
+    assert(GlobPattern<wchar_t>(L"*[\x4E00-\x9FFF]?.txt").IsMatch(L"docs/\x6587" L"a.txt") && !GlobPattern<wchar_t>(L"*[\x4E00-\x9FFF]?.txt").IsMatch(L"docs/ba.txt"));
+    const GlobPattern<wchar_t> wide(L"*[\x4E00-\x9FFF]?\x6587*");
+    assert(wide.IsMatch(L"ab\x4E00" L"c\x6587") && wide.IsMatch(L"\x9FFF\x9FFF\x6587!") && !wide.IsMatch(L"ab\x4DFF" L"c\x6587") && !wide.IsMatch(L"\xA000" L"c\x6587"));
+    assert(GlobPattern<wchar_t>(L"*[!\x4E00-\x9FFF]?*").IsMatch(L"\x4E00\xA000" L"a") && !GlobPattern<wchar_t>(L"*[!\x4E00-\x9FFF]?*").IsMatch(L"\x4E00\x4E01" L"a"));
+    const char* invalid[] = { "[abc", "abc\\", "[", "[!]" };
+    for (const char* pattern : invalid)
+    {
+        bool thrown = false;
+        try
+        {
+            GlobPattern<char> glob(pattern);
+        }
+        catch (const Exception&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    List<AString> patterns;
+    for (uint32_t i = 0; i < 300; ++i)
+    {
+        AString pattern;
+        for (uint32_t length = next() % 10; length; --length) pattern += "abc/.*?"[next() % 7];
+        patterns.Add(pattern);
+    }
+    patterns.Add("*.cpp");
+    patterns.Add("src/*");
+    GlobSet<char> set(patterns);
+    assert(set.PatternCount() == patterns.Count() && set.FirstMatch("src/Test.cpp") < patterns.Count());
+    for (uint32_t round = 0; round < 2000; ++round)
+    {
+        AString value;
+        for (uint32_t length = next() % 16; length; --length) value += "abc/."[next() % 5];
+        List<uint32_t> expected;
+        for (uint32_t i = 0; i < patterns.Count(); ++i)
+        {
+            if (set.Pattern(i).IsMatch(value)) expected.Add(i);
+        }
+        const List<uint32_t> matches = set.Matches(value);
+        assert(matches.Count() == expected.Count());
+        for (uint32_t i = 0; i < matches.Count(); ++i) assert(matches[i] == expected[i]);
+        assert(set.FirstMatch(value) == (expected.Count() ? expected[0] : GlobSet<char>::InvalidIndex));
+        assert(set.IsMatch(value) == (expected.Count() != 0));
+    }
+    assert(!GlobSet<char>(List<AString>()).IsMatch("a"));
+    // a literal occurring at every position makes its pattern a candidate once
+    List<AString> runs;
+    runs.Add("*a*b");
+    runs.Add("*a");
+    const GlobSet<char> runSet(runs);
+    const AString run('a', 100000);
+    assert(runSet.FirstMatch(run) == 1 && runSet.Matches(run).Count() == 1);
+    // more patterns than the candidates marked on the stack
+    List<AString> numbered;
+    for (uint32_t i = 0; i < 5000; ++i) numbered.Add("*/item" + AString::From(i) + "/*");
+    const GlobSet<char> numberedSet(numbered);
+    assert(numberedSet.FirstMatch("/users/item4999/x") == 4999 && numberedSet.FirstMatch("/users/item17/x") == 17 && !numberedSet.IsMatch("/users/item5000"));
+}
+
+static void TestMultiPatternMatcher()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    List<AString> keywords;
+    keywords.Add("he");
+    keywords.Add("she");
+    keywords.Add("his");
+    keywords.Add("hers");
+    MultiPatternMatcher<char> matcher(keywords);
+    auto matches = matcher.FindAll("ushers");
+    assert(matches.Count() == 3);
+    assert(matches[0].patternIndex == 1 && matches[0].position == 1);
+    assert(matches[1].patternIndex == 0 && matches[1].position == 2);
+    assert(matches[2].patternIndex == 3 && matches[2].position == 2);
+    assert(matcher.FindFirst("this is").patternIndex == 2);
+    assert(!matcher.Contains("HERS"));
+
+    MultiPatternMatcher<char> ignoreCase(keywords, true);
+    auto first = ignoreCase.FindFirst("USHERS");
+    assert(first.patternIndex == 1 && first.position == 1);
+
+    List<WString> words;
+    words.Add(L"excellent");
+    words.Add(L"cell");
+    MultiPatternMatcher<wchar_t> wideMatcher(words);
+    assert(wideMatcher.FindAll(L"yutuocheng is an excellent person!").Count() == 2);
+
+    // the leftmost match wins, then the longest, and replaced text is not searched again
+    List<AString> replacements;
+    replacements.Add("HE");
+    replacements.Add("SHE");
+    replacements.Add("");
+    replacements.Add("<hers>");
+    assert(matcher.ReplaceAll("ushers and his hers, he", replacements) == "uSHErs and  <hers>, HE");
+    assert(matcher.ReplaceAll("nothing", replacements) == "nothing" && matcher.ReplaceAll("", replacements) == "");
+    assert(ignoreCase.ReplaceAll("HeRs", replacements) == "<hers>");
+    List<WString> wideReplacements;
+    wideReplacements.Add(L"cell");
+    wideReplacements.Add(L"excellent");
+    assert(wideMatcher.ReplaceAll(L"excellent cells", wideReplacements) == L"cell excellents");
+
+    // a long pattern holds back the short matches inside its reach until it is ruled out
+    List<AString> runs;
+    runs.Add("a");
+    runs.Add(AString('a', 1000) + "b");
+    runs.Add("aab");
+    List<AString> runReplacements;
+    runReplacements.Add("x");
+    runReplacements.Add("<long>");
+    runReplacements.Add("<aab>");
+    MultiPatternMatcher<char> runMatcher(runs);
+    assert(runMatcher.ReplaceAll(AString('a', 3000), runReplacements) == AString('x', 3000));
+    assert(runMatcher.ReplaceAll(AString(AString('a', 1500) + "b"), runReplacements) == AString('x', 500) + "<long>");
+    assert(runMatcher.ReplaceAll(AString(AString('a', 999) + "bab"), runReplacements) == AString('x', 997) + "<aab>xb");
 }
 
 static void TestYtcString()
 {
-    std::cout << __FUNCTION__"\n";
+    std::cout << __FUNCTION__ << "\n";
     const wchar_t* samples1[] =
     {
         //nullptr,
@@ -172,7 +1392,7 @@ static void TestYtcString()
         { 0, 1, L"y"},
         { 1, 0, L""},
         { 11, 2, L"is"},
-        { 0, -1, name },
+        { 0, WString::MaxSize, name },
         { 0, name.Length() - 1, L"yutuocheng is an excellent person" },
         { 11, 100, L"is an excellent person!"},
     };
@@ -186,6 +1406,34 @@ static void TestYtcString()
     }
 
     std::cout << "\n>>>>>>>>>>>>>>>>>>>>Test IndexOf()\n";
+    TestYtcStringIndexOfChar<char>();
+    TestYtcStringIndexOfChar<wchar_t>();
+    TestYtcStringIgnoreCase<char>();
+    TestYtcStringIgnoreCase<wchar_t>();
+    TestYtcStringCompare<char>();
+    TestYtcStringCompare<wchar_t>();
+    TestYtcStringSplit<char>();
+    TestYtcStringSplit<wchar_t>();
+    TestYtcStringReplace<char>();
+    TestYtcStringReplace<wchar_t>();
+    TestRope<char>();
+    TestRope<wchar_t>();
+    TestEditDistance<char>();
+    TestEditDistance<wchar_t>();
+    TestNumberConversion<char>();
+    TestNumberConversion<wchar_t>();
+    TestYtcStringSearcher();
+    TestYtcStringView();
+    TestStringBuilder();
+    TestYtcStringHash();
+    TestLocalString();
+    TestMemoryResource();
+    TestMappedFile();
+    TestInternPool();
+    TestUnicode();
+    TestFormat();
+    TestMultiPatternMatcher();
+    TestGlob();
 
     TestYtcStringConcat();
     TestYtStringRemove();
@@ -205,6 +1453,137 @@ static void Dump(IEnumerable<T>& collection)
     std::wcout << std::endl;
 }
 
+struct CountedItem
+{
+    static int live;
+    static int copies;
+    int value;
+
+    CountedItem(int v) : value(v) { ++live; }
+    CountedItem(int a, int b) : value(a * 10 + b) { ++live; }
+    CountedItem(const CountedItem& other) : value(other.value) { ++live; ++copies; }
+    CountedItem(CountedItem&& other) noexcept : value(other.value) { other.value = -1; ++live; }
+    CountedItem& operator=(const CountedItem& other) { value = other.value; ++copies; return *this; }
+    CountedItem& operator=(CountedItem&& other) noexcept { value = other.value; other.value = -1; return *this; }
+    ~CountedItem() { --live; }
+};
+
+int CountedItem::live = 0;
+int CountedItem::copies = 0;
+
+static void TestListMoveAndEmplace()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    {
+        // growing and inserting in the middle move the elements, none is copied or leaked
+        List<CountedItem> items;
+        for (int i = 0; i < 100; ++i) items.Emplace(i);
+        items.EmplaceAt(0, -5);
+        items.EmplaceAt(50, 4, 2);
+        items.Add(CountedItem(7));
+        items.Insert(3, CountedItem(8));
+        assert(CountedItem::copies == 0 && CountedItem::live == 104 && items.Count() == 104);
+        assert(items[0].value == -5 && items[1].value == 0 && items[3].value == 8 && items[51].value == 42 && items[103].value == 7);
+        // an argument referring to an element of the list is read before the elements move
+        for (int i = 0; i < 200; ++i) items.Add(items[0]);
+        items.EmplaceAt(1, items[items.Count() - 1]);
+        assert(items[1].value == -5 && items[299].value == -5 && CountedItem::copies == 201);
+        items.RemoveAt(0);
+        assert(CountedItem::live == int(items.Count()));
+    }
+    assert(CountedItem::live == 0);
+
+    List<WString> strings;
+    WString longString(L'x', 300);
+    const wchar_t* buffer = longString.Buffer();
+    strings.Add(Move(longString));
+    assert(strings[0].Buffer() == buffer && longString.IsEmpty());
+    assert(strings.Emplace(L"yutuocheng", 3) == L"yut");
+    for (int i = 0; i < 10; ++i) strings.EmplaceAt(0, L"abc");
+    assert(strings.Count() == 12 && strings[10].Buffer() == buffer && strings[11] == L"yut");
+    List<WString> range;
+    range.Add(L"1");
+    range.Add(L"2");
+    strings.InsertRange(1, range);
+    assert(strings.Count() == 14 && strings[1] == L"1" && strings[2] == L"2" && strings[3] == L"abc");
+    bool thrown = false;
+    try
+    {
+        strings.EmplaceAt(15, L"x");
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+static void TestListRelocation()
+{
+    std::cout << __FUNCTION__ << std::endl;
+    static_assert(IsTriviallyRelocatable<AString>::value && IsTriviallyRelocatable<LocalWString>::value, "strings relocate with memmove");
+    static_assert(IsTriviallyRelocatable<int>::value && !IsTriviallyRelocatable<CountedItem>::value, "opt-in only");
+    uint32_t random = 99991;
+    auto next = [&random] { random = random * 1103515245 + 12345; return random >> 8; };
+    {
+        // short strings are moved with their characters inside, long ones with their shared buffers
+        List<AString> strings;
+        List<CountedItem> items;
+        std::vector<std::string> expected;
+        for (uint32_t round = 0; round < 4000; ++round)
+        {
+            const uint32_t operation = next() % 5;
+            const uint32_t index = next() % (expected.size() + 1);
+            if (operation < 3 || expected.empty())
+            {
+                const std::string value(next() % 3 ? next() % 20 : 300 + next() % 50, char('a' + round % 26));
+                strings.Insert(index, AString(value.c_str()));
+                items.EmplaceAt(index, int(value.size()));
+                expected.insert(expected.begin() + index, value);
+            }
+            else if (operation == 3)
+            {
+                const uint32_t at = index % expected.size();
+                strings.RemoveAt(at);
+                items.RemoveAt(at);
+                expected.erase(expected.begin() + at);
+            }
+            else
+            {
+                const uint32_t count = next() % (expected.size() - index + 1) % 8;
+                strings.RemoveRange(index, count);
+                items.RemoveRange(index, count);
+                expected.erase(expected.begin() + index, expected.begin() + index + count);
+            }
+            assert(strings.Count() == expected.size() && items.Count() == expected.size() && CountedItem::live == int(expected.size()));
+        }
+        for (uint32_t i = 0; i < expected.size(); ++i)
+        {
+            assert(strings[i] == expected[i].c_str() && items[i].value == int(expected[i].size()));
+        }
+        List<AString> copy = strings;
+        copy.RemoveRange(0, copy.Count());
+        assert(copy.Count() == 0 && strings.Count() == expected.size());
+    }
+    assert(CountedItem::live == 0);
+
+    List<Ref<AString>> refs;
+    for (int i = 0; i < 100; ++i) refs.Insert(0, MakeRef<AString>(AString('r', 300)));
+    const Ref<AString> kept = refs[50];
+    refs.RemoveRange(10, 80);
+    assert(refs.Count() == 20 && kept.use_count() == 1 && *refs[19] == AString('r', 300));
+    bool thrown = false;
+    try
+    {
+        refs.RemoveRange(15, 6);
+    }
+    catch (const Exception&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
 static void TestList()
 {
     List<int> l1;
@@ -241,7 +1620,7 @@ static void TestList()
             L"HAO",
         };
 
-        for (int i = 0; i < std::size(strings2); ++i)
+        for (int i = 0; i < int(sizeof(strings2) / sizeof(strings2[0])); ++i)
         {
             list_str1.Insert(i + 3, strings2[i]);
         }
@@ -251,6 +1630,8 @@ static void TestList()
         list_str2.RemoveAt(3);
         Dump(list_str2);
     }
+    TestListMoveAndEmplace();
+    TestListRelocation();
 }
 
 int main()
@@ -259,7 +1640,7 @@ int main()
 #ifdef _MSC_VER
         //MemLeakChecker checker;
 #endif
-        //TestYtcString();
+        TestYtcString();
         TestList();
     }
     std::cin.get();